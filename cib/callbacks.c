@@ -38,6 +38,7 @@
 #include <callbacks.h>
 #include <cibmessages.h>
 #include <notify.h>
+#include <stats.h>
 #include "common.h"
 
 static unsigned long cib_local_bcast_num = 0;
@@ -253,6 +254,7 @@ cib_common_callback(qb_ipcs_connection_t * c, void *data, size_t size, gboolean
     xmlNode *op_request = crm_ipcs_recv(cib_client, data, size, &id, &flags);
 
     if (op_request) {
+        cib_stats_input(size);
         crm_element_value_int(op_request, F_CIB_CALLOPTS, &call_options);
     }
 
@@ -431,8 +433,15 @@ do_local_notify(xmlNode * notify_src, const char *client_id,
 
         switch (client_obj->kind) {
             case CRM_CLIENT_IPC:
-                if (crm_ipcs_send(client_obj, rid, notify_src, sync_reply?crm_ipc_flags_none:crm_ipc_server_event) < 0) {
-                    local_rc = -ENOMSG;
+                {
+                    ssize_t sent = crm_ipcs_send(client_obj, rid, notify_src,
+                                                 sync_reply ? crm_ipc_flags_none : crm_ipc_server_event);
+
+                    if (sent < 0) {
+                        local_rc = -ENOMSG;
+                    } else {
+                        cib_stats_output(sent);
+                    }
                 }
                 break;
 #ifdef HAVE_GNUTLS_GNUTLS_H
@@ -929,6 +938,7 @@ cib_process_request(xmlNode * request, gboolean force_synchronous, gboolean priv
     xmlNode *result_diff = NULL;
 
     int rc = pcmk_ok;
+    long long start = 0;
     const char *op = crm_element_value(request, F_CIB_OPERATION);
     const char *originator = crm_element_value(request, F_ORIG);
     const char *host = crm_element_value(request, F_CIB_HOST);
@@ -984,12 +994,14 @@ cib_process_request(xmlNode * request, gboolean force_synchronous, gboolean priv
         return;
     }
 
+    cib_stats_op_begin(op, client_name);
     if (from_peer == FALSE) {
         parse_local_options(cib_client, call_type, call_options, host, op,
                             &local_notify, &needs_reply, &process, &needs_forward);
 
     } else if (parse_peer_options(call_type, request, &local_notify,
                                   &needs_reply, &process, &needs_forward) == FALSE) {
+        cib_stats_op_end(pcmk_ok);
         return;
     }
 
@@ -1014,7 +1026,10 @@ cib_process_request(xmlNode * request, gboolean force_synchronous, gboolean priv
                  originator ? originator : "local",
                  client_name, call_id);
 
+        start = crm_monotonic_usec();
         forward_request(request, cib_client, call_options);
+        cib_stats_phase(cib_phase_send, crm_monotonic_usec() - start);
+        cib_stats_op_end(pcmk_ok);
         return;
     }
 
@@ -1081,6 +1096,7 @@ cib_process_request(xmlNode * request, gboolean force_synchronous, gboolean priv
         finished = time(NULL);
         if (finished - now > 3) {
             crm_trace("%s operation took %ds to complete", op, finished - now);
+            cib_stats_log(LOG_TRACE);
             crm_write_blackbox(0, NULL);
         }
 
@@ -1110,7 +1126,9 @@ cib_process_request(xmlNode * request, gboolean force_synchronous, gboolean priv
 
         cib_local_bcast_num++;
         crm_xml_add_int(request, F_CIB_LOCAL_NOTIFY_ID, cib_local_bcast_num);
+        start = crm_monotonic_usec();
         broadcast = send_peer_reply(request, result_diff, originator, TRUE);
+        cib_stats_phase(cib_phase_send, crm_monotonic_usec() - start);
 
         if (broadcast && client_id && local_notify && op_reply) {
 
@@ -1142,7 +1160,9 @@ cib_process_request(xmlNode * request, gboolean force_synchronous, gboolean priv
             crm_trace("Directing reply to %s", originator);
         }
 
+        start = crm_monotonic_usec();
         send_peer_reply(op_reply, result_diff, originator, FALSE);
+        cib_stats_phase(cib_phase_send, crm_monotonic_usec() - start);
     }
 
     if (local_notify && client_id) {
@@ -1155,6 +1175,7 @@ cib_process_request(xmlNode * request, gboolean force_synchronous, gboolean priv
         }
     }
 
+    cib_stats_op_end(rc);
     free_xml(op_reply);
     free_xml(result_diff);
 
@@ -1184,6 +1205,7 @@ cib_process_command(xmlNode * request, xmlNode ** reply, xmlNode ** cib_diff, gb
     gboolean config_changed = FALSE;
     gboolean manage_counters = TRUE;
 
+    long long start = 0;
     static mainloop_timer_t *digest_timer = NULL;
 
     CRM_ASSERT(cib_status == pcmk_ok);
@@ -1218,6 +1240,7 @@ cib_process_command(xmlNode * request, xmlNode ** reply, xmlNode ** cib_diff, gb
         rc = cib_perform_op(op, call_options, cib_op_func(call_type), TRUE,
                             section, request, input, FALSE, &config_changed,
                             current_cib, &result_cib, NULL, &output);
+        cib_stats_perform_op();
 
         CRM_CHECK(result_cib == NULL, free_xml(result_cib));
         goto done;
@@ -1254,6 +1277,7 @@ cib_process_command(xmlNode * request, xmlNode ** reply, xmlNode ** cib_diff, gb
         rc = cib_perform_op(op, call_options, cib_op_func(call_type), FALSE,
                             section, request, input, manage_counters, &config_changed,
                             current_cib, &result_cib, cib_diff, &output);
+        cib_stats_perform_op();
 
         if (manage_counters == FALSE) {
             /* Legacy code
@@ -1316,6 +1340,7 @@ cib_process_command(xmlNode * request, xmlNode ** reply, xmlNode ** cib_diff, gb
         }
     }
 
+    start = crm_monotonic_usec();
     if ((call_options & cib_inhibit_notify) == 0) {
         const char *client = crm_element_value(request, F_CIB_CLIENTNAME);
 
@@ -1328,6 +1353,7 @@ cib_process_command(xmlNode * request, xmlNode ** reply, xmlNode ** cib_diff, gb
 
         cib_replace_notify(origin, the_cib, rc, *cib_diff);
     }
+    cib_stats_phase(cib_phase_notify, crm_monotonic_usec() - start);
 
     xml_log_patchset(LOG_TRACE, "cib:diff", *cib_diff);
   done:
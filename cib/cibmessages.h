@@ -38,6 +38,10 @@ extern int cib_process_ping(const char *op, int options, const char *section,
                             xmlNode * req, xmlNode * input, xmlNode * existing_cib,
                             xmlNode ** result_cib, xmlNode ** answer);
 
+extern int cib_process_stats(const char *op, int options, const char *section,
+                             xmlNode * req, xmlNode * input, xmlNode * existing_cib,
+                             xmlNode ** result_cib, xmlNode ** answer);
+
 extern int cib_process_readwrite(const char *op, int options, const char *section,
                                  xmlNode * req, xmlNode * input, xmlNode * existing_cib,
                                  xmlNode ** result_cib, xmlNode ** answer);
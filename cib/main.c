@@ -40,6 +40,8 @@
 
 #include <cibio.h>
 #include <callbacks.h>
+#include <notify.h>
+#include <stats.h>
 #include <pwd.h>
 #include <grp.h>
 #include "common.h"
@@ -269,6 +271,8 @@ cib_cleanup(void)
     }
     crm_client_cleanup();
     g_hash_table_destroy(config_hash);
+    cib_stats_cleanup();
+    cib_notify_cleanup();
     free(cib_our_uname);
     free(channel1);
     free(channel2);
@@ -390,6 +394,7 @@ cib_cs_dispatch(cpg_handle_t handle,
         return;
     }
     if (kind == crm_class_cluster) {
+        cib_stats_input(msg_len);
         xml = string2xml(data);
         if (xml == NULL) {
             crm_err("Invalid XML: '%.120s'", data);
@@ -479,6 +484,7 @@ cib_init(void)
     config_hash =
         g_hash_table_new_full(crm_str_hash, g_str_equal, g_hash_destroy_str, g_hash_destroy_str);
 
+    cib_stats_init(cib_stat_interval);
     if (startCib("cib.xml") == FALSE) {
         crm_crit("Cannot start CIB... terminating");
         crm_exit(ENODATA);
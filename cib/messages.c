@@ -39,6 +39,7 @@
 #include <cibio.h>
 #include <cibmessages.h>
 #include <callbacks.h>
+#include <stats.h>
 
 #define MAX_DIFF_RETRY 5
 
@@ -244,6 +245,19 @@ cib_process_ping(const char *op, int options, const char *section, xmlNode * req
 #endif
 }
 
+int
+cib_process_stats(const char *op, int options, const char *section, xmlNode * req, xmlNode * input,
+                  xmlNode * existing_cib, xmlNode ** result_cib, xmlNode ** answer)
+{
+#ifdef CIBPIPE
+    return -EINVAL;
+#else
+    crm_trace("Processing \"%s\" event", op);
+    *answer = cib_stats_xml(NULL);
+    return pcmk_ok;
+#endif
+}
+
 int
 cib_process_sync(const char *op, int options, const char *section, xmlNode * req, xmlNode * input,
                  xmlNode * existing_cib, xmlNode ** result_cib, xmlNode ** answer)
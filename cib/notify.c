@@ -34,9 +34,11 @@
 #include <crm/msg_xml.h>
 
 #include <crm/common/xml.h>
+#include <crm/common/mainloop.h>
 #include <cibio.h>
 #include <callbacks.h>
 #include <notify.h>
+#include <stats.h>
 
 int pending_updates = 0;
 
@@ -51,6 +53,252 @@ void attach_cib_generation(xmlNode * msg, const char *field, xmlNode * a_cib);
 void do_cib_notify(int options, const char *op, xmlNode * update,
                    int result, xmlNode * result_data, const char *msg_type);
 
+/* Clients with this many undelivered events have their diff notifications
+ * merged into a single pending one until they catch up
+ */
+#define CIB_NOTIFY_BACKLOG 10
+
+/* Past this many changes, send a "refresh needed" marker instead */
+#define CIB_NOTIFY_MAX_CHANGES 1000
+
+static GHashTable *pending_diffs = NULL;        /* client id -> held diff notification */
+static mainloop_timer_t *pending_timer = NULL;
+static unsigned long diffs_coalesced = 0;
+static unsigned long diffs_refreshed = 0;
+
+static int
+cib_notify_count_changes(xmlNode * diff)
+{
+    int count = 0;
+    xmlNode *change = NULL;
+
+    for (change = __xml_first_child(diff); change != NULL; change = __xml_next(change)) {
+        if (crm_str_eq(crm_element_name(change), XML_DIFF_CHANGE, TRUE)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/*!
+ * \internal
+ * \brief Fold a diff notification into one that is being held back
+ *
+ * Consecutive v2 patchsets are merged by appending the newer changes and
+ * advancing the target version.  Failed updates changed nothing, so they are
+ * absorbed by whichever notification succeeded.  Anything else cannot be
+ * merged.
+ *
+ * \return Merged notification, or NULL if the two could not be merged
+ */
+static xmlNode *
+cib_notify_merge(xmlNode * pending, xmlNode * msg)
+{
+    int lpc = 0;
+    int rc = pcmk_ok;
+    int format = 1;
+
+    int old_add[] = { 0, 0, 0 };
+    int old_del[] = { 0, 0, 0 };
+    int new_add[] = { 0, 0, 0 };
+    int new_del[] = { 0, 0, 0 };
+
+    const char *vfields[] = {
+        XML_ATTR_GENERATION_ADMIN,
+        XML_ATTR_GENERATION,
+        XML_ATTR_NUMUPDATES,
+    };
+
+    xmlNode *change = NULL;
+    xmlNode *target = NULL;
+    xmlNode *merged = NULL;
+    xmlNode *merged_diff = NULL;
+    xmlNode *old_diff = get_message_xml(pending, F_CIB_UPDATE_RESULT);
+    xmlNode *new_diff = get_message_xml(msg, F_CIB_UPDATE_RESULT);
+    const char *digest = crm_element_value(new_diff, XML_ATTR_DIGEST);
+
+    crm_element_value_int(pending, F_CIB_RC, &rc);
+    if (rc == -pcmk_err_diff_resync) {
+        /* The client will re-read the CIB anyway */
+        return copy_xml(pending);
+    }
+
+    crm_element_value_int(msg, F_CIB_RC, &rc);
+    if (rc != pcmk_ok) {
+        /* A failed update changed nothing, so the held changes still stand */
+        return copy_xml(pending);
+    }
+
+    rc = pcmk_ok;
+    crm_element_value_int(pending, F_CIB_RC, &rc);
+    if (rc != pcmk_ok) {
+        /* Nor did the held one, so there is nothing to merge into */
+        return copy_xml(msg);
+    }
+
+    if (old_diff == NULL || new_diff == NULL) {
+        return NULL;
+    }
+
+    crm_element_value_int(old_diff, "format", &format);
+    if (format != 2) {
+        return NULL;
+    }
+
+    format = 1;
+    crm_element_value_int(new_diff, "format", &format);
+    if (format != 2) {
+        return NULL;
+    }
+
+    xml_patch_versions(old_diff, old_add, old_del);
+    xml_patch_versions(new_diff, new_add, new_del);
+    for (lpc = 0; lpc < DIMOF(vfields); lpc++) {
+        if (old_add[lpc] != new_del[lpc]) {
+            crm_trace("Cannot merge non-consecutive patchsets");
+            return NULL;
+        }
+    }
+
+    if (cib_notify_count_changes(old_diff) + cib_notify_count_changes(new_diff)
+        > CIB_NOTIFY_MAX_CHANGES) {
+        return NULL;
+    }
+
+    merged = copy_xml(pending);
+    merged_diff = get_message_xml(merged, F_CIB_UPDATE_RESULT);
+
+    /* The input of any single update no longer describes the result */
+    free_xml(first_named_child(merged, F_CIB_UPDATE));
+    free_xml(first_named_child(merged, "cib_generation"));
+    add_node_copy(merged, first_named_child(msg, "cib_generation"));
+    crm_xml_add(merged, F_CIB_OPERATION, crm_element_value(msg, F_CIB_OPERATION));
+
+    for (change = __xml_first_child(new_diff); change != NULL; change = __xml_next(change)) {
+        if (crm_str_eq(crm_element_name(change), XML_DIFF_CHANGE, TRUE)) {
+            add_node_copy(merged_diff, change);
+        }
+    }
+
+    target = first_named_child(first_named_child(merged_diff, XML_DIFF_VERSION), XML_DIFF_VTARGET);
+    for (lpc = 0; target != NULL && lpc < DIMOF(vfields); lpc++) {
+        crm_xml_add_int(target, vfields[lpc], new_add[lpc]);
+    }
+
+    if (digest) {
+        crm_xml_add(merged_diff, XML_ATTR_DIGEST, digest);
+    } else {
+        xml_remove_prop(merged_diff, XML_ATTR_DIGEST);
+    }
+
+    return merged;
+}
+
+/* Tells the client to re-read the CIB, clients treat it like any other failed patch */
+static xmlNode *
+cib_notify_refresh_marker(xmlNode * msg)
+{
+    xmlNode *marker = create_xml_node(NULL, "notify");
+
+    crm_xml_add(marker, F_TYPE, T_CIB_NOTIFY);
+    crm_xml_add(marker, F_SUBTYPE, T_CIB_DIFF_NOTIFY);
+    crm_xml_add(marker, F_CIB_OPERATION, crm_element_value(msg, F_CIB_OPERATION));
+    crm_xml_add_int(marker, F_CIB_RC, -pcmk_err_diff_resync);
+    attach_cib_generation(marker, "cib_generation", the_cib);
+    return marker;
+}
+
+static void
+cib_notify_send_pending(crm_client_t * client)
+{
+    xmlNode *pending = NULL;
+
+    if (pending_diffs) {
+        pending = g_hash_table_lookup(pending_diffs, client->id);
+    }
+
+    if (pending) {
+        ssize_t sent = 0;
+
+        crm_trace("Sending held diff notification to %s/%s", client->name, client->id);
+        sent = crm_ipcs_send(client, 0, pending, crm_ipc_server_event);
+        if (sent < 0) {
+            crm_warn("Notification of client %s/%s failed", client->name, client->id);
+        } else {
+            cib_stats_notify(sent);
+        }
+        g_hash_table_remove(pending_diffs, client->id);
+    }
+}
+
+static gboolean
+cib_notify_pending_cb(gpointer data)
+{
+    GHashTableIter iter;
+    const char *id = NULL;
+
+    g_hash_table_iter_init(&iter, pending_diffs);
+    while (g_hash_table_iter_next(&iter, (gpointer *) & id, NULL)) {
+        crm_client_t *client = crm_client_get_by_id(id);
+
+        if (client == NULL) {
+            g_hash_table_iter_remove(&iter);
+
+        } else if (crm_ipcs_event_backlog(client) < CIB_NOTIFY_BACKLOG) {
+            ssize_t sent = 0;
+
+            crm_trace("Sending held diff notification to %s/%s", client->name, client->id);
+            sent = crm_ipcs_send(client, 0, g_hash_table_lookup(pending_diffs, id),
+                                 crm_ipc_server_event);
+            if (sent < 0) {
+                crm_warn("Notification of client %s/%s failed", client->name, client->id);
+            } else {
+                cib_stats_notify(sent);
+            }
+            g_hash_table_iter_remove(&iter);
+        }
+    }
+
+    return g_hash_table_size(pending_diffs) > 0;
+}
+
+static void
+cib_notify_hold(crm_client_t * client, xmlNode * msg)
+{
+    xmlNode *pending = NULL;
+    xmlNode *merged = NULL;
+
+    if (pending_diffs == NULL) {
+        pending_diffs = g_hash_table_new_full(crm_str_hash, g_str_equal, free, (GDestroyNotify) free_xml);
+        pending_timer = mainloop_timer_add("cib-notify", 1000, TRUE, cib_notify_pending_cb, NULL);
+    }
+
+    pending = g_hash_table_lookup(pending_diffs, client->id);
+    if (pending == NULL) {
+        crm_debug("Holding back diff notifications for %s/%s: %u events queued",
+                  client->name, client->id, crm_ipcs_event_backlog(client));
+        merged = copy_xml(msg);
+
+    } else {
+        merged = cib_notify_merge(pending, msg);
+
+        if (merged) {
+            diffs_coalesced++;
+
+        } else {
+            crm_info("Client %s/%s has fallen too far behind, it will need to re-read the CIB",
+                     client->name, client->id);
+            merged = cib_notify_refresh_marker(msg);
+            diffs_refreshed++;
+        }
+    }
+
+    g_hash_table_replace(pending_diffs, strdup(client->id), merged);
+    if (mainloop_timer_running(pending_timer) == FALSE) {
+        mainloop_timer_start(pending_timer);
+    }
+}
+
 static void
 need_pre_notify(gpointer key, gpointer value, gpointer user_data)
 {
@@ -113,11 +361,28 @@ cib_notify_send_one(gpointer key, gpointer value, gpointer user_data)
         do_send = TRUE;
     }
 
+    if (do_send && client->kind == CRM_CLIENT_IPC) {
+        if (safe_str_eq(type, T_CIB_DIFF_NOTIFY) == FALSE) {
+            /* Keep notifications in order */
+            cib_notify_send_pending(client);
+
+        } else if ((pending_diffs && g_hash_table_lookup(pending_diffs, client->id))
+                   || crm_ipcs_event_backlog(client) >= CIB_NOTIFY_BACKLOG) {
+            cib_notify_hold(client, update->msg);
+            if (crm_ipcs_event_backlog(client) < CIB_NOTIFY_BACKLOG) {
+                cib_notify_send_pending(client);
+            }
+            return FALSE;
+        }
+    }
+
     if (do_send) {
         switch (client->kind) {
             case CRM_CLIENT_IPC:
                 if (crm_ipcs_sendv(client, update->iov, crm_ipc_server_event) < 0) {
                     crm_warn("Notification of client %s/%s failed", client->name, client->id);
+                } else {
+                    cib_stats_notify(update->iov_size);
                 }
                 break;
 #ifdef HAVE_GNUTLS_GNUTLS_H
@@ -125,7 +390,10 @@ cib_notify_send_one(gpointer key, gpointer value, gpointer user_data)
 #endif
             case CRM_CLIENT_TCP:
                 crm_debug("Sent %s notification to client %s/%s", type, client->name, client->id);
-                crm_remote_send(client->remote, update->msg);
+                if (crm_remote_send(client->remote, update->msg) >= 0) {
+                    /* Approximate, counted at the size of the IPC encoding */
+                    cib_stats_notify(update->iov_size);
+                }
                 break;
             default:
                 crm_err("Unknown transport %d for %s", client->kind, client->name);
@@ -377,3 +645,49 @@ cib_replace_notify(const char *origin, xmlNode * update, int result, xmlNode * d
     cib_notify_send(replace_msg);
     free_xml(replace_msg);
 }
+
+void
+cib_notify_stats(xmlNode * parent)
+{
+    GHashTableIter iter;
+    crm_client_t *client = NULL;
+    xmlNode *xml = create_xml_node(parent, "notifications");
+
+    crm_xml_add_int(xml, "coalesced", diffs_coalesced);
+    crm_xml_add_int(xml, "refreshes", diffs_refreshed);
+
+    g_hash_table_iter_init(&iter, client_connections);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) & client)) {
+        xmlNode *xml_client = NULL;
+        unsigned int peak = 0;
+        unsigned int max = 0;
+
+        if (client->kind != CRM_CLIENT_IPC) {
+            continue;
+        }
+
+        crm_ipcs_event_limits(client, &peak, &max);
+
+        xml_client = create_xml_node(xml, "client");
+        crm_xml_add(xml_client, "name", client->name);
+        crm_xml_add(xml_client, XML_ATTR_ID, client->id);
+        crm_xml_add_int(xml_client, "backlog", crm_ipcs_event_backlog(client));
+        crm_xml_add_int(xml_client, "backlog-peak", peak);
+        crm_xml_add_int(xml_client, "backlog-max", max);
+        crm_xml_add_int(xml_client, "held",
+                        pending_diffs && g_hash_table_lookup(pending_diffs, client->id) ? 1 : 0);
+    }
+}
+
+void
+cib_notify_cleanup(void)
+{
+    if (pending_timer) {
+        mainloop_timer_del(pending_timer);
+        pending_timer = NULL;
+    }
+    if (pending_diffs) {
+        g_hash_table_destroy(pending_diffs);
+        pending_diffs = NULL;
+    }
+}
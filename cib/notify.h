@@ -35,3 +35,6 @@ extern void cib_diff_notify(int options, const char *client, const char *call_id
                             xmlNode * update, int result, xmlNode * old_cib);
 
 extern void cib_replace_notify(const char *origin, xmlNode * update, int result, xmlNode * diff);
+
+extern void cib_notify_stats(xmlNode * parent);
+extern void cib_notify_cleanup(void);
@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/*
+ * Measure the throughput of bulk updates through a remote CIB connection
+ *
+ * The connection is set up from the usual CIB_server, CIB_port, CIB_user,
+ * CIB_passwd and CIB_encrypted environment variables, so point them at the
+ * loopback interface of a cluster node with remote-tls-port or
+ * remote-clear-port set.  Each update sets a property in a cluster property
+ * set of its own, which is removed again at the end, so use a test cluster.
+ *
+ * Updates are either synchronous, one at a time, or asynchronous with up to
+ * --parallel outstanding.  --compare runs the same load over two sessions
+ * (CIB_multiplex=false) and over one, one after the other.
+ */
+
+#include <crm_internal.h>
+
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <crm/crm.h>
+#include <crm/msg_xml.h>
+#include <crm/common/xml.h>
+#include <crm/common/mainloop.h>
+#include <crm/cib.h>
+
+#define BENCH_SET_ID    "cib-remote-bench"
+#define BENCH_ATTR      "cib-remote-bench-counter"
+
+/* *INDENT-OFF* */
+static struct crm_option long_options[] = {
+    {"help",     0, 0, '?'},
+    {"verbose",  0, 0, 'V', "\tPrint out logs and events to screen"},
+    {"count",    1, 0, 'c', "\tNumber of updates to make (default 1000)"},
+    {"parallel", 1, 0, 'P', "Asynchronous updates to keep outstanding, 0 for synchronous ones (default 10)"},
+    {"notify",   0, 0, 'n', "\tAlso subscribe to diff notifications, as monitoring tools do"},
+    {"compare",  0, 0, 'C', "\tRun over two sessions and then over one"},
+    {"-spacer-", 1, 0, '-', "\nExamples:"},
+    {"-spacer-", 1, 0, '-', "Compare both connection modes on a node with remote-tls-port=9999:", pcmk_option_paragraph},
+    {"-spacer-", 1, 0, '-', " CIB_server=127.0.0.1 CIB_port=9999 CIB_user=hacluster CIB_passwd=secret cib_remote_bench --compare --notify", pcmk_option_example},
+    {0, 0, 0, 0}
+};
+/* *INDENT-ON* */
+
+static struct {
+    int count;
+    int parallel;
+    gboolean notify;
+} options;
+
+static GMainLoop *mainloop = NULL;
+static cib_t *cib_conn = NULL;
+static int sent = 0;
+static int completed = 0;
+static int failed = 0;
+static int notified = 0;
+
+static void send_more(void);
+
+static xmlNode *
+bench_update_xml(int value)
+{
+    xmlNode *set = create_xml_node(NULL, XML_CIB_TAG_PROPSET);
+    xmlNode *nvpair = NULL;
+
+    crm_xml_add(set, XML_ATTR_ID, BENCH_SET_ID);
+    nvpair = create_xml_node(set, XML_CIB_TAG_NVPAIR);
+    crm_xml_add(nvpair, XML_ATTR_ID, BENCH_ATTR);
+    crm_xml_add(nvpair, XML_NVPAIR_ATTR_NAME, BENCH_ATTR);
+    crm_xml_add_int(nvpair, XML_NVPAIR_ATTR_VALUE, value);
+    return set;
+}
+
+static void
+bench_notify(const char *event, xmlNode * msg)
+{
+    notified++;
+}
+
+static void
+bench_updated(xmlNode * msg, int call_id, int rc, xmlNode * output, void *user_data)
+{
+    completed++;
+    if (rc != pcmk_ok) {
+        failed++;
+        crm_info("Update %d failed: %s", call_id, pcmk_strerror(rc));
+    }
+    send_more();
+}
+
+static void
+send_more(void)
+{
+    while (sent < options.count && sent - completed < options.parallel) {
+        xmlNode *update = bench_update_xml(sent++);
+        int call_id = cib_conn->cmds->modify(cib_conn, XML_CIB_TAG_CRMCONFIG, update,
+                                             cib_can_create);
+
+        free_xml(update);
+        if (call_id < 0) {
+            completed++;
+            failed++;
+            crm_info("Could not send update: %s", pcmk_strerror(call_id));
+            continue;
+        }
+        cib_conn->cmds->register_callback(cib_conn, call_id, 120, FALSE, NULL,
+                                          "bench_updated", bench_updated);
+    }
+
+    if (completed == options.count) {
+        g_main_quit(mainloop);
+    }
+}
+
+static gboolean
+start_async(gpointer user_data)
+{
+    send_more();
+    return FALSE;
+}
+
+static int
+run_bench(gboolean multiplex)
+{
+    int rc = pcmk_ok;
+    long long start = 0;
+    long long elapsed = 0;
+    xmlNode *set = NULL;
+
+    /* Read by cib_remote_new() */
+    setenv("CIB_multiplex", multiplex? "true" : "false", 1);
+
+    sent = completed = failed = notified = 0;
+    cib_conn = cib_new();
+    rc = cib_conn->cmds->signon(cib_conn, crm_system_name, cib_command);
+    if (rc != pcmk_ok) {
+        fprintf(stderr, "Could not connect to the CIB: %s\n", pcmk_strerror(rc));
+        cib_delete(cib_conn);
+        return rc;
+    }
+
+    if (options.notify) {
+        cib_conn->cmds->add_notify_callback(cib_conn, T_CIB_DIFF_NOTIFY, bench_notify);
+    }
+
+    start = crm_monotonic_usec();
+    if (options.parallel > 0) {
+        g_idle_add(start_async, NULL);
+        g_main_run(mainloop);
+
+    } else {
+        for (; sent < options.count; sent++) {
+            xmlNode *update = bench_update_xml(sent);
+
+            rc = cib_conn->cmds->modify(cib_conn, XML_CIB_TAG_CRMCONFIG, update,
+                                        cib_can_create | cib_sync_call);
+            free_xml(update);
+            completed++;
+            if (rc != pcmk_ok) {
+                failed++;
+                crm_info("Update %d failed: %s", sent, pcmk_strerror(rc));
+            }
+        }
+    }
+    elapsed = crm_monotonic_usec() - start;
+
+    printf("%s: %d %s updates (%d failed) in %.1fms: %.0f/s, %d notifications\n",
+           multiplex? "one session " : "two sessions", options.count,
+           options.parallel? "asynchronous" : "synchronous", failed, elapsed / 1000.0,
+           options.count * 1000000.0 / QB_MAX(elapsed, 1), notified);
+
+    set = create_xml_node(NULL, XML_CIB_TAG_PROPSET);
+    crm_xml_add(set, XML_ATTR_ID, BENCH_SET_ID);
+    cib_conn->cmds->delete(cib_conn, XML_CIB_TAG_CRMCONFIG, set, cib_sync_call);
+    free_xml(set);
+
+    cib_conn->cmds->signoff(cib_conn);
+    cib_delete(cib_conn);
+    cib_conn = NULL;
+    return failed? -EIO : pcmk_ok;
+}
+
+int
+main(int argc, char **argv)
+{
+    int flag = 0;
+    int argerr = 0;
+    int option_index = 0;
+    int rc = pcmk_ok;
+    gboolean compare = FALSE;
+
+    options.count = 1000;
+    options.parallel = 10;
+
+    crm_set_options(NULL, "[options]", long_options,
+                    "Measure the throughput of bulk updates through a remote CIB connection\n");
+
+    while (1) {
+        flag = crm_get_option(argc, argv, &option_index);
+        if (flag == -1)
+            break;
+
+        switch (flag) {
+            case '?':
+                crm_help(flag, EX_OK);
+                break;
+            case 'V':
+                crm_bump_log_level(argc, argv);
+                break;
+            case 'c':
+                options.count = crm_parse_int(optarg, "1000");
+                break;
+            case 'P':
+                options.parallel = crm_parse_int(optarg, "10");
+                break;
+            case 'n':
+                options.notify = TRUE;
+                break;
+            case 'C':
+                compare = TRUE;
+                break;
+            default:
+                ++argerr;
+                break;
+        }
+    }
+
+    if (argerr || options.count < 1 || options.parallel < 0) {
+        crm_help('?', EX_USAGE);
+    }
+
+    crm_log_init(NULL, LOG_INFO, FALSE, FALSE, argc, argv, FALSE);
+
+    if (getenv("CIB_port") == NULL) {
+        fprintf(stderr, "Set CIB_port (and CIB_server, CIB_user and CIB_passwd)"
+                " to use a remote CIB connection\n");
+        return 1;
+    }
+
+    mainloop = g_main_new(FALSE);
+    if (compare) {
+        rc = run_bench(FALSE);
+    }
+    if (rc == pcmk_ok) {
+        rc = run_bench(TRUE);
+    }
+    g_main_loop_unref(mainloop);
+    return rc == pcmk_ok? 0 : 1;
+}
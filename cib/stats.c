@@ -0,0 +1,423 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <crm_internal.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+
+#include <crm/crm.h>
+#include <crm/cib/internal.h>
+#include <crm/msg_xml.h>
+#include <crm/common/xml.h>
+#include <crm/common/mainloop.h>
+
+#include <notify.h>
+#include <stats.h>
+
+/* Bucket N counts latencies in [2^(N-1), 2^N) microseconds, the last one is open ended */
+#define CIB_STATS_BUCKETS 32
+
+typedef struct cib_histogram_s {
+    unsigned long count;
+    unsigned long long total;
+    unsigned long long max;
+    unsigned long buckets[CIB_STATS_BUCKETS];
+} cib_histogram_t;
+
+typedef struct cib_op_stats_s {
+    char *op;
+    unsigned long failures;
+    unsigned long long bytes_in;
+    unsigned long long bytes_out;
+    unsigned long long bytes_notify;
+    cib_histogram_t latency;
+    cib_histogram_t phases[cib_phase_max];
+} cib_op_stats_t;
+
+typedef struct cib_client_stats_s {
+    char *name;
+    unsigned long count;
+    unsigned long long total;
+} cib_client_stats_t;
+
+/* The operation currently being processed, requests are handled one at a time */
+static struct cib_current_op_s {
+    cib_op_stats_t *stats;
+    cib_client_stats_t *client;
+    long long start;
+    size_t bytes_in;
+    size_t bytes_out;
+    size_t bytes_notify;
+    long long phases[cib_phase_max];
+} current;
+
+static GHashTable *op_stats = NULL;
+static GHashTable *client_stats = NULL;
+static size_t pending_bytes_in = 0;
+static unsigned long long notify_bytes = 0;
+static time_t stats_since = 0;
+static mainloop_timer_t *stats_timer = NULL;
+
+static void
+cib_histogram_add(cib_histogram_t * histogram, long long usec)
+{
+    int bucket = 0;
+
+    if (usec < 0) {
+        usec = 0;
+    }
+
+    while (bucket < (CIB_STATS_BUCKETS - 1) && (1LL << bucket) <= usec) {
+        bucket++;
+    }
+
+    histogram->count++;
+    histogram->total += usec;
+    histogram->buckets[bucket]++;
+    if (usec > histogram->max) {
+        histogram->max = usec;
+    }
+}
+
+/* Returns the upper bound of the bucket containing the given percentile */
+static unsigned long long
+cib_histogram_percentile(cib_histogram_t * histogram, int percentile)
+{
+    int bucket = 0;
+    unsigned long seen = 0;
+    unsigned long wanted = ((histogram->count * percentile) + 99) / 100;
+
+    if (histogram->count == 0) {
+        return 0;
+    }
+
+    for (bucket = 0; bucket < CIB_STATS_BUCKETS; bucket++) {
+        seen += histogram->buckets[bucket];
+        if (seen >= wanted) {
+            break;
+        }
+    }
+
+    if (bucket >= CIB_STATS_BUCKETS - 1) {
+        return histogram->max;
+    }
+    return QB_MIN(1ULL << bucket, histogram->max);
+}
+
+static void
+cib_histogram_xml(cib_histogram_t * histogram, xmlNode * xml)
+{
+    char buffer[64];
+
+    crm_xml_add_int(xml, "count", histogram->count);
+
+    snprintf(buffer, sizeof(buffer), "%llu", histogram->total);
+    crm_xml_add(xml, "total-usec", buffer);
+
+    snprintf(buffer, sizeof(buffer), "%llu", cib_histogram_percentile(histogram, 50));
+    crm_xml_add(xml, "p50-usec", buffer);
+
+    snprintf(buffer, sizeof(buffer), "%llu", cib_histogram_percentile(histogram, 99));
+    crm_xml_add(xml, "p99-usec", buffer);
+
+    snprintf(buffer, sizeof(buffer), "%llu", histogram->max);
+    crm_xml_add(xml, "max-usec", buffer);
+}
+
+static void
+free_op_stats(gpointer data)
+{
+    cib_op_stats_t *stats = data;
+
+    free(stats->op);
+    free(stats);
+}
+
+static void
+free_client_stats(gpointer data)
+{
+    cib_client_stats_t *stats = data;
+
+    free(stats->name);
+    free(stats);
+}
+
+void
+cib_stats_input(size_t bytes)
+{
+    pending_bytes_in = bytes;
+}
+
+void
+cib_stats_output(size_t bytes)
+{
+    current.bytes_out += bytes;
+}
+
+/* Notifications sent while an operation is being processed are charged to
+ * it, held ones sent later only count towards the overall total
+ */
+void
+cib_stats_notify(size_t bytes)
+{
+    notify_bytes += bytes;
+    if (current.stats) {
+        current.bytes_notify += bytes;
+    }
+}
+
+void
+cib_stats_op_begin(const char *op, const char *client)
+{
+    if (op_stats == NULL) {
+        cib_stats_init(NULL);
+    }
+
+    CRM_LOG_ASSERT(current.stats == NULL);
+    memset(&current, 0, sizeof(current));
+
+    current.start = crm_monotonic_usec();
+    current.bytes_in = pending_bytes_in;
+    pending_bytes_in = 0;
+
+    if (op == NULL) {
+        op = "unknown";
+    }
+    current.stats = g_hash_table_lookup(op_stats, op);
+    if (current.stats == NULL) {
+        current.stats = calloc(1, sizeof(cib_op_stats_t));
+        current.stats->op = strdup(op);
+        g_hash_table_insert(op_stats, current.stats->op, current.stats);
+    }
+
+    if (client == NULL) {
+        client = "peer";
+    }
+    current.client = g_hash_table_lookup(client_stats, client);
+    if (current.client == NULL) {
+        current.client = calloc(1, sizeof(cib_client_stats_t));
+        current.client->name = strdup(client);
+        g_hash_table_insert(client_stats, current.client->name, current.client);
+    }
+}
+
+void
+cib_stats_phase(enum cib_op_phase phase, long long usec)
+{
+    CRM_CHECK(phase < cib_phase_max, return);
+    current.phases[phase] += usec;
+}
+
+/* Pick up the phase timings recorded by the last cib_perform_op() call */
+void
+cib_stats_perform_op(void)
+{
+    int lpc = 0;
+
+    for (lpc = 0; lpc < cib_phase_max; lpc++) {
+        current.phases[lpc] += cib_op_phase_usec[lpc];
+    }
+}
+
+void
+cib_stats_op_end(int rc)
+{
+    int lpc = 0;
+    long long elapsed = 0;
+    cib_op_stats_t *stats = current.stats;
+
+    if (stats == NULL) {
+        return;
+    }
+
+    elapsed = crm_monotonic_usec() - current.start;
+    cib_histogram_add(&stats->latency, elapsed);
+
+    for (lpc = 0; lpc < cib_phase_max; lpc++) {
+        if (current.phases[lpc] > 0) {
+            cib_histogram_add(&stats->phases[lpc], current.phases[lpc]);
+        }
+    }
+
+    if (rc != pcmk_ok) {
+        stats->failures++;
+    }
+    stats->bytes_in += current.bytes_in;
+    stats->bytes_out += current.bytes_out;
+    stats->bytes_notify += current.bytes_notify;
+
+    current.client->count++;
+    current.client->total += elapsed;
+
+    crm_trace("%s op from %s took %lldus", stats->op, current.client->name, elapsed);
+    current.stats = NULL;
+    current.client = NULL;
+}
+
+xmlNode *
+cib_stats_xml(xmlNode * parent)
+{
+    GHashTableIter iter;
+    char buffer[64];
+    cib_op_stats_t *stats = NULL;
+    cib_client_stats_t *client = NULL;
+    xmlNode *xml = create_xml_node(parent, "cib-stats");
+
+    crm_xml_add_int(xml, "since", stats_since);
+    crm_xml_add_int(xml, "interval", time(NULL) - stats_since);
+
+    snprintf(buffer, sizeof(buffer), "%llu", notify_bytes);
+    crm_xml_add(xml, "notify-bytes", buffer);
+
+    if (op_stats == NULL) {
+        return xml;
+    }
+
+    g_hash_table_iter_init(&iter, op_stats);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) & stats)) {
+        int lpc = 0;
+        xmlNode *op = create_xml_node(xml, "operation");
+
+        crm_xml_add(op, "name", stats->op);
+        cib_histogram_xml(&stats->latency, op);
+        crm_xml_add_int(op, "failures", stats->failures);
+
+        snprintf(buffer, sizeof(buffer), "%llu", stats->bytes_in);
+        crm_xml_add(op, "bytes-in", buffer);
+        snprintf(buffer, sizeof(buffer), "%llu", stats->bytes_out);
+        crm_xml_add(op, "bytes-out", buffer);
+        snprintf(buffer, sizeof(buffer), "%llu", stats->bytes_notify);
+        crm_xml_add(op, "bytes-notify", buffer);
+
+        for (lpc = 0; lpc < cib_phase_max; lpc++) {
+            if (stats->phases[lpc].count > 0) {
+                xmlNode *phase = create_xml_node(op, "phase");
+
+                crm_xml_add(phase, "name", cib_op_phase_text(lpc));
+                cib_histogram_xml(&stats->phases[lpc], phase);
+            }
+        }
+    }
+
+    g_hash_table_iter_init(&iter, client_stats);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) & client)) {
+        xmlNode *xml_client = create_xml_node(xml, "client");
+
+        crm_xml_add(xml_client, "name", client->name);
+        crm_xml_add_int(xml_client, "count", client->count);
+        snprintf(buffer, sizeof(buffer), "%llu", client->total);
+        crm_xml_add(xml_client, "total-usec", buffer);
+    }
+
+    cib_notify_stats(xml);
+    return xml;
+}
+
+void
+cib_stats_log(int log_level)
+{
+    GHashTableIter iter;
+    cib_op_stats_t *stats = NULL;
+    cib_client_stats_t *client = NULL;
+
+    if (op_stats == NULL) {
+        return;
+    }
+
+    g_hash_table_iter_init(&iter, op_stats);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) & stats)) {
+        int lpc = 0;
+
+        do_crm_log(log_level,
+                   "%s: %lu ops (%lu failed), p50=%lluus p99=%lluus max=%lluus, %llu bytes in, %llu bytes out, %llu bytes notified",
+                   stats->op, stats->latency.count, stats->failures,
+                   cib_histogram_percentile(&stats->latency, 50),
+                   cib_histogram_percentile(&stats->latency, 99),
+                   stats->latency.max, stats->bytes_in, stats->bytes_out,
+                   stats->bytes_notify);
+
+        for (lpc = 0; lpc < cib_phase_max; lpc++) {
+            if (stats->phases[lpc].count > 0) {
+                do_crm_log(log_level, "%s: - %s p50=%lluus p99=%lluus max=%lluus",
+                           stats->op, cib_op_phase_text(lpc),
+                           cib_histogram_percentile(&stats->phases[lpc], 50),
+                           cib_histogram_percentile(&stats->phases[lpc], 99),
+                           stats->phases[lpc].max);
+            }
+        }
+    }
+
+    g_hash_table_iter_init(&iter, client_stats);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) & client)) {
+        do_crm_log(log_level, "Client %s: %lu ops, %lluus total",
+                   client->name, client->count, client->total);
+    }
+}
+
+static gboolean
+cib_stats_timer_cb(gpointer data)
+{
+    cib_stats_log(LOG_DEBUG);
+    return TRUE;
+}
+
+/* Replaces the default SIGTRAP handler so the dump includes current figures */
+static void
+cib_stats_blackbox(int nsig)
+{
+    crm_enable_blackbox(nsig);
+    cib_stats_log(LOG_DEBUG);
+    crm_write_blackbox(nsig, NULL);
+}
+
+void
+cib_stats_init(const char *interval)
+{
+    if (op_stats == NULL) {
+        op_stats = g_hash_table_new_full(crm_str_hash, g_str_equal, NULL, free_op_stats);
+        client_stats = g_hash_table_new_full(crm_str_hash, g_str_equal, NULL, free_client_stats);
+        stats_since = time(NULL);
+    }
+
+    if (interval && stats_timer == NULL) {
+        stats_timer = mainloop_timer_add("cib-stats", crm_get_msec(interval), TRUE,
+                                         cib_stats_timer_cb, NULL);
+        mainloop_timer_start(stats_timer);
+
+        mainloop_destroy_signal(SIGTRAP);
+        mainloop_add_signal(SIGTRAP, cib_stats_blackbox);
+    }
+}
+
+void
+cib_stats_cleanup(void)
+{
+    if (stats_timer) {
+        mainloop_timer_del(stats_timer);
+        stats_timer = NULL;
+    }
+    if (op_stats) {
+        g_hash_table_destroy(op_stats);
+        g_hash_table_destroy(client_stats);
+        op_stats = NULL;
+        client_stats = NULL;
+    }
+}
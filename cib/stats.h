@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef CIB_STATS__H
+#  define CIB_STATS__H
+
+#  include <crm/cib/internal.h>
+
+/*
+ * Per-operation latency and throughput instrumentation
+ *
+ * Every request handled by cib_process_request() is bracketed by
+ * cib_stats_op_begin() and cib_stats_op_end(), with the phases in between
+ * (apply, ACL evaluation, diff creation, validation, digest, CPG send and
+ * notification) accumulated into log2 latency histograms per operation type.
+ */
+
+void cib_stats_input(size_t bytes);
+void cib_stats_output(size_t bytes);
+void cib_stats_notify(size_t bytes);
+
+void cib_stats_op_begin(const char *op, const char *client);
+void cib_stats_phase(enum cib_op_phase phase, long long usec);
+void cib_stats_perform_op(void);
+void cib_stats_op_end(int rc);
+
+xmlNode *cib_stats_xml(xmlNode * parent);
+void cib_stats_log(int log_level);
+void cib_stats_init(const char *interval);
+void cib_stats_cleanup(void);
+
+#endif
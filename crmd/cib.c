@@ -42,6 +42,7 @@
 #include <crm/common/xml.h>
 #include <crmd_messages.h>
 #include <crmd_callbacks.h>
+#include <crmd_lrm.h>
 
 #include <crmd.h>
 
@@ -61,11 +62,19 @@ do_cib_updated(const char *event, xmlNode * msg)
 
     CRM_CHECK(msg != NULL, return);
     crm_element_value_int(msg, F_CIB_RC, &rc);
-    if (rc < pcmk_ok) {
+    if (rc == -pcmk_err_diff_resync) {
+        /* The CIB dropped notifications we were too slow to read */
+        pe_cib_updated(NULL);
+        mainloop_set_trigger(config_read);
+        return;
+
+    } else if (rc < pcmk_ok) {
         crm_trace("Filter rc=%d (%s)", rc, pcmk_strerror(rc));
         return;
     }
 
+    pe_cib_updated(patchset);
+
     crm_element_value_int(patchset, "format", &format);
     if (format == 1) {
         if (get_xpath_object
@@ -155,6 +164,14 @@ do_cib_control(long long action,
 
     if (action & stop_actions) {
 
+        if (fsa_cib_conn->state != cib_disconnected) {
+            /* Write out any resource updates still waiting for agent
+             * metadata or being batched
+             */
+            lrm_metadata_flush_parked();
+            lrm_status_flush(NULL);
+        }
+
         if (fsa_cib_conn->state != cib_disconnected && last_resource_update != 0) {
             crm_info("Waiting for resource update %d to complete", last_resource_update);
             crmd_fsa_stall(FALSE);
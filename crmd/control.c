@@ -228,7 +228,6 @@ extern char *max_generation_from;
 extern xmlNode *max_generation_xml;
 extern GHashTable *resource_history;
 extern GHashTable *voted;
-extern GHashTable *metadata_hash;
 extern char *te_client_id;
 
 void log_connected_client(gpointer key, gpointer value, gpointer user_data);
@@ -342,10 +341,7 @@ crmd_exit(int rc)
     free(te_subsystem); te_subsystem = NULL;
     free(cib_subsystem); cib_subsystem = NULL;
 
-    if (metadata_hash) {
-        crm_trace("Destroying reload cache with %d members", g_hash_table_size(metadata_hash));
-        g_hash_table_destroy(metadata_hash); metadata_hash = NULL;
-    }
+    lrm_metadata_cleanup();
 
     election_fini(fsa_election);
     fsa_election = NULL;
@@ -355,7 +351,9 @@ crmd_exit(int rc)
 
     verify_stopped(fsa_state, LOG_WARNING);
     clear_bit(fsa_input_register, R_LRM_CONNECTED);
+    lrm_status_cleanup();
     lrm_state_destroy_all();
+    history_cleanup();
 
     /* This basically will not work, since mainloop has a reference to it */
     mainloop_destroy_trigger(fsa_source); fsa_source = NULL;
@@ -892,6 +890,10 @@ pe_cluster_option crmd_opts[] = {
 	{ XML_CONFIG_ATTR_FORCE_QUIT, "shutdown_escalation", "time", NULL, "20min", &check_timer, "*** Advanced Use Only ***.", "If need to adjust this value, it probably indicates the presence of a bug." },
 	{ "crmd-integration-timeout", NULL, "time", NULL, "3min", &check_timer, "*** Advanced Use Only ***.", "If need to adjust this value, it probably indicates the presence of a bug." },
 	{ "crmd-finalization-timeout", NULL, "time", NULL, "30min", &check_timer, "*** Advanced Use Only ***.", "If you need to adjust this value, it probably indicates the presence of a bug." },
+	{ "crmd-status-batch-delay", NULL, "time", NULL, "0s", &check_timer, "*** Advanced Use Only ***\nHow long to collect operation results before writing them to the CIB", "Results arriving within this window are sent as a single status update per node.\nThe default only combines results that were already waiting to be processed." },
+	{ "crmd-remote-connect-limit", NULL, "integer", NULL, "10", &check_number, "*** Advanced Use Only ***\nThe maximum number of remote node connections to establish at once", "Further connections wait for one of these to complete, those with the most pending actions first.\nA value of 0 means unlimited." },
+	{ "crmd-pe-debounce", NULL, "time", NULL, "0s", &check_timer, "*** Advanced Use Only ***\nMinimum interval between policy engine calculations", "Requests for a new calculation arriving within this interval of the last one are combined into a single calculation at the end of it." },
+	{ "crmd-pe-incremental", NULL, "boolean", NULL, "false", &check_boolean, "*** Advanced Use Only ***\nSend the policy engine CIB updates instead of the whole CIB", "The policy engine keeps a copy of the CIB from the last full calculation and subsequent calculations are sent only the status changes made since.\nConfiguration changes always result in the whole CIB being sent." },
 	{ "crmd-transition-delay", NULL, "time", NULL, "0s", &check_timer, "*** Advanced Use Only ***\nEnabling this option will slow down cluster recovery under all conditions", "Delay cluster recovery for the configured interval to allow for additional/related events to occur.\nUseful if your configuration is sensitive to the order in which ping updates arrive." },
 	{ "stonith-watchdog-timeout", NULL, "time", NULL, NULL, &check_timer,
 	  "How long to wait before we can assume nodes are safely down", NULL },
@@ -1019,6 +1021,16 @@ config_query_callback(xmlNode * msg, int call_id, int rc, xmlNode * output, void
     value = crmd_pref(config_hash, "crmd-transition-delay");
     transition_timer->period_ms = crm_get_msec(value);
 
+    value = crmd_pref(config_hash, "crmd-status-batch-delay");
+    lrm_status_set_delay(crm_get_msec(value));
+
+    value = crmd_pref(config_hash, "crmd-remote-connect-limit");
+    remote_ra_set_connect_limit(crm_parse_int(value, "10"));
+
+    value = crmd_pref(config_hash, "crmd-pe-debounce");
+    pe_invoke_set_options(crm_get_msec(value),
+                          crm_is_true(crmd_pref(config_hash, "crmd-pe-incremental")));
+
     value = crmd_pref(config_hash, "crmd-integration-timeout");
     integration_timer->period_ms = crm_get_msec(value);
 
@@ -25,13 +25,13 @@ void lrm_op_callback(lrmd_event_data_t * op);
 typedef struct resource_history_s {
     char *id;
     uint32_t last_callid;
-    lrmd_rsc_info_t rsc;
-    lrmd_event_data_t *last;
+    lrmd_rsc_info_t rsc;        /* type, class and provider are interned */
+    lrmd_event_data_t *last;    /* see history_copy_event() */
     lrmd_event_data_t *failed;
     GList *recurring_op_list;
 
     /* Resources must be stopped using the same
-     * parameters they were started with.  This hashtable
+     * parameters they were started with.  This (interned) hashtable
      * holds the parameters that should be used for the next stop
      * cmd on this resource. */
     GHashTable *stop_params;
@@ -39,6 +39,15 @@ typedef struct resource_history_s {
 
 void history_free(gpointer data);
 
+GHashTable *history_params_intern(GHashTable * params);
+void history_params_release(GHashTable * params);
+const char *history_str_intern(const char *str);
+void history_str_release(const char *str);
+lrmd_event_data_t *history_copy_event(rsc_history_t * history, lrmd_event_data_t * op);
+void history_free_event(lrmd_event_data_t * op);
+void history_report(xmlNode * parent);
+void history_cleanup(void);
+
 /* TDOD - Replace this with lrmd_event_data_t */
 struct recurring_op_s {
     int call_id;
@@ -75,6 +84,12 @@ struct pending_deletion_op_s {
 
 xmlNode *do_lrm_query_internal(lrm_state_t * lrm_state, gboolean is_replace);
 
+void lrm_status_flush(const char *node_name);
+void lrm_status_set_delay(guint delay_ms);
+void lrm_status_cleanup(void);
+void lrm_metadata_flush_parked(void);
+void lrm_metadata_cleanup(void);
+
 /*!
  * \brief Is this the local ipc connection to the lrmd
  */
@@ -160,6 +175,7 @@ int remote_ra_exec(lrm_state_t * lrm_state, const char *rsc_id, const char *acti
                    int start_delay,     /* ms */
                    lrmd_key_value_t * params);
 void remote_ra_cleanup(lrm_state_t * lrm_state);
+void remote_ra_set_connect_limit(int limit);
 
 xmlNode *simple_remote_node_status(const char *node_name, xmlNode *parent, const char *source);
 
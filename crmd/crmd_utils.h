@@ -102,6 +102,11 @@ gboolean too_many_st_failures(void);
 void st_fail_count_reset(const char * target);
 void crmd_peer_down(crm_node_t *peer, bool full);
 
+void pe_invoke_set_options(guint debounce_ms, gboolean incremental);
+void pe_cib_updated(xmlNode * patchset);
+gboolean pe_invoke_complete(xmlNode * reply);
+void pe_invoke_cleanup(void);
+
 /* Convenience macro for registering a CIB callback
  * (assumes that data can be freed with free())
  */
@@ -60,6 +60,8 @@ void send_direct_ack(const char *to_host, const char *to_sys,
 static gboolean lrm_state_verify_stopped(lrm_state_t * lrm_state, enum crmd_fsa_state cur_state,
                                          int log_level);
 static int do_update_resource(const char *node_name, lrmd_rsc_info_t * rsc, lrmd_event_data_t * op);
+static int do_update_resource_now(const char *node_name, lrmd_rsc_info_t * rsc,
+                                  lrmd_event_data_t * op);
 
 static void
 lrm_connection_destroy(void)
@@ -125,7 +127,7 @@ history_remove_recurring_op(rsc_history_t *history, const lrmd_event_data_t *op)
             && safe_str_eq(op->op_type, existing->op_type)) {
 
             history->recurring_op_list = g_list_delete_link(history->recurring_op_list, iter);
-            lrmd_free_event(existing);
+            history_free_event(existing);
             return TRUE;
         }
     }
@@ -144,7 +146,7 @@ history_free_recurring_ops(rsc_history_t *history)
     GList *iter;
 
     for (iter = history->recurring_op_list; iter != NULL; iter = iter->next) {
-        lrmd_free_event(iter->data);
+        history_free_event(iter->data);
     }
     g_list_free(history->recurring_op_list);
     history->recurring_op_list = NULL;
@@ -161,19 +163,17 @@ history_free(gpointer data)
 {
     rsc_history_t *history = (rsc_history_t*)data;
 
-    if (history->stop_params) {
-        g_hash_table_destroy(history->stop_params);
-    }
+    history_params_release(history->stop_params);
 
     /* Don't need to free history->rsc.id because it's set to history->id */
-    free(history->rsc.type);
-    free(history->rsc.class);
-    free(history->rsc.provider);
+    history_str_release(history->rsc.type);
+    history_str_release(history->rsc.class);
+    history_str_release(history->rsc.provider);
 
-    lrmd_free_event(history->failed);
-    lrmd_free_event(history->last);
-    free(history->id);
+    history_free_event(history->failed);
+    history_free_event(history->last);
     history_free_recurring_ops(history);
+    free(history->id);
     free(history);
 }
 
@@ -202,13 +202,9 @@ update_history_cache(lrm_state_t * lrm_state, lrmd_rsc_info_t * rsc, lrmd_event_
         g_hash_table_insert(lrm_state->resource_history, entry->id, entry);
 
         entry->rsc.id = entry->id;
-        entry->rsc.type = strdup(rsc->type);
-        entry->rsc.class = strdup(rsc->class);
-        if (rsc->provider) {
-            entry->rsc.provider = strdup(rsc->provider);
-        } else {
-            entry->rsc.provider = NULL;
-        }
+        entry->rsc.type = (char *)history_str_intern(rsc->type);
+        entry->rsc.class = (char *)history_str_intern(rsc->class);
+        entry->rsc.provider = (char *)history_str_intern(rsc->provider);
 
     } else if (entry == NULL) {
         crm_info("Resource %s no longer exists, not updating cache", op->rsc_id);
@@ -232,30 +228,26 @@ update_history_cache(lrm_state_t * lrm_state, lrmd_rsc_info_t * rsc, lrmd_event_
         /* We must store failed monitors here
          * - otherwise the block below will cause them to be forgetten them when a stop happens
          */
-        if (entry->failed) {
-            lrmd_free_event(entry->failed);
-        }
-        entry->failed = lrmd_copy_event(op);
+        history_free_event(entry->failed);
+        entry->failed = history_copy_event(entry, op);
 
     } else if (op->interval == 0) {
-        if (entry->last) {
-            lrmd_free_event(entry->last);
-        }
-        entry->last = lrmd_copy_event(op);
+        history_free_event(entry->last);
+        entry->last = history_copy_event(entry, op);
 
         if (op->params &&
             (safe_str_eq(CRMD_ACTION_START, op->op_type) ||
              safe_str_eq("reload", op->op_type) ||
              safe_str_eq(CRMD_ACTION_STATUS, op->op_type))) {
 
-            if (entry->stop_params) {
-                g_hash_table_destroy(entry->stop_params);
-            }
-            entry->stop_params = g_hash_table_new_full(crm_str_hash,
-                                                       g_str_equal, g_hash_destroy_str,
-                                                       g_hash_destroy_str);
+            GHashTable *stop_params = g_hash_table_new_full(crm_str_hash, g_str_equal,
+                                                            g_hash_destroy_str,
+                                                            g_hash_destroy_str);
 
-            g_hash_table_foreach(op->params, copy_instance_keys, entry->stop_params);
+            g_hash_table_foreach(op->params, copy_instance_keys, stop_params);
+            history_params_release(entry->stop_params);
+            entry->stop_params = history_params_intern(stop_params);
+            g_hash_table_destroy(stop_params);
         }
     }
 
@@ -264,7 +256,8 @@ update_history_cache(lrm_state_t * lrm_state, lrmd_rsc_info_t * rsc, lrmd_event_
         history_remove_recurring_op(entry, op);
 
         crm_trace("Adding recurring op: %s_%s_%d", op->rsc_id, op->op_type, op->interval);
-        entry->recurring_op_list = g_list_prepend(entry->recurring_op_list, lrmd_copy_event(op));
+        entry->recurring_op_list = g_list_prepend(entry->recurring_op_list,
+                                                  history_copy_event(entry, op));
 
     } else if (entry->recurring_op_list && safe_str_eq(op->op_type, RSC_STATUS) == FALSE) {
         crm_trace("Dropping %d recurring ops because of: %s_%s_%d",
@@ -465,62 +458,261 @@ lrm_state_verify_stopped(lrm_state_t * lrm_state, enum crmd_fsa_state cur_state,
     return rc;
 }
 
+/*
+ * Agent metadata is needed for the digests that accompany operation results.
+ * Retrieving it means running the agent, so it is cached (here, and on disk by
+ * the lrmd client library), and rather than block the mainloop while an agent
+ * runs, results needing metadata that isn't known yet are parked until it has
+ * been retrieved.
+ */
+
+typedef struct metadata_entry_s {
+    char *metadata;             /* NULL until retrieved */
+    gboolean pending;           /* retrieval in progress */
+    gboolean failed;            /* last retrieval failed */
+    GList *parked;              /* parked_update_t, in the order they arrived */
+} metadata_entry_t;
+
+typedef struct parked_update_s {
+    char *node_name;
+    lrmd_rsc_info_t *rsc;
+    lrmd_event_data_t *op;
+} parked_update_t;
+
 GHashTable *metadata_hash = NULL;
 
+static void
+parked_update_free(gpointer data)
+{
+    parked_update_t *update = data;
+
+    free(update->node_name);
+    lrmd_free_rsc_info(update->rsc);
+    lrmd_free_event(update->op);
+    free(update);
+}
+
+static void
+metadata_entry_free(gpointer data)
+{
+    metadata_entry_t *entry = data;
+
+    free(entry->metadata);
+    g_list_free_full(entry->parked, parked_update_free);
+    free(entry);
+}
+
 static char *
-get_rsc_metadata(const char *type, const char *rclass, const char *provider, bool force)
+metadata_key(lrmd_rsc_info_t * rsc)
+{
+    return crm_strdup_printf("%s::%s:%s", rsc->type, rsc->class,
+                             rsc->provider ? rsc->provider : "heartbeat");
+}
+
+static metadata_entry_t *
+metadata_entry(const char *key, gboolean create)
+{
+    metadata_entry_t *entry = NULL;
+
+    if (metadata_hash == NULL) {
+        metadata_hash = g_hash_table_new_full(crm_str_hash, g_str_equal, g_hash_destroy_str,
+                                              metadata_entry_free);
+    }
+
+    entry = g_hash_table_lookup(metadata_hash, key);
+    if (entry == NULL && create) {
+        entry = calloc(1, sizeof(metadata_entry_t));
+        g_hash_table_insert(metadata_hash, strdup(key), entry);
+    }
+    return entry;
+}
+
+static const char *
+get_rsc_metadata(lrmd_rsc_info_t * rsc)
 {
     int rc = pcmk_ok;
-    int len = 0;
     char *key = NULL;
-    char *metadata = NULL;
+    metadata_entry_t *entry = NULL;
 
     /* Always use a local connection for this operation */
     lrm_state_t *lrm_state = lrm_state_find(fsa_our_uname);
 
-    CRM_CHECK(type != NULL, return NULL);
-    CRM_CHECK(rclass != NULL, return NULL);
+    CRM_CHECK(rsc->type != NULL, return NULL);
+    CRM_CHECK(rsc->class != NULL, return NULL);
     CRM_CHECK(lrm_state != NULL, return NULL);
 
-    if (provider == NULL) {
-        provider = "heartbeat";
+    key = metadata_key(rsc);
+    entry = metadata_entry(key, TRUE);
+
+    if (entry->metadata == NULL && entry->failed == FALSE) {
+        /* Not every caller can wait, so fall back to retrieving it now */
+        rc = lrm_state_get_metadata(lrm_state, rsc->class,
+                                    rsc->provider ? rsc->provider : "heartbeat", rsc->type,
+                                    &entry->metadata, 0);
+        crm_trace("Retreived live metadata for %s: %s (%d)", key, pcmk_strerror(rc), rc);
+        CRM_LOG_ASSERT((rc == pcmk_ok) == (entry->metadata != NULL));
     }
 
-    if (metadata_hash == NULL) {
-        metadata_hash = g_hash_table_new_full(crm_str_hash, g_str_equal, g_hash_destroy_str, g_hash_destroy_str);
+    if (entry->metadata == NULL) {
+        crm_warn("No metadata found for %s: %s (%d)", key, pcmk_strerror(rc), rc);
     }
 
-    len = strlen(type) + strlen(rclass) + strlen(provider) + 4;
-    key = malloc(len);
-    if(key == NULL) {
-        return NULL;
+    free(key);
+    return entry->metadata;
+}
+
+/* Record the updates parked for an agent, in the order they arrived */
+static void
+metadata_flush_parked(metadata_entry_t * entry, const char *key, const char *reason)
+{
+    GList *gIter = NULL;
+    GList *parked = entry->parked;
+
+    entry->parked = NULL;
+    if (parked) {
+        crm_debug("Sending %d update%s parked until metadata for %s %s",
+                  g_list_length(parked), parked->next ? "s" : "", key, reason);
     }
 
-    snprintf(key, len, "%s::%s:%s", type, rclass, provider);
-    if(force == FALSE) {
-        crm_trace("Retreiving cached metadata for %s", key);
-        metadata = g_hash_table_lookup(metadata_hash, key);
+    for (gIter = parked; gIter != NULL; gIter = gIter->next) {
+        parked_update_t *update = gIter->data;
+
+        do_update_resource_now(update->node_name, update->rsc, update->op);
     }
+    g_list_free_full(parked, parked_update_free);
+}
 
-    if(metadata == NULL) {
-        rc = lrm_state_get_metadata(lrm_state, rclass, provider, type, &metadata, 0);
-        crm_trace("Retreived live metadata for %s: %s (%d)", key, pcmk_strerror(rc), rc);
-        if(rc == pcmk_ok) {
-            CRM_LOG_ASSERT(metadata != NULL);
-            g_hash_table_insert(metadata_hash, key, metadata);
-            key = NULL;
-        } else {
-            CRM_LOG_ASSERT(metadata == NULL);
-            metadata = NULL;
-        }
+static void
+metadata_retrieved(int rc, const char *metadata, void *user_data)
+{
+    char *key = user_data;
+    metadata_entry_t *entry = metadata_hash ? g_hash_table_lookup(metadata_hash, key) : NULL;
+
+    crm_trace("Retrieved metadata for %s: %s (%d)", key, pcmk_strerror(rc), rc);
+    if (entry == NULL) {
+        /* The cache was destroyed in the meantime */
+        free(key);
+        return;
     }
 
-    if (metadata == NULL) {
+    if (rc == pcmk_ok && metadata != NULL) {
+        free(entry->metadata);
+        entry->metadata = strdup(metadata);
+    } else {
         crm_warn("No metadata found for %s: %s (%d)", key, pcmk_strerror(rc), rc);
+        entry->failed = TRUE;
     }
+    entry->pending = FALSE;
 
+    metadata_flush_parked(entry, key, "was available");
     free(key);
-    return metadata;
+}
+
+/*!
+ * \internal
+ * \brief Record any updates parked while waiting for agent metadata
+ *
+ * \note Parked updates are recorded with metadata retrieved synchronously
+ */
+void
+lrm_metadata_flush_parked(void)
+{
+    GHashTableIter iter;
+    char *key = NULL;
+    metadata_entry_t *entry = NULL;
+
+    if (metadata_hash == NULL) {
+        return;
+    }
+
+    g_hash_table_iter_init(&iter, metadata_hash);
+    while (g_hash_table_iter_next(&iter, (gpointer *) & key, (gpointer *) & entry)) {
+        metadata_flush_parked(entry, key, "was still being retrieved");
+    }
+}
+
+/*!
+ * \internal
+ * \brief Free the metadata cache
+ *
+ * \note Any updates still parked are discarded, so they should have been
+ *       flushed with lrm_metadata_flush_parked() while the CIB was available
+ */
+void
+lrm_metadata_cleanup(void)
+{
+    if (metadata_hash == NULL) {
+        return;
+    }
+
+    crm_trace("Destroying reload cache with %d members", g_hash_table_size(metadata_hash));
+    g_hash_table_destroy(metadata_hash);
+    metadata_hash = NULL;
+}
+
+/*!
+ * \internal
+ * \brief Check whether an operation result can be recorded yet
+ *
+ * \param[in] node_name  Node the operation ran on
+ * \param[in] rsc        Resource the operation is for
+ * \param[in] op         Operation result
+ * \param[in] needed     Whether the result needs the agent's metadata
+ *
+ * \return TRUE if the result can be recorded now, otherwise FALSE (in which
+ *         case it has been parked, and will be recorded once the agent's
+ *         metadata has been retrieved)
+ * \note Results that don't need metadata (such as stops) are never parked,
+ *       but any results parked before them are recorded first.
+ */
+static gboolean
+metadata_ready(const char *node_name, lrmd_rsc_info_t * rsc, lrmd_event_data_t * op,
+               gboolean needed)
+{
+    int rc = pcmk_ok;
+    char *key = metadata_key(rsc);
+    metadata_entry_t *entry = metadata_entry(key, needed);
+    parked_update_t *update = NULL;
+
+    if (entry && needed == FALSE) {
+        metadata_flush_parked(entry, key, "is needed for an earlier result");
+    }
+
+    /* Agents may be upgraded while their resources are stopped, so check for
+     * new metadata (which is cheap if the agent is unchanged) before a start
+     */
+    if (entry == NULL || needed == FALSE
+        || (entry->pending == FALSE && entry->metadata && safe_str_neq(op->op_type, RSC_START))) {
+        free(key);
+        return TRUE;
+    }
+
+    /* Later results for the same agent are parked too, to keep them in order */
+    update = calloc(1, sizeof(parked_update_t));
+    update->node_name = strdup(node_name);
+    update->rsc = lrmd_copy_rsc_info(rsc);
+    update->op = lrmd_copy_event(op);
+    entry->parked = g_list_append(entry->parked, update);
+
+    if (entry->pending) {
+        crm_trace("Parked %s_%s_%d update until metadata for %s is available",
+                  op->rsc_id, op->op_type, op->interval, key);
+        free(key);
+        return FALSE;
+    }
+
+    crm_trace("Retrieving metadata for %s before recording %s_%s_%d",
+              key, op->rsc_id, op->op_type, op->interval);
+    entry->pending = TRUE;
+    entry->failed = FALSE;
+
+    /* The callback takes ownership of key, and may be invoked right away */
+    rc = lrmd_get_metadata_async(rsc->class, rsc->provider ? rsc->provider : "heartbeat",
+                                 rsc->type, metadata_retrieved, key);
+    if (rc != pcmk_ok) {
+        metadata_retrieved(rc, NULL, key);
+    }
+    return FALSE;
 }
 
 static char *
@@ -744,7 +936,7 @@ build_operation_update(xmlNode * parent, lrmd_rsc_info_t * rsc, lrmd_event_data_
         return TRUE;
     }
 
-    m_string = get_rsc_metadata(rsc->type, rsc->class, rsc->provider, safe_str_eq(op->op_type, RSC_START));
+    m_string = get_rsc_metadata(rsc);
     if(m_string == NULL) {
         crm_err("No metadata for %s::%s:%s", rsc->provider, rsc->class, rsc->type);
         return TRUE;
@@ -961,6 +1153,9 @@ delete_rsc_status(lrm_state_t * lrm_state, const char *rsc_id, int call_options,
 
     CRM_CHECK(rsc_id != NULL, return -ENXIO);
 
+    /* Don't let a pending update re-create what we're about to delete */
+    lrm_status_flush(lrm_state->node_name);
+
     max = strlen(rsc_template) + strlen(rsc_id) + strlen(lrm_state->node_name) + 1;
     rsc_xpath = calloc(1, max);
     snprintf(rsc_xpath, max, rsc_template, lrm_state->node_name, rsc_id);
@@ -1019,6 +1214,8 @@ delete_op_entry(lrm_state_t * lrm_state, lrmd_event_data_t * op, const char *rsc
 {
     xmlNode *xml_top = NULL;
 
+    lrm_status_flush(lrm_state->node_name);
+
     if (op != NULL) {
         xml_top = create_xml_node(NULL, XML_LRM_TAG_RSC_OP);
         crm_xml_add_int(xml_top, XML_LRM_ATTR_CALLID, op->call_id);
@@ -1101,7 +1298,7 @@ lrm_clear_last_failure(const char *rsc_id, const char *node_name)
         g_hash_table_iter_init(&iter, lrm_state->resource_history);
         while (g_hash_table_iter_next(&iter, NULL, (void **)&entry)) {
             if (crm_str_eq(rsc_id, entry->id, TRUE)) {
-                lrmd_free_event(entry->failed);
+                history_free_event(entry->failed);
                 entry->failed = NULL;
             }
         }
@@ -2150,8 +2347,276 @@ remote_node_clear_status(const char *node_name, int call_opt)
     erase_status_tag(node_name, XML_TAG_TRANSIENT_NODEATTRS, call_opt);
 }
 
+/*
+ * Operation results are not written to the CIB one at a time.  Instead they
+ * are collected into a single status fragment per node and sent when the
+ * batch window (crmd-status-batch-delay) expires, or, with the default window
+ * of 0, once the mainloop has finished processing whatever lrmd events were
+ * ready.  Anything that needs the CIB to be current first (deletions,
+ * refreshes, disconnecting) flushes the pending batches.
+ */
+
+/* Upper bound on how many results are coalesced into a single update */
+#define STATUS_BATCH_MAX 100
+
+typedef struct status_batch_s {
+    char *node_name;
+    int call_opt;
+    int ops;
+
+    xmlNode *update;
+    xmlNode *resources;
+} status_batch_t;
+
+static GHashTable *status_batches = NULL;
+static crm_trigger_t *status_batch_trigger = NULL;
+static mainloop_timer_t *status_batch_timer = NULL;
+static guint status_batch_delay = 0;
+
+static int
+status_batch_send(status_batch_t * batch)
+{
+    int rc = pcmk_ok;
+
+    if (batch->update == NULL) {
+        return 0;
+    }
+
+    crm_log_xml_trace(batch->update, __FUNCTION__);
+
+    /* make it an asyncronous call and be done with it
+     *
+     * Best case:
+     *   the resource state will be discovered during
+     *   the next signup or election.
+     *
+     * Bad case:
+     *   we are shutting down and there is no DC at the time,
+     *   but then why were we shutting down then anyway?
+     *   (probably because of an internal error)
+     *
+     * Worst case:
+     *   we get shot for having resources "running" when the really weren't
+     *
+     * the alternative however means blocking here for too long, which
+     * isnt acceptable
+     */
+    fsa_cib_update(XML_CIB_TAG_STATUS, batch->update, batch->call_opt, rc, NULL);
+
+    if (rc > 0) {
+        last_resource_update = rc;
+    }
+
+    /* the return code is a call number, not an error code */
+    crm_debug("Sent resource state update %d for %d operation%s on %s",
+              rc, batch->ops, batch->ops == 1 ? "" : "s", batch->node_name);
+    fsa_register_cib_callback(rc, FALSE, NULL, cib_rsc_callback);
+
+    free_xml(batch->update);
+    batch->update = NULL;
+    batch->resources = NULL;
+    batch->ops = 0;
+    return rc;
+}
+
+static void
+status_batch_free(gpointer data)
+{
+    status_batch_t *batch = data;
+
+    free_xml(batch->update);
+    free(batch->node_name);
+    free(batch);
+}
+
+static gboolean
+status_batch_flush_cb(gpointer key, gpointer value, gpointer user_data)
+{
+    status_batch_send(value);
+    return TRUE;
+}
+
+/*!
+ * \internal
+ * \brief Send any resource updates still waiting in a batch
+ *
+ * \param[in] node_name  Only flush updates for this node (NULL for all nodes)
+ */
+void
+lrm_status_flush(const char *node_name)
+{
+    if (status_batches == NULL) {
+        return;
+
+    } else if (node_name == NULL) {
+        g_hash_table_foreach_remove(status_batches, status_batch_flush_cb, NULL);
+
+    } else {
+        status_batch_t *batch = g_hash_table_lookup(status_batches, node_name);
+
+        if (batch) {
+            status_batch_send(batch);
+            g_hash_table_remove(status_batches, node_name);
+        }
+    }
+
+    if (g_hash_table_size(status_batches) == 0 && status_batch_timer) {
+        mainloop_timer_stop(status_batch_timer);
+    }
+}
+
+static gboolean
+status_batch_dispatch(gpointer user_data)
+{
+    lrm_status_flush(NULL);
+    return FALSE;
+}
+
+/*!
+ * \internal
+ * \brief Set how long operation results may be held before being written out
+ *
+ * \param[in] delay_ms  Batch window in milliseconds (0 means until the
+ *                      mainloop is otherwise idle)
+ */
+void
+lrm_status_set_delay(guint delay_ms)
+{
+    if (delay_ms != status_batch_delay) {
+        crm_debug("Coalescing resource updates for %ums", delay_ms);
+    }
+    status_batch_delay = delay_ms;
+    if (status_batch_timer && delay_ms > 0) {
+        mainloop_timer_set_period(status_batch_timer, delay_ms);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Release the batching state
+ *
+ * \note Anything still pending is discarded, it will be rediscovered by the
+ *       next probe
+ */
+void
+lrm_status_cleanup(void)
+{
+    if (status_batches) {
+        if (g_hash_table_size(status_batches) > 0) {
+            crm_warn("Discarding resource updates for %d nodes",
+                     g_hash_table_size(status_batches));
+        }
+        g_hash_table_destroy(status_batches);
+        status_batches = NULL;
+    }
+    if (status_batch_timer) {
+        mainloop_timer_del(status_batch_timer);
+        status_batch_timer = NULL;
+    }
+    if (status_batch_trigger) {
+        mainloop_destroy_trigger(status_batch_trigger);
+        status_batch_trigger = NULL;
+    }
+}
+
+static void
+status_batch_schedule(void)
+{
+    if (status_batch_delay > 0) {
+        if (status_batch_timer == NULL) {
+            status_batch_timer = mainloop_timer_add("lrm-status-batch", status_batch_delay,
+                                                    FALSE, status_batch_dispatch, NULL);
+        }
+        if (mainloop_timer_running(status_batch_timer) == FALSE) {
+            mainloop_timer_start(status_batch_timer);
+        }
+
+    } else {
+        if (status_batch_trigger == NULL) {
+            /* Low priority so pending lrmd events get processed first */
+            status_batch_trigger = mainloop_add_trigger(G_PRIORITY_LOW, status_batch_dispatch,
+                                                        NULL);
+        }
+        mainloop_set_trigger(status_batch_trigger);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Find (or start) the batch an update for a resource should go into
+ *
+ * \note A resource with an update already waiting forces the batch out first,
+ *       so that updates for the same resource still reach the CIB in order
+ *       and in separate modifications.
+ */
+static status_batch_t *
+status_batch_get(const char *node_name, const char *uuid, const char *rsc_id, int call_opt)
+{
+    xmlNode *iter = NULL;
+    status_batch_t *batch = NULL;
+
+    if (status_batches == NULL) {
+        status_batches = g_hash_table_new_full(crm_str_hash, g_str_equal, NULL,
+                                               status_batch_free);
+    }
+
+    batch = g_hash_table_lookup(status_batches, node_name);
+    if (batch && batch->update) {
+        if (batch->call_opt != call_opt
+            || batch->ops >= STATUS_BATCH_MAX
+            || find_entity(batch->resources, XML_LRM_TAG_RESOURCE, rsc_id)) {
+            status_batch_send(batch);
+        }
+    }
+
+    if (batch == NULL) {
+        batch = calloc(1, sizeof(status_batch_t));
+        batch->node_name = strdup(node_name);
+        g_hash_table_insert(status_batches, batch->node_name, batch);
+    }
+
+    if (batch->update == NULL) {
+        batch->call_opt = call_opt;
+        batch->update = create_xml_node(NULL, XML_CIB_TAG_STATUS);
+        iter = create_xml_node(batch->update, XML_CIB_TAG_STATE);
+
+        if (safe_str_neq(uuid, fsa_our_uuid)) {
+            /* remote nodes uuid and uname are equal */
+            crm_xml_add(iter, XML_NODE_IS_REMOTE, "true");
+        }
+
+        crm_xml_add(iter, XML_ATTR_UUID,  uuid);
+        crm_xml_add(iter, XML_ATTR_UNAME, node_name);
+        /* Same origin as before updates were batched, for anyone matching on it */
+        crm_xml_add(iter, XML_ATTR_ORIGIN, "do_update_resource");
+
+        iter = create_xml_node(iter, XML_CIB_TAG_LRM);
+        crm_xml_add(iter, XML_ATTR_ID, uuid);
+
+        batch->resources = create_xml_node(iter, XML_LRM_TAG_RESOURCES);
+    }
+
+    return batch;
+}
+
 static int
 do_update_resource(const char *node_name, lrmd_rsc_info_t * rsc, lrmd_event_data_t * op)
+{
+    CRM_CHECK(op != NULL, return 0);
+
+    if (rsc != NULL) {
+        /* Stopped resources don't need the digest logic */
+        gboolean needed = (op->params != NULL && safe_str_neq(op->op_type, CRMD_ACTION_STOP));
+
+        if (metadata_ready(node_name, rsc, op, needed) == FALSE) {
+            return 0;
+        }
+    }
+    return do_update_resource_now(node_name, rsc, op);
+}
+
+static int
+do_update_resource_now(const char *node_name, lrmd_rsc_info_t * rsc, lrmd_event_data_t * op)
 {
 /*
   <status>
@@ -2161,10 +2626,12 @@ do_update_resource(const char *node_name, lrmd_rsc_info_t * rsc, lrmd_event_data
   <lrm_resource id=...>
   </...>
 */
-    int rc = pcmk_ok;
-    xmlNode *update, *iter = NULL;
+    int rc = 0;
+    xmlNode *iter = NULL;
     int call_opt = cib_quorum_override;
     const char *uuid = NULL;
+    const char *container = NULL;
+    status_batch_t *batch = NULL;
 
     CRM_CHECK(op != NULL, return 0);
 
@@ -2173,109 +2640,75 @@ do_update_resource(const char *node_name, lrmd_rsc_info_t * rsc, lrmd_event_data
         call_opt |= cib_scope_local;
     }
 
-    iter = create_xml_node(iter, XML_CIB_TAG_STATUS);
-    update = iter;
-    iter = create_xml_node(iter, XML_CIB_TAG_STATE);
-
     if (safe_str_eq(node_name, fsa_our_uname)) {
         uuid = fsa_our_uuid;
 
     } else {
         /* remote nodes uuid and uname are equal */
         uuid = node_name;
-        crm_xml_add(iter, XML_NODE_IS_REMOTE, "true");
     }
 
     CRM_LOG_ASSERT(uuid != NULL);
     if(uuid == NULL) {
-        rc = -EINVAL;
-        goto done;
+        return -EINVAL;
     }
 
-    crm_xml_add(iter, XML_ATTR_UUID,  uuid);
-    crm_xml_add(iter, XML_ATTR_UNAME, node_name);
-    crm_xml_add(iter, XML_ATTR_ORIGIN, __FUNCTION__);
+    if (rsc == NULL) {
+        crm_warn("Resource %s no longer exists in the lrmd", op->rsc_id);
+        send_direct_ack(NULL, NULL, rsc, op, op->rsc_id);
+        return 0;
+    }
 
-    iter = create_xml_node(iter, XML_CIB_TAG_LRM);
-    crm_xml_add(iter, XML_ATTR_ID, uuid);
+    batch = status_batch_get(node_name, uuid, op->rsc_id, call_opt);
 
-    iter = create_xml_node(iter, XML_LRM_TAG_RESOURCES);
-    iter = create_xml_node(iter, XML_LRM_TAG_RESOURCE);
+    iter = create_xml_node(batch->resources, XML_LRM_TAG_RESOURCE);
     crm_xml_add(iter, XML_ATTR_ID, op->rsc_id);
 
     build_operation_update(iter, rsc, op, __FUNCTION__);
 
-    if (rsc) {
-        const char *container = NULL;
+    crm_xml_add(iter, XML_ATTR_TYPE, rsc->type);
+    crm_xml_add(iter, XML_AGENT_ATTR_CLASS, rsc->class);
+    crm_xml_add(iter, XML_AGENT_ATTR_PROVIDER, rsc->provider);
 
-        crm_xml_add(iter, XML_ATTR_TYPE, rsc->type);
-        crm_xml_add(iter, XML_AGENT_ATTR_CLASS, rsc->class);
-        crm_xml_add(iter, XML_AGENT_ATTR_PROVIDER, rsc->provider);
+    if (op->params) {
+        container = g_hash_table_lookup(op->params, CRM_META"_"XML_RSC_ATTR_CONTAINER);
+    }
+    if (container) {
+        crm_trace("Resource %s is a part of container resource %s", op->rsc_id, container);
+        crm_xml_add(iter, XML_RSC_ATTR_CONTAINER, container);
+    }
 
-        if (op->params) {
-            container = g_hash_table_lookup(op->params, CRM_META"_"XML_RSC_ATTR_CONTAINER);
-        }
-        if (container) {
-            crm_trace("Resource %s is a part of container resource %s", op->rsc_id, container);
-            crm_xml_add(iter, XML_RSC_ATTR_CONTAINER, container);
-        }
+    CRM_CHECK(rsc->type != NULL, crm_err("Resource %s has no value for type", op->rsc_id));
+    CRM_CHECK(rsc->class != NULL, crm_err("Resource %s has no value for class", op->rsc_id));
 
-        CRM_CHECK(rsc->type != NULL, crm_err("Resource %s has no value for type", op->rsc_id));
-        CRM_CHECK(rsc->class != NULL, crm_err("Resource %s has no value for class", op->rsc_id));
-
-        /* check to see if we need to initialize remote-node related status sections */
-        if (safe_str_eq(op->op_type, "start") && op->rc == 0 && op->op_status == PCMK_LRM_OP_DONE) {
-            const char *remote_node = g_hash_table_lookup(op->params, CRM_META"_remote_node");
-
-            if (remote_node) {
-                /* A container for a remote-node has started, initalize remote-node's status */
-                crm_info("Initalizing lrm status for container remote-node %s. Container successfully started.", remote_node);
-                remote_node_clear_status(remote_node, call_opt);
-            } else if (container == FALSE && safe_str_eq(rsc->type, "remote") && safe_str_eq(rsc->provider, "pacemaker")) {
-                /* baremetal remote node connection resource has started, initalize remote-node's status */
-                crm_info("Initializing lrm status for baremetal remote-node %s", rsc->id);
-                remote_node_clear_status(rsc->id, call_opt);
-            }
-        }
+    batch->ops++;
 
-    } else {
-        crm_warn("Resource %s no longer exists in the lrmd", op->rsc_id);
-        send_direct_ack(NULL, NULL, rsc, op, op->rsc_id);
-        goto cleanup;
+    /* check to see if we need to initialize remote-node related status sections */
+    if (safe_str_eq(op->op_type, "start") && op->rc == 0 && op->op_status == PCMK_LRM_OP_DONE) {
+        const char *remote_node = g_hash_table_lookup(op->params, CRM_META"_remote_node");
+
+        if (remote_node) {
+            /* A container for a remote-node has started, initalize remote-node's status */
+            crm_info("Initalizing lrm status for container remote-node %s. Container successfully started.", remote_node);
+            lrm_status_flush(remote_node);
+            remote_node_clear_status(remote_node, call_opt);
+        } else if (container == FALSE && safe_str_eq(rsc->type, "remote") && safe_str_eq(rsc->provider, "pacemaker")) {
+            /* baremetal remote node connection resource has started, initalize remote-node's status */
+            crm_info("Initializing lrm status for baremetal remote-node %s", rsc->id);
+            lrm_status_flush(rsc->id);
+            remote_node_clear_status(rsc->id, call_opt);
+        }
     }
 
-    crm_log_xml_trace(update, __FUNCTION__);
+    if (batch->ops >= STATUS_BATCH_MAX) {
+        rc = status_batch_send(batch);
 
-    /* make it an asyncronous call and be done with it
-     *
-     * Best case:
-     *   the resource state will be discovered during
-     *   the next signup or election.
-     *
-     * Bad case:
-     *   we are shutting down and there is no DC at the time,
-     *   but then why were we shutting down then anyway?
-     *   (probably because of an internal error)
-     *
-     * Worst case:
-     *   we get shot for having resources "running" when the really weren't
-     *
-     * the alternative however means blocking here for too long, which
-     * isnt acceptable
-     */
-    fsa_cib_update(XML_CIB_TAG_STATUS, update, call_opt, rc, NULL);
-
-    if (rc > 0) {
-        last_resource_update = rc;
+    } else {
+        crm_trace("Queued resource state update for %s=%d on %s (%d pending for %s)",
+                  op->op_type, op->interval, op->rsc_id, batch->ops, node_name);
+        status_batch_schedule();
     }
-  done:
-    /* the return code is a call number, not an error code */
-    crm_trace("Sent resource state update message: %d for %s=%d on %s", rc,
-              op->op_type, op->interval, op->rsc_id);
-    fsa_register_cib_callback(rc, FALSE, NULL, cib_rsc_callback);
 
-  cleanup:
-    free_xml(update);
     return rc;
 }
 
@@ -0,0 +1,368 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <crm_internal.h>
+#include <crm/crm.h>
+#include <crm/msg_xml.h>
+
+#include <crmd.h>
+#include <crmd_fsa.h>
+#include <crmd_lrm.h>
+
+/*
+ * Resource history is kept for every resource on every node we manage,
+ * including remote nodes, and is what a node's status section is rebuilt
+ * from, so the records are kept as small as possible:
+ *
+ * - agent output is not kept
+ * - operation names and agent details are interned
+ * - parameter tables are interned and shared by every record with the same
+ *   contents (the same operation on each instance of a clone, each node's
+ *   probe of the same resource, a resource's last operation and its stop
+ *   parameters, ...)
+ *
+ * Interned tables are read-only and must be released with
+ * history_params_release() rather than destroyed.
+ */
+
+/* Rough per-entry cost of a GHashTable on top of its keys and values */
+#define HISTORY_HASH_ENTRY_SIZE (3 * sizeof(gpointer) + sizeof(guint))
+
+typedef struct history_params_s {
+    GHashTable *params;
+    int refs;
+    size_t bytes;
+} history_params_t;
+
+static GHashTable *history_strings = NULL;      /* string -> reference count */
+static GHashTable *history_params = NULL;       /* params -> history_params_t */
+
+static guint
+history_params_hash(gconstpointer key)
+{
+    GHashTableIter iter;
+    gpointer name = NULL;
+    gpointer value = NULL;
+    guint hash = g_hash_table_size((GHashTable *) key);
+
+    /* Combine the entries so that iteration order doesn't matter */
+    g_hash_table_iter_init(&iter, (GHashTable *) key);
+    while (g_hash_table_iter_next(&iter, &name, &value)) {
+        hash += crm_str_hash(name) * 33 + (value ? crm_str_hash(value) : 0);
+    }
+    return hash;
+}
+
+static gboolean
+history_params_equal(gconstpointer a, gconstpointer b)
+{
+    GHashTableIter iter;
+    gpointer name = NULL;
+    gpointer value = NULL;
+
+    if (a == b) {
+        return TRUE;
+
+    } else if (g_hash_table_size((GHashTable *) a) != g_hash_table_size((GHashTable *) b)) {
+        return FALSE;
+    }
+
+    g_hash_table_iter_init(&iter, (GHashTable *) a);
+    while (g_hash_table_iter_next(&iter, &name, &value)) {
+        gpointer other = NULL;
+
+        if (g_hash_table_lookup_extended((GHashTable *) b, name, NULL, &other) == FALSE
+            || safe_str_neq(value, other)) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static void
+history_params_free(gpointer data)
+{
+    history_params_t *shared = data;
+
+    g_hash_table_destroy(shared->params);
+    free(shared);
+}
+
+/*!
+ * \internal
+ * \brief Get a shared, read-only copy of a parameter table
+ *
+ * \param[in] params  Parameters to copy (may be NULL)
+ *
+ * \return Interned table with the same contents as \p params
+ */
+GHashTable *
+history_params_intern(GHashTable * params)
+{
+    history_params_t *shared = NULL;
+
+    if (params == NULL) {
+        return NULL;
+    }
+
+    if (history_params == NULL) {
+        history_params = g_hash_table_new_full(history_params_hash, history_params_equal,
+                                               NULL, history_params_free);
+    }
+
+    shared = g_hash_table_lookup(history_params, params);
+    if (shared == NULL) {
+        GHashTableIter iter;
+        gpointer name = NULL;
+        gpointer value = NULL;
+
+        shared = calloc(1, sizeof(history_params_t));
+        shared->params = g_hash_table_new_full(crm_str_hash, g_str_equal,
+                                               g_hash_destroy_str, g_hash_destroy_str);
+        shared->bytes = sizeof(history_params_t);
+
+        g_hash_table_iter_init(&iter, params);
+        while (g_hash_table_iter_next(&iter, &name, &value)) {
+            g_hash_table_insert(shared->params, strdup(name), value ? strdup(value) : NULL);
+            shared->bytes += HISTORY_HASH_ENTRY_SIZE + strlen(name) + 1;
+            if (value) {
+                shared->bytes += strlen(value) + 1;
+            }
+        }
+        g_hash_table_insert(history_params, shared->params, shared);
+    }
+
+    shared->refs++;
+    return shared->params;
+}
+
+void
+history_params_release(GHashTable * params)
+{
+    history_params_t *shared = NULL;
+
+    if (params == NULL || history_params == NULL) {
+        return;
+    }
+
+    shared = g_hash_table_lookup(history_params, params);
+    CRM_CHECK(shared != NULL && shared->params == params, return);
+
+    if (--shared->refs == 0) {
+        g_hash_table_remove(history_params, params);
+    }
+}
+
+const char *
+history_str_intern(const char *str)
+{
+    gpointer key = NULL;
+    gpointer refs = NULL;
+
+    if (str == NULL) {
+        return NULL;
+    }
+
+    if (history_strings == NULL) {
+        history_strings = g_hash_table_new_full(crm_str_hash, g_str_equal, free, NULL);
+    }
+
+    if (g_hash_table_lookup_extended(history_strings, str, &key, &refs) == FALSE) {
+        key = strdup(str);
+    } else {
+        g_hash_table_steal(history_strings, key);
+    }
+    g_hash_table_insert(history_strings, key, GINT_TO_POINTER(GPOINTER_TO_INT(refs) + 1));
+    return key;
+}
+
+void
+history_str_release(const char *str)
+{
+    gpointer key = NULL;
+    gpointer refs = NULL;
+
+    if (str == NULL || history_strings == NULL
+        || g_hash_table_lookup_extended(history_strings, str, &key, &refs) == FALSE) {
+        return;
+    }
+
+    if (GPOINTER_TO_INT(refs) <= 1) {
+        g_hash_table_remove(history_strings, key);
+    } else {
+        g_hash_table_steal(history_strings, key);
+        g_hash_table_insert(history_strings, key, GINT_TO_POINTER(GPOINTER_TO_INT(refs) - 1));
+    }
+}
+
+/*!
+ * \internal
+ * \brief Create a compact copy of an operation result for a resource's history
+ *
+ * \param[in] history  Resource history the copy will belong to
+ * \param[in] op       Operation result to copy
+ *
+ * \return Copy of \p op, to be freed with history_free_event()
+ * \note The copy's resource id is that of \p history, which must outlive it
+ */
+lrmd_event_data_t *
+history_copy_event(rsc_history_t * history, lrmd_event_data_t * op)
+{
+    lrmd_event_data_t *copy = calloc(1, sizeof(lrmd_event_data_t));
+
+    /* Get all the int values, then replace the strings */
+    memcpy(copy, op, sizeof(lrmd_event_data_t));
+
+    copy->rsc_id = history->id;
+    copy->op_type = history_str_intern(op->op_type);
+    copy->user_data = op->user_data ? strdup(op->user_data) : NULL;
+    copy->exit_reason = op->exit_reason ? strdup(op->exit_reason) : NULL;
+    copy->params = history_params_intern(op->params);
+    copy->output = NULL;
+    copy->remote_nodename = NULL;
+    return copy;
+}
+
+void
+history_free_event(lrmd_event_data_t * op)
+{
+    if (op == NULL) {
+        return;
+    }
+
+    history_str_release(op->op_type);
+    history_params_release(op->params);
+    free((char *)op->user_data);
+    free((char *)op->exit_reason);
+    free(op);
+}
+
+static size_t
+history_event_size(lrmd_event_data_t * op)
+{
+    size_t bytes = 0;
+
+    if (op != NULL) {
+        bytes += sizeof(lrmd_event_data_t);
+        bytes += op->user_data ? strlen(op->user_data) + 1 : 0;
+        bytes += op->exit_reason ? strlen(op->exit_reason) + 1 : 0;
+    }
+    return bytes;
+}
+
+static void
+history_report_node(lrm_state_t * lrm_state, xmlNode * parent)
+{
+    int resources = 0;
+    int operations = 0;
+    size_t bytes = 0;
+    GHashTableIter iter;
+    rsc_history_t *entry = NULL;
+    xmlNode *node = NULL;
+
+    if (lrm_state->resource_history == NULL) {
+        return;
+    }
+
+    g_hash_table_iter_init(&iter, lrm_state->resource_history);
+    while (g_hash_table_iter_next(&iter, NULL, (void **)&entry)) {
+        GList *gIter = NULL;
+
+        resources++;
+        bytes += sizeof(rsc_history_t) + HISTORY_HASH_ENTRY_SIZE + strlen(entry->id) + 1;
+
+        operations += (entry->last != NULL) + (entry->failed != NULL);
+        bytes += history_event_size(entry->last) + history_event_size(entry->failed);
+
+        for (gIter = entry->recurring_op_list; gIter != NULL; gIter = gIter->next) {
+            operations++;
+            bytes += sizeof(GList) + history_event_size(gIter->data);
+        }
+    }
+
+    node = create_xml_node(parent, "lrm_history");
+    crm_xml_add(node, XML_ATTR_UNAME, lrm_state->node_name);
+    crm_xml_add_int(node, "resources", resources);
+    crm_xml_add_int(node, "operations", operations);
+    crm_xml_add_int(node, "bytes", bytes);
+}
+
+/*!
+ * \internal
+ * \brief Add the memory used by resource history to an XML element
+ *
+ * \param[in,out] parent  Element to add an lrm_history child to for each node,
+ *                        and an lrm_history_shared child for interned data
+ * \note Sizes are estimates that exclude allocator overhead
+ */
+void
+history_report(xmlNode * parent)
+{
+    int refs = 0;
+    size_t bytes = 0;
+    GList *gIter = NULL;
+    GList *states = lrm_state_get_list();
+    xmlNode *shared = NULL;
+
+    for (gIter = states; gIter != NULL; gIter = gIter->next) {
+        history_report_node(gIter->data, parent);
+    }
+    g_list_free(states);
+
+    shared = create_xml_node(parent, "lrm_history_shared");
+
+    if (history_params) {
+        GHashTableIter iter;
+        history_params_t *params = NULL;
+
+        g_hash_table_iter_init(&iter, history_params);
+        while (g_hash_table_iter_next(&iter, NULL, (void **)&params)) {
+            refs += params->refs;
+            bytes += params->bytes + HISTORY_HASH_ENTRY_SIZE;
+        }
+    }
+    crm_xml_add_int(shared, "param_sets", history_params ? g_hash_table_size(history_params) : 0);
+    crm_xml_add_int(shared, "param_refs", refs);
+    crm_xml_add_int(shared, "param_bytes", bytes);
+
+    bytes = 0;
+    if (history_strings) {
+        GHashTableIter iter;
+        const char *str = NULL;
+
+        g_hash_table_iter_init(&iter, history_strings);
+        while (g_hash_table_iter_next(&iter, (void **)&str, NULL)) {
+            bytes += HISTORY_HASH_ENTRY_SIZE + strlen(str) + 1;
+        }
+    }
+    crm_xml_add_int(shared, "strings", history_strings ? g_hash_table_size(history_strings) : 0);
+    crm_xml_add_int(shared, "string_bytes", bytes);
+}
+
+void
+history_cleanup(void)
+{
+    if (history_params) {
+        g_hash_table_destroy(history_params);
+        history_params = NULL;
+    }
+    if (history_strings) {
+        g_hash_table_destroy(history_strings);
+        history_strings = NULL;
+    }
+}
@@ -800,6 +800,13 @@ handle_request(xmlNode * stored_msg, enum crmd_fsa_cause cause)
         crm_xml_add(ping, XML_PING_ATTR_STATUS, "ok");
         crm_xml_add(ping, XML_PING_ATTR_SYSFROM, sys_to);
         crm_xml_add(ping, "crmd_state", fsa_state2string(fsa_state));
+        if (AM_I_DC) {
+            /* The job limits currently applied to each node */
+            throttle_report(ping);
+        }
+
+        /* Memory used by the operation history of each node we manage */
+        history_report(ping);
 
         /* Ok, so technically not so interesting, but CTS needs to see this */
         crm_notice("Current ping state: %s", fsa_state2string(fsa_state));
@@ -855,13 +862,16 @@ handle_response(xmlNode * stored_msg)
         if (msg_ref == NULL) {
             crm_err("%s - Ignoring calculation with no reference", op);
 
-        } else if (safe_str_eq(msg_ref, fsa_pe_ref)) {
+        } else if (safe_str_eq(msg_ref, fsa_pe_ref) && pe_invoke_complete(stored_msg)) {
             ha_msg_input_t fsa_input;
 
             fsa_input.msg = stored_msg;
             register_fsa_input_later(C_IPC_MESSAGE, I_PE_SUCCESS, &fsa_input);
             crm_trace("Completed: %s...", fsa_pe_ref);
 
+        } else if (safe_str_eq(msg_ref, fsa_pe_ref)) {
+            crm_trace("Resending: %s...", fsa_pe_ref);
+
         } else {
             crm_info("%s calculation %s is obsolete", op, msg_ref);
         }
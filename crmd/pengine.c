@@ -49,6 +49,7 @@
 
 struct crm_subsystem_s *pe_subsystem = NULL;
 void do_pe_invoke_callback(xmlNode * msg, int call_id, int rc, xmlNode * output, void *user_data);
+static void force_local_option(xmlNode *xml, const char *attr_name, const char *attr_value);
 
 static void
 save_cib_contents(xmlNode * msg, int call_id, int rc, xmlNode * output, void *user_data)
@@ -110,6 +111,7 @@ pe_ipc_destroy(gpointer user_data)
     }
 
     clear_bit(fsa_input_register, pe_subsystem->flag_connected);
+    pe_invoke_cleanup();
     pe_subsystem->pid = -1;
     pe_subsystem->source = NULL;
     pe_subsystem->client = NULL;
@@ -155,6 +157,7 @@ do_pe_control(long long action,
         pe_subsystem->source = NULL;
 
         clear_bit(fsa_input_register, pe_subsystem->flag_connected);
+        pe_invoke_cleanup();
     }
 
     if ((action & start_actions) && (is_set(fsa_input_register, R_PE_CONNECTED) == FALSE)) {
@@ -186,6 +189,280 @@ do_pe_control(long long action,
 int fsa_pe_query = 0;
 char *fsa_pe_ref = NULL;
 
+/*
+ * Invocations closer together than pe_debounce_ms are coalesced: the first
+ * runs straight away, anything requested during the following window results
+ * in a single calculation once it expires.
+ *
+ * With pe_incremental set, the PE keeps the CIB from the last full
+ * calculation and is subsequently sent only the patchsets we have been
+ * notified of since, saving both the CIB query and shipping the whole CIB for
+ * every calculation.  Anything that makes the PE's copy suspect (config
+ * changes, missed or legacy-format diffs, pending updates of our own, or the
+ * PE failing to apply a patch) falls back to a full query.
+ */
+
+/* Beyond this many patchsets, a full query is cheaper */
+#define PE_DIFFS_MAX 100
+
+static guint pe_debounce_ms = 0;
+static mainloop_timer_t *pe_debounce_timer = NULL;
+static long long pe_last_invoke = 0;
+
+static gboolean pe_incremental = FALSE;
+static gboolean pe_recording = FALSE;   /* collecting patchsets since the last query */
+static gboolean pe_synced = FALSE;      /* the PE holds the result of that query */
+static GListPtr pe_diffs = NULL;
+static xmlNode *pe_cib = NULL;          /* our copy of what the PE holds */
+
+static void
+pe_cib_reset(const char *reason)
+{
+    if (pe_synced && reason) {
+        crm_debug("Sending the PE a full copy of the CIB next time: %s", reason);
+    }
+    g_list_free_full(pe_diffs, (GDestroyNotify) free_xml);
+    pe_diffs = NULL;
+    free_xml(pe_cib);
+    pe_cib = NULL;
+    pe_recording = FALSE;
+    pe_synced = FALSE;
+}
+
+/*!
+ * \internal
+ * \brief Record a CIB change for the PE's copy of the CIB
+ *
+ * \param[in] patchset  Patchset from a diff notification (NULL if one was lost)
+ */
+void
+pe_cib_updated(xmlNode * patchset)
+{
+    int format = 1;
+    xmlNode *change = NULL;
+
+    if (pe_recording == FALSE) {
+        return;
+
+    } else if (patchset == NULL) {
+        pe_cib_reset("missed an update");
+        return;
+    }
+
+    crm_element_value_int(patchset, "format", &format);
+    if (format != 2) {
+        pe_cib_reset("legacy patch format");
+        return;
+    }
+
+    for (change = __xml_first_child(patchset); change != NULL; change = __xml_next(change)) {
+        const char *xpath = crm_element_value(change, XML_DIFF_PATH);
+
+        /* The configuration also affects what we add to the PE's input */
+        if (xpath && (strstr(xpath, "/" XML_CIB_TAG_CONFIGURATION)
+                      || safe_str_eq(xpath, "/" XML_TAG_CIB))) {
+            pe_cib_reset("configuration change");
+            return;
+        }
+    }
+
+    if (g_list_length(pe_diffs) >= PE_DIFFS_MAX) {
+        pe_cib_reset("too many changes");
+        return;
+    }
+    pe_diffs = g_list_append(pe_diffs, copy_xml(patchset));
+}
+
+static gboolean
+pe_debounce_popped(gpointer data)
+{
+    crm_trace("Debounce window expired");
+    register_fsa_action(A_PE_INVOKE);
+    return FALSE;
+}
+
+void
+pe_invoke_set_options(guint debounce_ms, gboolean incremental)
+{
+    pe_debounce_ms = debounce_ms;
+    if (pe_debounce_timer && debounce_ms > 0) {
+        mainloop_timer_set_period(pe_debounce_timer, debounce_ms);
+    }
+
+    if (incremental != pe_incremental) {
+        crm_info("%s incremental PE input", incremental ? "Enabling" : "Disabling");
+        pe_incremental = incremental;
+        pe_cib_reset(NULL);
+    }
+}
+
+void
+pe_invoke_cleanup(void)
+{
+    pe_cib_reset(NULL);
+    if (pe_debounce_timer) {
+        mainloop_timer_del(pe_debounce_timer);
+        pe_debounce_timer = NULL;
+    }
+}
+
+/*!
+ * \internal
+ * \brief Check whether a PE invocation should wait for the debounce window
+ */
+static gboolean
+pe_invoke_debounced(void)
+{
+    long long now = crm_monotonic_usec();
+    long long remaining = 0;
+
+    if (pe_debounce_ms == 0) {
+        pe_last_invoke = now;
+        return FALSE;
+    }
+
+    if (pe_debounce_timer && mainloop_timer_running(pe_debounce_timer)) {
+        crm_debug("Coalescing PE invocation with the one already scheduled");
+        return TRUE;
+    }
+
+    remaining = pe_debounce_ms - (now - pe_last_invoke) / 1000;
+    if (pe_last_invoke == 0 || remaining <= 0) {
+        pe_last_invoke = now;
+        return FALSE;
+    }
+
+    if (pe_debounce_timer == NULL) {
+        pe_debounce_timer = mainloop_timer_add("pe-debounce", pe_debounce_ms, FALSE,
+                                               pe_debounce_popped, NULL);
+    }
+    crm_debug("Delaying PE invocation for %lldms", remaining);
+    mainloop_timer_set_period(pe_debounce_timer, remaining);
+    mainloop_timer_start(pe_debounce_timer);
+    return TRUE;
+}
+
+/*!
+ * \internal
+ * \brief Update local state and the PE's input from the CIB it will use
+ *
+ * \param[in,out] cib  Full CIB to be sent to (or held by) the PE
+ */
+static void
+pe_invoke_prepare(xmlNode * cib)
+{
+    const char *watchdog = daemon_option("watchdog");
+
+    /* refresh our remote-node cache when the pengine is invoked */
+    crm_remote_peer_cache_refresh(cib);
+
+    if (watchdog) {
+        force_local_option(cib, XML_ATTR_HAVE_WATCHDOG, watchdog);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Apply the recorded patchsets to our copy of the PE's CIB
+ *
+ * \return TRUE if all of them applied, FALSE otherwise
+ */
+static gboolean
+pe_cib_apply_diffs(void)
+{
+    GListPtr gIter = NULL;
+
+    for (gIter = pe_diffs; gIter != NULL; gIter = gIter->next) {
+        /* As in the PE, our copy has extra attributes so the digest won't match */
+        xmlNode *copy = copy_xml(gIter->data);
+        int rc = pcmk_ok;
+
+        xml_remove_prop(copy, XML_ATTR_DIGEST);
+        rc = xml_apply_patchset(pe_cib, copy, TRUE);
+        free_xml(copy);
+
+        if (rc != pcmk_ok && rc != -pcmk_err_old_data) {
+            crm_info("Could not apply CIB update: %s (%d)", pcmk_strerror(rc), rc);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static gboolean
+pe_invoke_incremental(void)
+{
+    int sent = 0;
+    int count = g_list_length(pe_diffs);
+    xmlNode *cmd = NULL;
+    xmlNode *diffs = NULL;
+    GListPtr gIter = NULL;
+
+    if (pe_cib == NULL || pe_cib_apply_diffs() == FALSE) {
+        pe_cib_reset("could not follow the CIB updates");
+        return FALSE;
+    }
+    pe_invoke_prepare(pe_cib);
+
+    diffs = create_xml_node(NULL, XML_TAG_PE_DIFFS);
+    for (gIter = pe_diffs; gIter != NULL; gIter = gIter->next) {
+        add_node_nocopy(diffs, NULL, gIter->data);
+    }
+    g_list_free(pe_diffs);
+    pe_diffs = NULL;
+
+    /* The same details do_pe_invoke_callback() adds to the full CIB */
+    crm_xml_add(diffs, XML_ATTR_DC_UUID, fsa_our_uuid);
+    crm_xml_add_int(diffs, XML_ATTR_HAVE_QUORUM, fsa_has_quorum);
+    if (ever_had_quorum && crm_have_quorum == FALSE) {
+        crm_xml_add_int(diffs, XML_ATTR_QUORUM_PANIC, 1);
+    }
+
+    cmd = create_request(CRM_OP_PECALC, diffs, NULL, CRM_SYSTEM_PENGINE, CRM_SYSTEM_DC, NULL);
+    crm_xml_add(cmd, F_CRM_PE_SYNC, "diff");
+
+    /* Any query still in flight is no longer needed */
+    fsa_pe_query = 0;
+    free(fsa_pe_ref);
+    fsa_pe_ref = crm_element_value_copy(cmd, XML_ATTR_REFERENCE);
+
+    sent = crm_ipc_send(mainloop_get_ipc_client(pe_subsystem->source), cmd, 0, 0, NULL);
+    if (sent <= 0) {
+        crm_err("Could not contact the pengine: %d", sent);
+        register_fsa_error_adv(C_FSA_INTERNAL, I_ERROR, NULL, NULL, __FUNCTION__);
+    }
+
+    crm_debug("Invoking the PE with %d CIB update%s: ref=%s, seq=%llu, quorate=%d",
+              count, count == 1 ? "" : "s", fsa_pe_ref, crm_peer_seq, fsa_has_quorum);
+    free_xml(cmd);
+    free_xml(diffs);
+    return TRUE;
+}
+
+/*!
+ * \internal
+ * \brief Handle the PE's reply to our latest invocation
+ *
+ * \return TRUE if the reply contains a usable transition graph
+ */
+gboolean
+pe_invoke_complete(xmlNode * reply)
+{
+    if (safe_str_eq(crm_element_value(reply, F_CRM_PE_SYNC), "resync")) {
+        crm_info("The PE could not apply our CIB updates, sending the full CIB instead");
+        pe_cib_reset(NULL);
+        pe_last_invoke = 0;     /* Don't debounce the retry */
+        register_fsa_action(A_PE_INVOKE);
+        return FALSE;
+    }
+
+    if (pe_last_invoke > 0) {
+        crm_info("PE calculation %s took %lldms", fsa_pe_ref,
+                 (crm_monotonic_usec() - pe_last_invoke) / 1000);
+    }
+    return TRUE;
+}
+
 /*	 A_PE_INVOKE	*/
 void
 do_pe_invoke(long long action,
@@ -223,6 +500,19 @@ do_pe_invoke(long long action,
         return;
     }
 
+    if (pe_invoke_debounced()) {
+        /* Make sure any queued calculations are discarded */
+        fsa_pe_query = 0;
+        free(fsa_pe_ref);
+        fsa_pe_ref = NULL;
+        return;
+    }
+
+    if (pe_incremental && pe_synced && num_cib_op_callbacks() == 0
+        && pe_invoke_incremental()) {
+        return;
+    }
+
     fsa_pe_query = fsa_cib_conn->cmds->query(fsa_cib_conn, NULL, NULL, cib_scope_local);
 
     crm_debug("Query %d: Requesting the current CIB: %s", fsa_pe_query,
@@ -232,6 +522,12 @@ do_pe_invoke(long long action,
     free(fsa_pe_ref);
     fsa_pe_ref = NULL;
 
+    if (pe_incremental) {
+        /* Changes made after this query will be sent as patchsets next time */
+        pe_cib_reset(NULL);
+        pe_recording = TRUE;
+    }
+
     fsa_register_cib_callback(fsa_pe_query, FALSE, NULL, do_pe_invoke_callback);
 }
 
@@ -299,7 +595,6 @@ do_pe_invoke_callback(xmlNode * msg, int call_id, int rc, xmlNode * output, void
 {
     int sent;
     xmlNode *cmd = NULL;
-    const char *watchdog = NULL;
 
     if (rc != pcmk_ok) {
         crm_err("Cant retrieve the CIB: %s (call %d)", pcmk_strerror(rc), call_id);
@@ -333,22 +628,23 @@ do_pe_invoke_callback(xmlNode * msg, int call_id, int rc, xmlNode * output, void
 
     CRM_LOG_ASSERT(output != NULL);
 
-    /* refresh our remote-node cache when the pengine is invoked */
-    crm_remote_peer_cache_refresh(output);
+    pe_invoke_prepare(output);
 
     crm_xml_add(output, XML_ATTR_DC_UUID, fsa_our_uuid);
     crm_xml_add_int(output, XML_ATTR_HAVE_QUORUM, fsa_has_quorum);
 
-    watchdog = daemon_option("watchdog");
-    if (watchdog) {
-        force_local_option(output, XML_ATTR_HAVE_WATCHDOG, watchdog);
-    }
-
     if (ever_had_quorum && crm_have_quorum == FALSE) {
         crm_xml_add_int(output, XML_ATTR_QUORUM_PANIC, 1);
     }
 
     cmd = create_request(CRM_OP_PECALC, output, NULL, CRM_SYSTEM_PENGINE, CRM_SYSTEM_DC, NULL);
+    if (pe_recording) {
+        /* Ask the PE to keep a copy we can send it updates for */
+        crm_xml_add(cmd, F_CRM_PE_SYNC, "full");
+        free_xml(pe_cib);
+        pe_cib = copy_xml(output);
+        pe_synced = TRUE;
+    }
 
     free(fsa_pe_ref);
     fsa_pe_ref = crm_element_value_copy(cmd, XML_ATTR_REFERENCE);
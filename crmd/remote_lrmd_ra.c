@@ -25,6 +25,7 @@
 #include <crmd_messages.h>
 #include <crmd_callbacks.h>
 #include <crmd_lrm.h>
+#include <tengine.h>
 #include <crm/lrmd.h>
 #include <crm/services.h>
 
@@ -33,6 +34,9 @@
 /* The max start timeout before cmd retry */
 #define MAX_START_TIMEOUT_MS 10000
 
+/* Default for crmd-remote-connect-limit */
+#define REMOTE_CONNECT_LIMIT_DEFAULT 10
+
 typedef struct remote_ra_cmd_s {
     /*! the local node the cmd is issued from */
     char *owner;
@@ -80,11 +84,43 @@ typedef struct remote_ra_data_s {
     enum remote_migration_status migrate_status;
 
     gboolean active;
+
+    /* Connection manager state */
+    long long connect_queued;   /* when cur_cmd started waiting for a slot */
+    long long connect_started;  /* when the current attempt began, 0 if none */
 } remote_ra_data_t;
 
+/*
+ * Remote connections are established through a connection manager, so that
+ * a DC move or a cluster restart doesn't have us opening hundreds of
+ * sessions at once.  Starts wait in connect_queue until one of connect_limit
+ * slots is free; the TLS handshakes of those in progress overlap.  When a
+ * slot frees up, the node with the most outstanding actions in the current
+ * transition goes next, so that the connections recovery depends on come up
+ * first.  Outside the DC there is no graph to consult and starts are served
+ * in order.
+ */
+static GList *connect_queue = NULL;     /* lrm_state_t waiting for a slot */
+static int connect_active = 0;
+static int connect_limit = REMOTE_CONNECT_LIMIT_DEFAULT;
+static crm_trigger_t *connect_trigger = NULL;
+
+/* Setup latency since the connection manager was last idle */
+static struct remote_connect_stats_s {
+    int completed;
+    int failed;
+    long long begin;
+    long long wait_ms;
+    long long wait_max_ms;
+    long long setup_ms;
+    long long setup_max_ms;
+} connect_stats;
+
 static int handle_remote_ra_start(lrm_state_t * lrm_state, remote_ra_cmd_t * cmd, int timeout_ms);
 static void handle_remote_ra_stop(lrm_state_t * lrm_state, remote_ra_cmd_t * cmd);
 static GList *fail_all_monitor_cmds(GList * list);
+static void remote_connect_queue(lrm_state_t * lrm_state);
+static void remote_connect_done(lrm_state_t * lrm_state, gboolean success);
 
 static void
 free_cmd(gpointer user_data)
@@ -237,7 +273,9 @@ retry_start_cmd_cb(gpointer data)
     update_remaining_timeout(cmd);
 
     if (cmd->remaining_timeout > 0) {
-        rc = handle_remote_ra_start(lrm_state, cmd, cmd->remaining_timeout);
+        /* Wait for a free slot like any other connection */
+        remote_connect_queue(lrm_state);
+        rc = 0;
     }
 
     if (rc != 0) {
@@ -387,6 +425,8 @@ remote_lrm_op_callback(lrmd_event_data_t * op)
     if (op->type == lrmd_event_connect && (safe_str_eq(cmd->action, "start") ||
                                            safe_str_eq(cmd->action, "migrate_from"))) {
 
+        remote_connect_done(lrm_state, op->connection_rc >= 0);
+
         if (op->connection_rc < 0) {
             update_remaining_timeout(cmd);
             /* There isn't much of a reason to reschedule if the timeout is too small */
@@ -527,6 +567,179 @@ handle_remote_ra_start(lrm_state_t * lrm_state, remote_ra_cmd_t * cmd, int timeo
     return lrm_state_remote_connect_async(lrm_state, server, port, timeout_used);
 }
 
+/*!
+ * \internal
+ * \brief Count the actions in the current transition still waiting on a node
+ */
+static int
+remote_connect_priority(lrm_state_t * lrm_state)
+{
+    int pending = 0;
+    GListPtr gIter = NULL;
+
+    if (AM_I_DC == FALSE || transition_graph == NULL || transition_graph->actions_by_node == NULL) {
+        return 0;
+    }
+
+    gIter = g_hash_table_lookup(transition_graph->actions_by_node, lrm_state->node_name);
+    for (; gIter != NULL; gIter = gIter->next) {
+        crm_action_t *action = gIter->data;
+
+        if (action->confirmed == FALSE) {
+            pending++;
+        }
+    }
+    return pending;
+}
+
+static void
+remote_connect_fail(lrm_state_t * lrm_state)
+{
+    remote_ra_data_t *ra_data = lrm_state->remote_ra_data;
+    remote_ra_cmd_t *cmd = ra_data->cur_cmd;
+
+    crm_debug("connect failed, not expecting to match any connection event later");
+    cmd->rc = PCMK_OCF_UNKNOWN_ERROR;
+    cmd->op_status = PCMK_LRM_OP_ERROR;
+    report_remote_ra_result(cmd);
+
+    ra_data->cur_cmd = NULL;
+    free_cmd(cmd);
+    if (ra_data->cmds) {
+        mainloop_set_trigger(ra_data->work);
+    }
+}
+
+static gboolean
+remote_connect_dispatch(gpointer user_data)
+{
+    while (connect_queue && (connect_limit <= 0 || connect_active < connect_limit)) {
+        GListPtr gIter = NULL;
+        lrm_state_t *lrm_state = NULL;
+        remote_ra_data_t *ra_data = NULL;
+        remote_ra_cmd_t *cmd = NULL;
+        int best = -1;
+        long long now = crm_monotonic_usec();
+
+        for (gIter = connect_queue; gIter != NULL; gIter = gIter->next) {
+            int priority = remote_connect_priority(gIter->data);
+
+            if (priority > best) {
+                best = priority;
+                lrm_state = gIter->data;
+            }
+        }
+
+        connect_queue = g_list_remove(connect_queue, lrm_state);
+        ra_data = lrm_state->remote_ra_data;
+        cmd = ra_data->cur_cmd;
+        if (cmd == NULL) {
+            continue;
+        }
+
+        update_remaining_timeout(cmd);
+        if (cmd->remaining_timeout <= 0) {
+            crm_warn("Timed out waiting to connect to remote node %s", lrm_state->node_name);
+            remote_connect_fail(lrm_state);
+            continue;
+        }
+
+        ra_data->connect_started = now;
+        connect_active++;
+        crm_trace("Connecting to %s (%d pending actions) after %lldms in queue, %d in progress",
+                  lrm_state->node_name, best, (now - ra_data->connect_queued) / 1000,
+                  connect_active);
+
+        if (handle_remote_ra_start(lrm_state, cmd, cmd->remaining_timeout) != 0) {
+            remote_connect_done(lrm_state, FALSE);
+            remote_connect_fail(lrm_state);
+        } else {
+            crm_debug("began remote lrmd connect, waiting for connect event.");
+        }
+    }
+    return TRUE;
+}
+
+static void
+remote_connect_queue(lrm_state_t * lrm_state)
+{
+    remote_ra_data_t *ra_data = lrm_state->remote_ra_data;
+
+    if (connect_trigger == NULL) {
+        connect_trigger = mainloop_add_trigger(G_PRIORITY_HIGH, remote_connect_dispatch, NULL);
+    }
+    if (connect_stats.begin == 0) {
+        connect_stats.begin = crm_monotonic_usec();
+    }
+
+    ra_data->connect_queued = crm_monotonic_usec();
+    connect_queue = g_list_append(connect_queue, lrm_state);
+    mainloop_set_trigger(connect_trigger);
+}
+
+/*!
+ * \internal
+ * \brief Release a node's connection slot and record how long it took
+ */
+static void
+remote_connect_done(lrm_state_t * lrm_state, gboolean success)
+{
+    remote_ra_data_t *ra_data = lrm_state->remote_ra_data;
+    long long now = crm_monotonic_usec();
+    long long wait_ms = 0;
+    long long setup_ms = 0;
+
+    if (ra_data->connect_started == 0) {
+        return;
+    }
+
+    wait_ms = (ra_data->connect_started - ra_data->connect_queued) / 1000;
+    setup_ms = (now - ra_data->connect_started) / 1000;
+    ra_data->connect_started = 0;
+    connect_active--;
+
+    crm_info("%s remote node %s: %lldms in queue, %lldms to connect",
+             success ? "Connected to" : "Could not connect to", lrm_state->node_name,
+             wait_ms, setup_ms);
+
+    if (success) {
+        connect_stats.completed++;
+    } else {
+        connect_stats.failed++;
+    }
+    connect_stats.wait_ms += wait_ms;
+    connect_stats.setup_ms += setup_ms;
+    connect_stats.wait_max_ms = QB_MAX(connect_stats.wait_max_ms, wait_ms);
+    connect_stats.setup_max_ms = QB_MAX(connect_stats.setup_max_ms, setup_ms);
+
+    if (connect_queue) {
+        mainloop_set_trigger(connect_trigger);
+
+    } else if (connect_active == 0) {
+        int total = connect_stats.completed + connect_stats.failed;
+
+        crm_notice("Remote connections: %d established and %d failed in %lldms"
+                   " (queued avg=%lldms max=%lldms, setup avg=%lldms max=%lldms)",
+                   connect_stats.completed, connect_stats.failed,
+                   (now - connect_stats.begin) / 1000,
+                   connect_stats.wait_ms / total, connect_stats.wait_max_ms,
+                   connect_stats.setup_ms / total, connect_stats.setup_max_ms);
+        memset(&connect_stats, 0, sizeof(connect_stats));
+    }
+}
+
+void
+remote_ra_set_connect_limit(int limit)
+{
+    if (limit != connect_limit) {
+        crm_debug("Establishing at most %d remote connections at once", limit);
+    }
+    connect_limit = limit;
+    if (connect_queue && connect_trigger) {
+        mainloop_set_trigger(connect_trigger);
+    }
+}
+
 static gboolean
 handle_remote_ra_exec(gpointer user_data)
 {
@@ -553,19 +766,11 @@ handle_remote_ra_exec(gpointer user_data)
         g_list_free_1(first);
 
         if (!strcmp(cmd->action, "start") || !strcmp(cmd->action, "migrate_from")) {
+            /* take care of this later when we get a slot and the async connection result */
             ra_data->migrate_status = 0;
-            rc = handle_remote_ra_start(lrm_state, cmd, cmd->timeout);
-            if (rc == 0) {
-                /* take care of this later when we get async connection result */
-                crm_debug("began remote lrmd connect, waiting for connect event.");
-                ra_data->cur_cmd = cmd;
-                return TRUE;
-            } else {
-                crm_debug("connect failed, not expecting to match any connection event later");
-                cmd->rc = PCMK_OCF_UNKNOWN_ERROR;
-                cmd->op_status = PCMK_LRM_OP_ERROR;
-            }
-            report_remote_ra_result(cmd);
+            ra_data->cur_cmd = cmd;
+            remote_connect_queue(lrm_state);
+            return TRUE;
 
         } else if (!strcmp(cmd->action, "monitor")) {
 
@@ -653,6 +858,12 @@ remote_ra_cleanup(lrm_state_t * lrm_state)
     if (ra_data->recurring_cmds) {
         g_list_free_full(ra_data->recurring_cmds, free_cmd);
     }
+
+    connect_queue = g_list_remove(connect_queue, lrm_state);
+    if (ra_data->connect_started) {
+        remote_connect_done(lrm_state, FALSE);
+    }
+
     mainloop_destroy_trigger(ra_data->work);
     free(ra_data);
     lrm_state->remote_ra_data = NULL;
@@ -473,6 +473,7 @@ te_rsc_command(crm_graph_t * graph, crm_action_t * action)
                     action->id, task, task_uuid, on_node, action->timeout, graph->network_delay);
             action->timeout = graph->network_delay;
         }
+        action->sent_usec = crm_monotonic_usec();
         te_update_job_count(action, 1);
         te_start_action_timer(graph, action);
     }
@@ -546,6 +547,7 @@ te_update_job_count_on(const char *target, int offset, bool migrate)
 static void
 te_update_job_count(crm_action_t * action, int offset)
 {
+    long long elapsed_ms = -1;
     const char *task = crm_element_value(action->xml, XML_LRM_ATTR_TASK);
     const char *target = crm_element_value(action->xml, XML_LRM_ATTR_TARGET);
 
@@ -554,6 +556,11 @@ te_update_job_count(crm_action_t * action, int offset)
         return;
     }
 
+    if (offset < 0 && action->sent_usec > 0) {
+        /* Let the throttling logic know how long the node took */
+        elapsed_ms = (crm_monotonic_usec() - action->sent_usec) / 1000;
+    }
+
     /* if we have a router node, this means the action is performing
      * on a remote node. For now, we count all action occuring on a
      * remote node against the job list on the cluster node hosting
@@ -568,12 +575,19 @@ te_update_job_count(crm_action_t * action, int offset)
 
         te_update_job_count_on(t1, offset, TRUE);
         te_update_job_count_on(t2, offset, TRUE);
+        if (elapsed_ms >= 0) {
+            throttle_record_completion(t1, elapsed_ms, action->timeout);
+            throttle_record_completion(t2, elapsed_ms, action->timeout);
+        }
         return;
     } else if (target == NULL) {
         target = crm_element_value(action->xml, XML_LRM_ATTR_TARGET);
     }
 
     te_update_job_count_on(target, offset, FALSE);
+    if (elapsed_ms >= 0) {
+        throttle_record_completion(target, elapsed_ms, action->timeout);
+    }
 }
 
 static gboolean
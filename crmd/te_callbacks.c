@@ -37,9 +37,6 @@ gboolean shuttingdown = FALSE;
 crm_graph_t *transition_graph;
 crm_trigger_t *transition_trigger = NULL;
 
-/* #define rsc_op_template "//"XML_TAG_DIFF_ADDED"//"XML_TAG_CIB"//"XML_CIB_TAG_STATE"[@uname='%s']"//"XML_LRM_TAG_RSC_OP"[@id='%s]" */
-#define rsc_op_template "//"XML_TAG_DIFF_ADDED"//"XML_TAG_CIB"//"XML_LRM_TAG_RSC_OP"[@id='%s']"
-
 static const char *
 get_node_id(xmlNode * rsc_op)
 {
@@ -58,6 +55,7 @@ te_legacy_update_diff(const char *event, xmlNode * diff)
 {
     int lpc, max;
     xmlXPathObject *xpathObj = NULL;
+    GHashTable *added_ops = NULL;
 
     CRM_CHECK(diff != NULL, return);
 
@@ -180,16 +178,24 @@ te_legacy_update_diff(const char *event, xmlNode * diff)
             process_graph_event(rsc_op, node);
         }
     }
+
+    /* Remember which ops were (re-)added so removals can be checked against it */
+    added_ops = g_hash_table_new(crm_str_hash, g_str_equal);
+    max = numXpathResults(xpathObj);
+    for (lpc = 0; lpc < max; lpc++) {
+        xmlNode *rsc_op = getXpathResult(xpathObj, lpc);
+
+        if (rsc_op && ID(rsc_op)) {
+            g_hash_table_insert(added_ops, (gpointer) ID(rsc_op), rsc_op);
+        }
+    }
     freeXpathObject(xpathObj);
 
     /* Detect deleted (as opposed to replaced or added) actions - eg. crm_resource -C */
     xpathObj = xpath_search(diff, "//" XML_TAG_DIFF_REMOVED "//" XML_LRM_TAG_RSC_OP);
     max = numXpathResults(xpathObj);
     for (lpc = 0; lpc < max; lpc++) {
-        int path_max = 0;
         const char *op_id = NULL;
-        char *rsc_op_xpath = NULL;
-        xmlXPathObject *op_match = NULL;
         xmlNode *match = getXpathResult(xpathObj, lpc);
 
         CRM_LOG_ASSERT(match != NULL);
@@ -197,22 +203,14 @@ te_legacy_update_diff(const char *event, xmlNode * diff)
 
         op_id = ID(match);
 
-        path_max = strlen(rsc_op_template) + strlen(op_id) + 1;
-        rsc_op_xpath = calloc(1, path_max);
-        snprintf(rsc_op_xpath, path_max, rsc_op_template, op_id);
-
-        op_match = xpath_search(diff, rsc_op_xpath);
-        if (numXpathResults(op_match) == 0) {
+        if (op_id == NULL || g_hash_table_lookup(added_ops, op_id) == NULL) {
             /* Prevent false positives by matching cancelations too */
             const char *node = get_node_id(match);
             crm_action_t *cancelled = get_cancel_action(op_id, node);
 
             if (cancelled == NULL) {
-                crm_debug("No match for deleted action %s (%s on %s)", rsc_op_xpath, op_id,
-                          node);
+                crm_debug("No match for deleted action %s on %s", op_id, node);
                 abort_transition(INFINITY, tg_restart, "Resource op removal", match);
-                freeXpathObject(op_match);
-                free(rsc_op_xpath);
                 goto bail;
 
             } else {
@@ -220,13 +218,13 @@ te_legacy_update_diff(const char *event, xmlNode * diff)
                           op_id, node, cancelled->id);
             }
         }
-
-        freeXpathObject(op_match);
-        free(rsc_op_xpath);
     }
 
   bail:
     freeXpathObject(xpathObj);
+    if (added_ops) {
+        g_hash_table_destroy(added_ops);
+    }
 }
 
 static void process_resource_updates(
@@ -276,43 +274,100 @@ static void process_resource_updates(
     }
 }
 
-#define NODE_PATT "/lrm[@id="
-static char *get_node_from_xpath(const char *xpath) 
+/* Deepest element path we need to understand in a patchset */
+#define TE_PATH_MAX 8
+
+/* An XML_DIFF_PATH split into its element names and ids */
+struct te_path_s {
+    int depth;
+    char *buffer;
+    const char *name[TE_PATH_MAX + 1];
+    const char *id[TE_PATH_MAX + 1];
+};
+
+typedef gboolean (*te_diff_handler_t) (const char *op, struct te_path_s *path, gboolean exact,
+                                       xmlNode *change, xmlNode *match);
+
+struct te_diff_node_s {
+    te_diff_handler_t handler;
+    GHashTable *children;
+};
+
+static struct te_diff_node_s *te_diff_root = NULL;
+
+/*!
+ * \internal
+ * \brief Split a patchset path into element names and ids
+ *
+ * \return TRUE if the path could be parsed (paths deeper than anything the
+ *         dispatcher knows about are truncated, which is harmless)
+ */
+static gboolean
+te_path_parse(const char *xpath, struct te_path_s *path)
 {
-    char *nodeid = NULL;
-    char *tmp = strstr(xpath, NODE_PATT);
+    char *p = NULL;
+
+    memset(path, 0, sizeof(struct te_path_s));
+    if (xpath == NULL || xpath[0] != '/') {
+        return FALSE;
+    }
 
-    if(tmp) {
-        tmp += strlen(NODE_PATT);
-        tmp += 1;
+    path->buffer = strdup(xpath);
+    p = path->buffer;
+
+    while (p != NULL) {
+        char *name = p + 1;
+        const char *id = NULL;
+
+        p = name + strcspn(name, "/[");
+        if (*p == '[') {
+            *p++ = 0;
+            if (strncmp(p, "@id='", 5) == 0) {
+                id = p + 5;
+                p = strchr(id, '\'');
+                if (p == NULL) {
+                    return FALSE;
+                }
+                *p++ = 0;
+            }
+            p = strchr(p, ']');
+            if (p == NULL) {
+                return FALSE;
+            }
+            *p++ = 0;
+        }
+
+        if (*p == '/') {
+            *p = 0;
+        } else if (*p == 0) {
+            p = NULL;
+        } else {
+            return FALSE;
+        }
 
-        nodeid = strdup(tmp);
-        tmp = strstr(nodeid, "\'");
-        CRM_ASSERT(tmp);
-        tmp[0] = 0;
+        if (name[0] != 0 && path->depth < TE_PATH_MAX) {
+            path->id[path->depth] = id;
+            path->name[path->depth++] = name;
+        }
     }
-    return nodeid;
+    return TRUE;
 }
 
-static char *extract_node_uuid(const char *xpath) 
+static const char *
+te_path_id(struct te_path_s *path, const char *name)
 {
-    char *mutable_path = strdup(xpath);
-    char *node_uuid = NULL;
-    char *search = NULL;
-    char *match = NULL;
-
-    match = strstr(mutable_path, "node_state[@id=\'") + strlen("node_state[@id=\'");
-    search = strchr(match, '\'');
-    search[0] = 0;
-
-    node_uuid = strdup(match);
-    free(mutable_path);
-    return node_uuid;
+    int lpc = 0;
+
+    for (lpc = 0; lpc < path->depth; lpc++) {
+        if (safe_str_eq(path->name[lpc], name)) {
+            return path->id[lpc];
+        }
+    }
+    return NULL;
 }
 
-static void abort_unless_down(const char *xpath, const char *op, xmlNode *change, const char *reason) 
+static void abort_unless_down(const char *node_uuid, const char *op, xmlNode *change, const char *reason) 
 {
-    char *node_uuid = NULL;
     crm_action_t *down = NULL;
 
     if(safe_str_neq(op, "delete")) {
@@ -320,21 +375,378 @@ static void abort_unless_down(const char *xpath, const char *op, xmlNode *change
         return;
     }
 
-    node_uuid = extract_node_uuid(xpath);
     if(node_uuid == NULL) {
-        crm_err("Could not extract node ID from %s", xpath);
+        crm_err("Could not extract node ID for %s", reason);
         abort_transition(INFINITY, tg_restart, reason, change);
         return;
     }
 
     down = match_down_event(0, node_uuid, NULL, FALSE);
     if(down == NULL || down->executed == false) {
-        crm_trace("Not expecting %s to be down (%s)", node_uuid, xpath);
+        crm_trace("Not expecting %s to be down (%s)", node_uuid, reason);
         abort_transition(INFINITY, tg_restart, reason, change);
     } else {
-        crm_trace("Expecting changes to %s (%s)", node_uuid, xpath);
+        crm_trace("Expecting changes to %s (%s)", node_uuid, reason);
+    }
+}
+
+static gboolean
+te_diff_config(const char *op, struct te_path_s *path, gboolean exact, xmlNode *change, xmlNode *match)
+{
+    abort_transition(INFINITY, tg_restart, "Non-status change", change);
+    return FALSE; /* Wont be packaged with any resource operations we may be waiting for */
+}
+
+static gboolean
+te_diff_tickets(const char *op, struct te_path_s *path, gboolean exact, xmlNode *change, xmlNode *match)
+{
+    abort_transition(INFINITY, tg_restart, "Ticket attribute change", change);
+    return FALSE; /* Wont be packaged with any resource operations we may be waiting for */
+}
+
+static gboolean
+te_diff_transient(const char *op, struct te_path_s *path, gboolean exact, xmlNode *change, xmlNode *match)
+{
+    abort_unless_down(te_path_id(path, XML_CIB_TAG_STATE), op, change, "Transient attribute change");
+    return FALSE; /* Wont be packaged with any resource operations we may be waiting for */
+}
+
+static gboolean
+te_diff_rsc_op(const char *op, struct te_path_s *path, gboolean exact, xmlNode *change, xmlNode *match)
+{
+    const char *node_uuid = te_path_id(path, XML_CIB_TAG_STATE);
+
+    if (safe_str_eq(op, "delete")) {
+        const char *key = te_path_id(path, XML_LRM_TAG_RSC_OP);
+        crm_action_t *cancel = get_cancel_action(key, node_uuid);
+
+        if (cancel == NULL) {
+            abort_transition(INFINITY, tg_restart, "Resource operation removal", change);
+
+        } else {
+            crm_info("Cancellation of %s on %s confirmed (%d)", key, node_uuid, cancel->id);
+            stop_te_timer(cancel->timer);
+            te_action_confirmed(cancel);
+
+            update_graph(transition_graph, cancel);
+            trigger_graph();
+        }
+
+    } else if (match) {
+        process_graph_event(match, node_uuid);
     }
-    free(node_uuid);
+    return TRUE;
+}
+
+static gboolean
+te_diff_lrm(const char *op, struct te_path_s *path, gboolean exact, xmlNode *change, xmlNode *match)
+{
+    const char *node_uuid = te_path_id(path, XML_CIB_TAG_STATE);
+
+    if (safe_str_eq(op, "delete")) {
+        abort_unless_down(node_uuid, op, change, "Resource state removal");
+
+    } else if (exact == FALSE || match == NULL) {
+        crm_debug("Ignoring %s operation for %s", op, crm_element_value(change, XML_DIFF_PATH));
+
+    } else if (strcmp((const char *)match->name, XML_LRM_TAG_RESOURCE) == 0) {
+        xmlNode *rsc_op = NULL;
+
+        for (rsc_op = __xml_first_child(match); rsc_op != NULL; rsc_op = __xml_next(rsc_op)) {
+            process_graph_event(rsc_op, node_uuid);
+        }
+
+    } else {
+        process_resource_updates(node_uuid, match, change, op, NULL);
+    }
+    return TRUE;
+}
+
+static gboolean
+te_diff_node_state(const char *op, struct te_path_s *path, gboolean exact, xmlNode *change, xmlNode *match)
+{
+    if (safe_str_eq(op, "delete")) {
+        abort_unless_down(te_path_id(path, XML_CIB_TAG_STATE), op, change, "Node state removal");
+
+    } else if (exact && match) {
+        process_resource_updates(ID(match), first_named_child(match, XML_CIB_TAG_LRM), change, op, NULL);
+
+    } else {
+        crm_debug("Ignoring %s operation for %s", op, crm_element_value(change, XML_DIFF_PATH));
+    }
+    return TRUE;
+}
+
+static gboolean
+te_diff_status(const char *op, struct te_path_s *path, gboolean exact, xmlNode *change, xmlNode *match)
+{
+    xmlNode *state = NULL;
+
+    if (exact == FALSE || match == NULL) {
+        crm_debug("Ignoring %s operation for %s", op, crm_element_value(change, XML_DIFF_PATH));
+        return TRUE;
+    }
+
+    for (state = __xml_first_child(match); state != NULL; state = __xml_next(state)) {
+        process_resource_updates(ID(state), first_named_child(state, XML_CIB_TAG_LRM), change, op, NULL);
+    }
+    return TRUE;
+}
+
+static gboolean
+te_diff_cib(const char *op, struct te_path_s *path, gboolean exact, xmlNode *change, xmlNode *match)
+{
+    if (exact && match) {
+        te_diff_status(op, path, exact, change, first_named_child(match, XML_CIB_TAG_STATUS));
+
+        if (first_named_child(match, XML_CIB_TAG_CONFIGURATION)) {
+            abort_transition(INFINITY, tg_restart, "Non-status change", change);
+        }
+    }
+    return TRUE;
+}
+
+static void
+te_diff_node_free(gpointer data)
+{
+    struct te_diff_node_s *node = data;
+
+    if (node->children) {
+        g_hash_table_destroy(node->children);
+    }
+    free(node);
+}
+
+static void
+te_diff_register(const char **names, te_diff_handler_t handler)
+{
+    struct te_diff_node_s *node = NULL;
+
+    if (te_diff_root == NULL) {
+        te_diff_root = calloc(1, sizeof(struct te_diff_node_s));
+    }
+
+    for (node = te_diff_root; *names != NULL; names++) {
+        struct te_diff_node_s *child = NULL;
+
+        if (node->children == NULL) {
+            node->children = g_hash_table_new_full(crm_str_hash, g_str_equal, NULL,
+                                                   te_diff_node_free);
+        }
+
+        child = g_hash_table_lookup(node->children, *names);
+        if (child == NULL) {
+            child = calloc(1, sizeof(struct te_diff_node_s));
+            g_hash_table_insert(node->children, (gpointer) *names, child);
+        }
+        node = child;
+    }
+    node->handler = handler;
+}
+
+/*!
+ * \internal
+ * \brief Build the table that routes patchset changes to their handlers
+ *
+ * Each change is routed to the handler registered for the deepest matching
+ * prefix of its path, so only the element names along the path need to be
+ * compared rather than searching the whole path for every interesting tag.
+ */
+static void
+te_diff_init(void)
+{
+    const char *cib[] = { XML_TAG_CIB, NULL };
+    const char *config[] = { XML_TAG_CIB, XML_CIB_TAG_CONFIGURATION, NULL };
+    const char *status[] = { XML_TAG_CIB, XML_CIB_TAG_STATUS, NULL };
+    const char *tickets[] = { XML_TAG_CIB, XML_CIB_TAG_STATUS, XML_CIB_TAG_TICKETS, NULL };
+    const char *state[] = { XML_TAG_CIB, XML_CIB_TAG_STATUS, XML_CIB_TAG_STATE, NULL };
+    const char *attrs[] = {
+        XML_TAG_CIB, XML_CIB_TAG_STATUS, XML_CIB_TAG_STATE, XML_TAG_TRANSIENT_NODEATTRS, NULL
+    };
+    const char *lrm[] = {
+        XML_TAG_CIB, XML_CIB_TAG_STATUS, XML_CIB_TAG_STATE, XML_CIB_TAG_LRM, NULL
+    };
+    const char *resources[] = {
+        XML_TAG_CIB, XML_CIB_TAG_STATUS, XML_CIB_TAG_STATE, XML_CIB_TAG_LRM,
+        XML_LRM_TAG_RESOURCES, NULL
+    };
+    const char *resource[] = {
+        XML_TAG_CIB, XML_CIB_TAG_STATUS, XML_CIB_TAG_STATE, XML_CIB_TAG_LRM,
+        XML_LRM_TAG_RESOURCES, XML_LRM_TAG_RESOURCE, NULL
+    };
+    const char *rsc_op[] = {
+        XML_TAG_CIB, XML_CIB_TAG_STATUS, XML_CIB_TAG_STATE, XML_CIB_TAG_LRM,
+        XML_LRM_TAG_RESOURCES, XML_LRM_TAG_RESOURCE, XML_LRM_TAG_RSC_OP, NULL
+    };
+
+    te_diff_register(cib, te_diff_cib);
+    te_diff_register(config, te_diff_config);
+    te_diff_register(status, te_diff_status);
+    te_diff_register(tickets, te_diff_tickets);
+    te_diff_register(state, te_diff_node_state);
+    te_diff_register(attrs, te_diff_transient);
+    te_diff_register(lrm, te_diff_lrm);
+    te_diff_register(resources, te_diff_lrm);
+    te_diff_register(resource, te_diff_lrm);
+    te_diff_register(rsc_op, te_diff_rsc_op);
+}
+
+void
+te_diff_fini(void)
+{
+    if (te_diff_root) {
+        te_diff_node_free(te_diff_root);
+        te_diff_root = NULL;
+    }
+}
+
+/*!
+ * \internal
+ * \brief Route a single patchset change to the handler for its path
+ *
+ * \return FALSE if the remaining changes need not be looked at
+ */
+static gboolean
+te_diff_dispatch(xmlNode *change)
+{
+    int lpc = 0;
+    int matched = 0;
+    gboolean rc = TRUE;
+    xmlNode *match = NULL;
+    struct te_path_s path;
+    struct te_diff_node_s *node = te_diff_root;
+    te_diff_handler_t handler = NULL;
+    const char *op = crm_element_value(change, XML_DIFF_OP);
+    const char *xpath = crm_element_value(change, XML_DIFF_PATH);
+
+    if(op == NULL || strcmp(op, "move") == 0) {
+        return TRUE;
+
+    } else if(strcmp(op, "create") == 0) {
+        match = change->children;
+
+    } else if(strcmp(op, "modify") == 0) {
+        match = first_named_child(change, XML_DIFF_RESULT);
+        if(match) {
+            match = match->children;
+        }
+    }
+
+    crm_trace("Handling %s operation for %s %p, %s", op, xpath, match, match? (const char *)match->name : "");
+    if(xpath == NULL) {
+        /* Version field, ignore */
+        return TRUE;
+
+    } else if(te_path_parse(xpath, &path) == FALSE) {
+        crm_err("Ignoring %s operation for unparsable path %s", op, xpath);
+        free(path.buffer);
+        return TRUE;
+    }
+
+    if(match && strcmp(op, "create") == 0 && path.depth < TE_PATH_MAX) {
+        /* The path is for the parent, route on the new element itself */
+        path.id[path.depth] = ID(match);
+        path.name[path.depth++] = (const char *)match->name;
+    }
+
+    for (lpc = 0; lpc < path.depth && node->children; lpc++) {
+        node = g_hash_table_lookup(node->children, path.name[lpc]);
+        if (node == NULL) {
+            break;
+        } else if (node->handler) {
+            handler = node->handler;
+            matched = lpc + 1;
+        }
+    }
+
+    if(handler) {
+        rc = handler(op, &path, matched == path.depth, change, match);
+
+    } else if(match == NULL) {
+        crm_debug("No result for %s operation to %s", op, xpath);
+        CRM_ASSERT(strcmp(op, "delete") == 0 || strcmp(op, "move") == 0);
+
+    } else {
+        crm_err("Ignoring %s operation for %s %p, %s", op, xpath, match, match->name);
+    }
+
+    free(path.buffer);
+    return rc;
+}
+
+/*!
+ * \internal
+ * \brief Confirm actions whose results were in diff notifications we missed
+ *
+ * Only results for the current transition's unconfirmed actions are
+ * processed, so older history doesn't affect fail counts a second time.
+ */
+static void
+te_resync_callback(xmlNode * msg, int call_id, int rc, xmlNode * output, void *user_data)
+{
+    xmlNode *state = NULL;
+    xmlNode *rsc = NULL;
+    xmlNode *rsc_op = NULL;
+    xmlNode *status = output;
+
+    if (rc != pcmk_ok) {
+        crm_err("Could not re-read the status section: %s", pcmk_strerror(rc));
+
+    } else if (transition_graph != NULL && transition_graph->complete == FALSE) {
+        if (status && safe_str_neq(crm_element_name(status), XML_CIB_TAG_STATUS)) {
+            status = first_named_child(status, XML_CIB_TAG_STATUS);
+        }
+
+        for (state = __xml_first_child(status); state != NULL; state = __xml_next(state)) {
+            xmlNode *lrm = first_named_child(state, XML_CIB_TAG_LRM);
+            xmlNode *resources = first_named_child(lrm, XML_LRM_TAG_RESOURCES);
+
+            for (rsc = __xml_first_child(resources); rsc != NULL; rsc = __xml_next(rsc)) {
+                for (rsc_op = __xml_first_child(rsc); rsc_op != NULL; rsc_op = __xml_next(rsc_op)) {
+                    int action_num = -1;
+                    int target_rc = -1;
+                    int transition_num = -1;
+                    int status_code = PCMK_LRM_OP_PENDING;
+                    char *uuid = NULL;
+                    crm_action_t *action = NULL;
+                    const char *key = crm_element_value(rsc_op, XML_ATTR_TRANSITION_KEY);
+
+                    crm_element_value_int(rsc_op, XML_LRM_ATTR_OPSTATUS, &status_code);
+                    if (key == NULL || status_code == PCMK_LRM_OP_PENDING
+                        || decode_transition_key(key, &uuid, &transition_num, &action_num,
+                                                 &target_rc) == FALSE) {
+                        continue;
+                    }
+
+                    if (safe_str_eq(uuid, te_uuid) && transition_num == transition_graph->id) {
+                        action = get_action(action_num, FALSE);
+                    }
+                    free(uuid);
+
+                    if (action && action->confirmed == FALSE) {
+                        crm_info("Found missed result for action %d (%s)", action_num, ID(rsc_op));
+                        process_graph_event(rsc_op, ID(state));
+                    }
+                }
+            }
+        }
+    }
+
+    abort_transition(INFINITY, tg_restart, "CIB notifications lost", NULL);
+}
+
+/*!
+ * \internal
+ * \brief Recover after the CIB dropped diff notifications meant for us
+ */
+static void
+te_update_resync(void)
+{
+    int call_id = 0;
+
+    crm_notice("Some CIB updates were not delivered, re-reading the status section");
+    call_id = fsa_cib_conn->cmds->query(fsa_cib_conn, XML_CIB_TAG_STATUS, NULL, cib_scope_local);
+    fsa_register_cib_callback(call_id, FALSE, NULL, te_resync_callback);
 }
 
 void
@@ -357,6 +769,10 @@ te_update_diff(const char *event, xmlNode * msg)
         crm_trace("No graph");
         return;
 
+    } else if (rc == -pcmk_err_diff_resync) {
+        te_update_resync();
+        return;
+
     } else if (rc < pcmk_ok) {
         crm_trace("Filter rc=%d (%s)", rc, pcmk_strerror(rc));
         return;
@@ -391,148 +807,13 @@ te_update_diff(const char *event, xmlNode * msg)
             return;
     }
 
-    for (change = __xml_first_child(diff); change != NULL; change = __xml_next(change)) {
-        const char *name = NULL;
-        const char *op = crm_element_value(change, XML_DIFF_OP);
-        const char *xpath = crm_element_value(change, XML_DIFF_PATH);
-        xmlNode *match = NULL;
-        const char *node = NULL;
-
-        if(op == NULL) {
-            continue;
-
-        } else if(strcmp(op, "create") == 0) {
-            match = change->children;
-
-        } else if(strcmp(op, "move") == 0) {
-            continue;
-
-        } else if(strcmp(op, "modify") == 0) {
-            match = first_named_child(change, XML_DIFF_RESULT);
-            if(match) {
-                match = match->children;
-            }
-        }
-
-        if(match) {
-            name = (const char *)match->name;
-        }
-
-        crm_trace("Handling %s operation for %s %p, %s", op, xpath, match, name);
-        if(xpath == NULL) {
-            /* Version field, ignore */
-
-        } else if(strstr(xpath, "/cib/configuration")) {
-            abort_transition(INFINITY, tg_restart, "Non-status change", change);
-            break; /* Wont be packaged with any resource operations we may be waiting for */
-
-        } else if(strstr(xpath, "/"XML_CIB_TAG_TICKETS) || safe_str_eq(name, XML_CIB_TAG_TICKETS)) {
-            abort_transition(INFINITY, tg_restart, "Ticket attribute change", change);
-            break; /* Wont be packaged with any resource operations we may be waiting for */
-
-        } else if(strstr(xpath, "/"XML_TAG_TRANSIENT_NODEATTRS"[") || safe_str_eq(name, XML_TAG_TRANSIENT_NODEATTRS)) {
-            abort_unless_down(xpath, op, change, "Transient attribute change");
-            break; /* Wont be packaged with any resource operations we may be waiting for */
-
-        } else if(strstr(xpath, "/"XML_LRM_TAG_RSC_OP"[") && safe_str_eq(op, "delete")) {
-            crm_action_t *cancel = NULL;
-            char *mutable_key = strdup(xpath);
-            char *search = NULL;
-
-            const char *key = NULL;
-            char *node_uuid = extract_node_uuid(xpath);
-
-            search = strrchr(mutable_key, '\'');
-            search[0] = 0;
-
-            key = strrchr(mutable_key, '\'') + 1;
-
-            cancel = get_cancel_action(key, node_uuid);
-            if (cancel == NULL) {
-                abort_transition(INFINITY, tg_restart, "Resource operation removal", change);
-
-            } else {
-                crm_info("Cancellation of %s on %s confirmed (%d)", key, node_uuid, cancel->id);
-                stop_te_timer(cancel->timer);
-                te_action_confirmed(cancel);
-
-                update_graph(transition_graph, cancel);
-                trigger_graph();
-
-            }
-            free(mutable_key);
-            free(node_uuid);
-
-        } else if(strstr(xpath, "/"XML_CIB_TAG_LRM"[") && safe_str_eq(op, "delete")) {
-            abort_unless_down(xpath, op, change, "Resource state removal");
-
-        } else if(strstr(xpath, "/"XML_CIB_TAG_STATE"[") && safe_str_eq(op, "delete")) {
-            abort_unless_down(xpath, op, change, "Node state removal");
-
-        } else if(name == NULL) {
-            crm_debug("No result for %s operation to %s", op, xpath);
-            CRM_ASSERT(strcmp(op, "delete") == 0 || strcmp(op, "move") == 0);
-
-        } else if(strcmp(name, XML_TAG_CIB) == 0) {
-            xmlNode *state = NULL;
-            xmlNode *status = first_named_child(match, XML_CIB_TAG_STATUS);
-            xmlNode *config = first_named_child(match, XML_CIB_TAG_CONFIGURATION);
-
-            for (state = __xml_first_child(status); state != NULL; state = __xml_next(state)) {
-                xmlNode *lrm = first_named_child(state, XML_CIB_TAG_LRM);
-
-                node = ID(state);
-                process_resource_updates(node, lrm, change, op, xpath);
-            }
-
-            if(config) {
-                abort_transition(INFINITY, tg_restart, "Non-status change", change);
-            }
-
-        } else if(strcmp(name, XML_CIB_TAG_STATUS) == 0) {
-            xmlNode *state = NULL;
-
-            for (state = __xml_first_child(match); state != NULL; state = __xml_next(state)) {
-                xmlNode *lrm = first_named_child(state, XML_CIB_TAG_LRM);
-
-                node = ID(state);
-                process_resource_updates(node, lrm, change, op, xpath);
-            }
-
-        } else if(strcmp(name, XML_CIB_TAG_STATE) == 0) {
-            xmlNode *lrm = first_named_child(match, XML_CIB_TAG_LRM);
-
-            node = ID(match);
-            process_resource_updates(node, lrm, change, op, xpath);
-
-        } else if(strcmp(name, XML_CIB_TAG_LRM) == 0) {
-            node = ID(match);
-            process_resource_updates(node, match, change, op, xpath);
-
-        } else if(strcmp(name, XML_LRM_TAG_RESOURCES) == 0) {
-            char *local_node = get_node_from_xpath(xpath);
-
-            process_resource_updates(local_node, match, change, op, xpath);
-            free(local_node);
-
-        } else if(strcmp(name, XML_LRM_TAG_RESOURCE) == 0) {
-
-            xmlNode *rsc_op;
-            char *local_node = get_node_from_xpath(xpath);
-
-            for (rsc_op = __xml_first_child(match); rsc_op != NULL; rsc_op = __xml_next(rsc_op)) {
-                process_graph_event(rsc_op, local_node);
-            }
-            free(local_node);
-
-        } else if(strcmp(name, XML_LRM_TAG_RSC_OP) == 0) {
-            char *local_node = get_node_from_xpath(xpath);
-
-            process_graph_event(match, local_node);
-            free(local_node);
+    if (te_diff_root == NULL) {
+        te_diff_init();
+    }
 
-        } else {
-            crm_err("Ignoring %s operation for %s %p, %s", op, xpath, match, name);
+    for (change = __xml_first_child(diff); change != NULL; change = __xml_next(change)) {
+        if (te_diff_dispatch(change) == FALSE) {
+            break;
         }
     }
 }
@@ -30,6 +30,7 @@ extern gboolean action_timer_callback(gpointer data);
 extern gboolean te_graph_trigger(gpointer user_data);
 
 extern void te_update_diff(const char *event, xmlNode * msg);
+void te_diff_fini(void);
 
 extern void tengine_stonith_callback(stonith_t * stonith, stonith_callback_data_t * data);
 
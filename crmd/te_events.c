@@ -393,66 +393,46 @@ match_graph_event(crm_action_t *action, xmlNode *event, int op_status,
 crm_action_t *
 get_action(int id, gboolean confirmed)
 {
-    GListPtr gIter = NULL;
-    GListPtr gIter2 = NULL;
-
-    gIter = transition_graph->synapses;
-    for (; gIter != NULL; gIter = gIter->next) {
-        synapse_t *synapse = (synapse_t *) gIter->data;
-
-        gIter2 = synapse->actions;
-        for (; gIter2 != NULL; gIter2 = gIter2->next) {
-            crm_action_t *action = (crm_action_t *) gIter2->data;
+    crm_action_t *action = NULL;
 
-            if (action->id == id) {
-                if (confirmed) {
-                    stop_te_timer(action->timer);
-                    te_action_confirmed(action);
-                }
-                return action;
-            }
-        }
+    if (transition_graph->actions_by_id) {
+        action = g_hash_table_lookup(transition_graph->actions_by_id, GINT_TO_POINTER(id));
     }
 
-    return NULL;
+    if (action && confirmed) {
+        stop_te_timer(action->timer);
+        te_action_confirmed(action);
+    }
+    return action;
 }
 
 crm_action_t *
 get_cancel_action(const char *id, const char *node)
 {
     GListPtr gIter = NULL;
-    GListPtr gIter2 = NULL;
 
-    gIter = transition_graph->synapses;
-    for (; gIter != NULL; gIter = gIter->next) {
-        synapse_t *synapse = (synapse_t *) gIter->data;
-
-        gIter2 = synapse->actions;
-        for (; gIter2 != NULL; gIter2 = gIter2->next) {
-            const char *task = NULL;
-            const char *target = NULL;
-            crm_action_t *action = (crm_action_t *) gIter2->data;
-
-            task = crm_element_value(action->xml, XML_LRM_ATTR_TASK);
-            if (safe_str_neq(CRMD_ACTION_CANCEL, task)) {
-                continue;
-            }
+    if (transition_graph->actions_by_key) {
+        gIter = g_hash_table_lookup(transition_graph->actions_by_key, id);
+    }
 
-            task = crm_element_value(action->xml, XML_LRM_ATTR_TASK_KEY);
-            if (safe_str_neq(task, id)) {
-                crm_trace("Wrong key %s for %s on %s", task, id, node);
-                continue;
-            }
+    for (; gIter != NULL; gIter = gIter->next) {
+        const char *task = NULL;
+        const char *target = NULL;
+        crm_action_t *action = (crm_action_t *) gIter->data;
 
-            target = crm_element_value(action->xml, XML_LRM_ATTR_TARGET_UUID);
-            if (node && safe_str_neq(target, node)) {
-                crm_trace("Wrong node %s for %s on %s", target, id, node);
-                continue;
-            }
+        task = crm_element_value(action->xml, XML_LRM_ATTR_TASK);
+        if (safe_str_neq(CRMD_ACTION_CANCEL, task)) {
+            continue;
+        }
 
-            crm_trace("Found %s on %s", id, node);
-            return action;
+        target = crm_element_value(action->xml, XML_LRM_ATTR_TARGET_UUID);
+        if (node && safe_str_neq(target, node)) {
+            crm_trace("Wrong node %s for %s on %s", target, id, node);
+            continue;
         }
+
+        crm_trace("Found %s on %s", id, node);
+        return action;
     }
 
     return NULL;
@@ -462,58 +442,35 @@ crm_action_t *
 match_down_event(int id, const char *target, const char *filter, bool quiet)
 {
     const char *this_action = NULL;
-    const char *this_node = NULL;
     crm_action_t *match = NULL;
 
     GListPtr gIter = NULL;
-    GListPtr gIter2 = NULL;
-
-    gIter = transition_graph->synapses;
-    for (; gIter != NULL; gIter = gIter->next) {
-        synapse_t *synapse = (synapse_t *) gIter->data;
-
-        /* lookup event */
-        gIter2 = synapse->actions;
-        for (; gIter2 != NULL; gIter2 = gIter2->next) {
-            crm_action_t *action = (crm_action_t *) gIter2->data;
-
-            if (id > 0 && action->id == id) {
-                match = action;
-                break;
-            }
-
-            this_action = crm_element_value(action->xml, XML_LRM_ATTR_TASK);
-
-            if (action->type != action_type_crm) {
-                continue;
 
-            } else if (safe_str_eq(this_action, CRM_OP_LRM_REFRESH)) {
-                continue;
+    if (id > 0 && transition_graph->actions_by_id) {
+        match = g_hash_table_lookup(transition_graph->actions_by_id, GINT_TO_POINTER(id));
+    }
+    if (match == NULL && target && transition_graph->actions_by_node) {
+        gIter = g_hash_table_lookup(transition_graph->actions_by_node, target);
+    }
 
-            } else if (filter != NULL && safe_str_neq(this_action, filter)) {
-                continue;
-            }
+    /* lookup event */
+    for (; match == NULL && gIter != NULL; gIter = gIter->next) {
+        crm_action_t *action = (crm_action_t *) gIter->data;
 
-            this_node = crm_element_value(action->xml, XML_LRM_ATTR_TARGET_UUID);
+        this_action = crm_element_value(action->xml, XML_LRM_ATTR_TASK);
 
-            if (this_node == NULL) {
-                crm_log_xml_err(action->xml, "No node uuid");
-            }
+        if (action->type != action_type_crm) {
+            continue;
 
-            if (safe_str_neq(this_node, target)) {
-                crm_debug("Action %d : Node mismatch: %s", action->id, this_node);
-                continue;
-            }
+        } else if (safe_str_eq(this_action, CRM_OP_LRM_REFRESH)) {
+            continue;
 
-            match = action;
-            id = action->id;
-            break;
+        } else if (filter != NULL && safe_str_neq(this_action, filter)) {
+            continue;
         }
 
-        if (match != NULL) {
-            /* stop this event's timer if it had one */
-            break;
-        }
+        match = action;
+        id = action->id;
     }
 
     if (match != NULL) {
@@ -607,6 +564,10 @@ process_graph_event(xmlNode * event, const char *event_node)
         } else {
             ignore_failures = safe_str_eq(
                 crm_meta_value(action->params, XML_OP_ATTR_ON_FAIL), "ignore");
+
+            action->result_usec = crm_monotonic_usec();
+            crm_element_value_int(event, XML_RSC_OP_T_EXEC, &action->exec_ms);
+            crm_element_value_int(event, XML_RSC_OP_T_QUEUE, &action->queue_ms);
             match_graph_event(action, event, status, rc, target_rc, ignore_failures);
         }
     }
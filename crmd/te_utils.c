@@ -345,6 +345,112 @@ stop_te_timer(crm_action_timer_t * timer)
     return TRUE;
 }
 
+static void
+te_timeline_written(mainloop_child_t * p, pid_t pid, int core, int signo, int exitcode)
+{
+    char *filename = mainloop_child_userdata(p);
+
+    if (signo) {
+        crm_notice("Timeline writer for %s terminated with signal %d (pid=%d, core=%d)",
+                   filename, signo, pid, core);
+
+    } else if (exitcode != 0) {
+        crm_warn("Could not save transition timeline to %s", filename);
+
+    } else {
+        crm_debug("Saved transition timeline to %s", filename);
+    }
+    free(filename);
+}
+
+/*!
+ * \internal
+ * \brief Save a completed transition's timeline next to its PE input
+ *
+ * Nothing is saved if the PE didn't keep the input (see pe-input-series-max),
+ * so timelines are rotated along with the inputs they describe.  The file is
+ * written (and usually compressed) by a child process, so large transitions
+ * don't hold up the mainloop.
+ */
+static void
+te_write_timeline(crm_graph_t * graph)
+{
+    int len = 0;
+    int rc = 0;
+    pid_t pid = 0;
+    char *filename = NULL;
+    xmlNode *timeline = NULL;
+    gboolean compress = FALSE;
+    int bb_state = QB_LOG_STATE_DISABLED;
+
+    if (graph->num_actions == 0 || graph->source == NULL || graph->source[0] != '/'
+        || access(graph->source, F_OK) != 0) {
+        return;
+    }
+
+    len = strlen(graph->source);
+    if (len > 4 && safe_str_eq(graph->source + len - 4, ".bz2")) {
+        compress = TRUE;
+        len -= 4;
+    }
+    filename = crm_strdup_printf("%.*s.timeline%s", len, graph->source, compress ? ".bz2" : "");
+    timeline = graph_timeline_xml(graph);
+
+    /* As for CIB disk writes, keep the child away from the blackbox */
+    bb_state = qb_log_ctl(QB_LOG_BLACKBOX, QB_LOG_CONF_STATE_GET, 0);
+    qb_log_ctl(QB_LOG_BLACKBOX, QB_LOG_CONF_ENABLED, QB_FALSE);
+
+    pid = fork();
+    if (pid == 0) {
+        rc = write_xml_file(timeline, filename, compress);
+
+        /* Use _exit() because exit() could affect the parent adversely */
+        _exit(rc < 0 ? 1 : 0);
+    }
+
+    if (bb_state == QB_LOG_STATE_ENABLED) {
+        qb_log_ctl(QB_LOG_BLACKBOX, QB_LOG_CONF_ENABLED, QB_TRUE);
+    }
+
+    if (pid > 0) {
+        crm_trace("Saving timeline of transition %d to %s (pid=%d)", graph->id, filename, pid);
+        mainloop_child_add(pid, 0, "timeline-writer", filename, te_timeline_written);
+
+    } else {
+        crm_perror(LOG_WARNING, "Could not fork to save timeline of transition %d", graph->id);
+        free(filename);
+    }
+    free_xml(timeline);
+}
+
+/* When the first abort since the last transition acted happened */
+static long long te_abort_usec = 0;
+static int te_abort_graph = -1;
+
+/*!
+ * \internal
+ * \brief Log how long after an abort its replacement transition started acting
+ *
+ * This covers the whole path from a failure being recorded, through the CIB
+ * query and PE calculation, to the first action of the new transition.
+ */
+static void
+te_report_first_action(crm_graph_t * graph, enum transition_status graph_rc)
+{
+    if (te_abort_usec == 0 || graph->id == te_abort_graph) {
+        return;
+
+    } else if (graph->fired > 0) {
+        crm_info("Transition %d initiated its first action %lldms after transition %d was aborted",
+                 graph->id, (crm_monotonic_usec() - te_abort_usec) / 1000, te_abort_graph);
+
+    } else if (graph_rc == transition_pending) {
+        /* Nothing could be initiated yet */
+        return;
+    }
+    te_abort_usec = 0;
+}
+
 gboolean
 te_graph_trigger(gpointer user_data)
 {
@@ -377,6 +483,7 @@ te_graph_trigger(gpointer user_data)
         transition_graph->batch_limit = throttle_get_total_job_limit(limit);
         graph_rc = run_graph(transition_graph);
         transition_graph->batch_limit = limit; /* Restore the configured value */
+        te_report_first_action(transition_graph, graph_rc);
 
         /* significant overhead... */
         /* print_graph(LOG_DEBUG_3, transition_graph); */
@@ -398,6 +505,8 @@ te_graph_trigger(gpointer user_data)
 
     crm_debug("Transition %d is now complete", transition_graph->id);
     transition_graph->complete = TRUE;
+    transition_graph->complete_usec = crm_monotonic_usec();
+    te_write_timeline(transition_graph);
     notify_crmd(transition_graph);
 
     return TRUE;
@@ -441,6 +550,11 @@ abort_transition_graph(int abort_priority, enum transition_action abort_action,
     free(fsa_pe_ref);
     fsa_pe_ref = NULL;
 
+    if (te_abort_usec == 0) {
+        te_abort_usec = crm_monotonic_usec();
+        te_abort_graph = transition_graph->id;
+    }
+
     if (transition_graph->complete == FALSE) {
         if(update_abort_priority(transition_graph, abort_priority, abort_action, abort_text)) {
             level = LOG_NOTICE;
@@ -81,6 +81,7 @@ do_te_control(long long action,
             destroy_graph(transition_graph);
             transition_graph = NULL;
         }
+        te_diff_fini();
 
         if (fsa_cib_conn) {
             fsa_cib_conn->cmds->del_notify_callback(fsa_cib_conn, T_CIB_DIFF_NOTIFY,
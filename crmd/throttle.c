@@ -47,6 +47,14 @@ struct throttle_record_s
         int max;
         enum throttle_state_e mode;
         char *node;
+
+        /* Maintained by the DC from the actions it sends the node */
+        double window;          /* adaptive job limit, 0 until first needed */
+        double latency;         /* smoothed completion time as a fraction of the timeout */
+        double baseline;        /* lowest recent value of latency */
+        int since_decrease;     /* completions since the window was last reduced */
+        int completed;
+        int timeouts;
 };
 
 int throttle_job_max = 0;
@@ -56,6 +64,13 @@ float throttle_load_target = 0.0;
 #define THROTTLE_FACTOR_MEDIUM 1.6
 #define THROTTLE_FACTOR_HIGH   2.0
 
+/* Completion latency (relative to the long term baseline) indicating a node
+ * is queueing work rather than executing it
+ */
+#define THROTTLE_LATENCY_CONGESTED  2.0
+/* Below this fraction of the timeout, latency changes are just noise */
+#define THROTTLE_LATENCY_FLOOR      0.05
+
 GHashTable *throttle_records = NULL;
 mainloop_timer_t *throttle_timer = NULL;
 
@@ -668,13 +683,11 @@ throttle_get_total_job_limit(int l)
     return limit;
 }
 
-int
-throttle_get_job_limit(const char *node)
+static struct throttle_record_s *
+throttle_get_record(const char *node)
 {
-    int jobs = 1;
-    struct throttle_record_s *r = NULL;
+    struct throttle_record_s *r = g_hash_table_lookup(throttle_records, node);
 
-    r = g_hash_table_lookup(throttle_records, node);
     if(r == NULL) {
         r = calloc(1, sizeof(struct throttle_record_s));
         r->node = strdup(node);
@@ -684,6 +697,13 @@ throttle_get_job_limit(const char *node)
 
         g_hash_table_insert(throttle_records, r->node, r);
     }
+    return r;
+}
+
+static int
+throttle_mode_limit(struct throttle_record_s *r)
+{
+    int jobs = 1;
 
     switch(r->mode) {
         case throttle_extreme:
@@ -700,12 +720,135 @@ throttle_get_job_limit(const char *node)
             jobs = QB_MAX(1, r->max);
             break;
         default:
-            crm_err("Unknown throttle mode %.4x on %s", r->mode, node);
+            crm_err("Unknown throttle mode %.4x on %s", r->mode, r->node);
             break;
     }
     return jobs;
 }
 
+int
+throttle_get_job_limit(const char *node)
+{
+    struct throttle_record_s *r = throttle_get_record(node);
+    int jobs = throttle_mode_limit(r);
+
+    if(r->window > 0.0 && jobs > (int) r->window) {
+        crm_trace("Limiting %s to %d jobs instead of %d", node, (int) r->window, jobs);
+        jobs = QB_MAX(1, (int) r->window);
+    }
+    return jobs;
+}
+
+/*!
+ * \internal
+ * \brief Adjust a node's job limit based on how long an action took
+ *
+ * A node's self-reported load only changes in coarse steps and every 30s.
+ * The DC also sees how quickly each node completes the actions sent to it, so
+ * treat that like a congestion signal: grow the limit by one job per window's
+ * worth of completions, back off by a quarter when actions start taking
+ * noticeably longer than usual, and halve it when one times out.
+ *
+ * \param[in] node        Node the action was executed on
+ * \param[in] elapsed_ms  Time between sending the action and its result
+ * \param[in] timeout_ms  The action's timeout
+ */
+void
+throttle_record_completion(const char *node, long long elapsed_ms, int timeout_ms)
+{
+    double ratio = 0.0;
+    struct throttle_record_s *r = NULL;
+
+    if(node == NULL || throttle_records == NULL) {
+        return;
+    }
+
+    r = throttle_get_record(node);
+    if(r->window <= 0.0) {
+        r->window = QB_MAX(1, r->max);
+    }
+
+    if(timeout_ms > 0) {
+        ratio = (double) elapsed_ms / timeout_ms;
+    }
+    r->completed++;
+
+    if(ratio >= 1.0) {
+        r->timeouts++;
+        r->window = QB_MAX(1.0, r->window / 2);
+        r->since_decrease = 0;
+        crm_notice("Action on %s took %lldms (timeout=%dms), reducing its job limit to %d",
+                   node, elapsed_ms, timeout_ms, (int) r->window);
+        return;
+    }
+
+    if(r->completed == 1) {
+        r->latency = ratio;
+        r->baseline = ratio;
+    } else {
+        r->latency += (ratio - r->latency) / 8;
+    }
+
+    if(r->latency < r->baseline) {
+        r->baseline = r->latency;
+    } else {
+        /* Follow long term changes in the kinds of actions being run */
+        r->baseline += (r->latency - r->baseline) / 64;
+    }
+
+    if(r->latency > THROTTLE_LATENCY_FLOOR
+       && r->latency > THROTTLE_LATENCY_CONGESTED * r->baseline
+       && r->since_decrease >= (int) r->window) {
+        r->window = QB_MAX(1.0, r->window * 0.75);
+        r->since_decrease = 0;
+        crm_info("Actions on %s are slowing down (%.0f%% of timeout vs. %.0f%%), reducing its job limit to %d",
+                 node, 100 * r->latency, 100 * r->baseline, (int) r->window);
+
+    } else {
+        r->since_decrease++;
+        r->window = QB_MIN(r->window + 1 / r->window, QB_MAX(1, r->max));
+    }
+
+    crm_trace("Node %s: latency=%.3f baseline=%.3f window=%.2f",
+              node, r->latency, r->baseline, r->window);
+}
+
+/*!
+ * \internal
+ * \brief Add the current per-node job limits to an XML tree
+ */
+void
+throttle_report(xmlNode *parent)
+{
+    GHashTableIter iter;
+    struct throttle_record_s *r = NULL;
+
+    if(throttle_records == NULL) {
+        return;
+    }
+
+    g_hash_table_iter_init(&iter, throttle_records);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) &r)) {
+        xmlNode *node = create_xml_node(parent, "throttle");
+        char *value = NULL;
+
+        crm_xml_add(node, XML_ATTR_UNAME, r->node);
+        crm_xml_add_int(node, "mode", r->mode);
+        crm_xml_add_int(node, "max", r->max);
+        crm_xml_add_int(node, "limit", throttle_get_job_limit(r->node));
+        crm_xml_add_int(node, "completed", r->completed);
+        crm_xml_add_int(node, "timeouts", r->timeouts);
+
+        value = crm_strdup_printf("%.2f", r->window);
+        crm_xml_add(node, "window", value);
+        free(value);
+
+        value = crm_strdup_printf("%.3f", r->latency);
+        crm_xml_add(node, "latency", value);
+        free(value);
+    }
+}
+
 void
 throttle_update(xmlNode *xml)
 {
@@ -717,13 +860,7 @@ throttle_update(xmlNode *xml)
     crm_element_value_int(xml, F_CRM_THROTTLE_MODE, (int*)&mode);
     crm_element_value_int(xml, F_CRM_THROTTLE_MAX, &max);
 
-    r = g_hash_table_lookup(throttle_records, from);
-
-    if(r == NULL) {
-        r = calloc(1, sizeof(struct throttle_record_s));
-        r->node = strdup(from);
-        g_hash_table_insert(throttle_records, r->node, r);
-    }
+    r = throttle_get_record(from);
 
     r->max = max;
     r->mode = mode;
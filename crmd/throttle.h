@@ -27,3 +27,5 @@ void throttle_update(xmlNode *xml);
 void throttle_update_job_max(const char *preference);
 int throttle_get_job_limit(const char *node);
 int throttle_get_total_job_limit(int l);
+void throttle_record_completion(const char *node, long long elapsed_ms, int timeout_ms);
+void throttle_report(xmlNode *parent);
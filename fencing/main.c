@@ -1077,27 +1077,34 @@ update_cib_cache_cb(const char *event, xmlNode * msg)
         xmlNode *patchset = NULL;
 
         crm_element_value_int(msg, F_CIB_RC, &rc);
-        if (rc != pcmk_ok) {
+        if (rc == -pcmk_err_diff_resync) {
+            /* The cib dropped updates we never saw, start again from a full copy */
+            crm_notice("[%s] Missed updates, re-reading the CIB", event);
+            free_xml(local_cib);
+            local_cib = NULL;
+
+        } else if (rc != pcmk_ok) {
             return;
-        }
 
-        patchset = get_message_xml(msg, F_CIB_UPDATE_RESULT);
-        xml_log_patchset(LOG_TRACE, "Config update", patchset);
-        rc = xml_apply_patchset(local_cib, patchset, TRUE);
-        switch (rc) {
-            case pcmk_ok:
-            case -pcmk_err_old_data:
-                break;
-            case -pcmk_err_diff_resync:
-            case -pcmk_err_diff_failed:
-                crm_notice("[%s] Patch aborted: %s (%d)", event, pcmk_strerror(rc), rc);
-                free_xml(local_cib);
-                local_cib = NULL;
-                break;
-            default:
-                crm_warn("[%s] ABORTED: %s (%d)", event, pcmk_strerror(rc), rc);
-                free_xml(local_cib);
-                local_cib = NULL;
+        } else {
+            patchset = get_message_xml(msg, F_CIB_UPDATE_RESULT);
+            xml_log_patchset(LOG_TRACE, "Config update", patchset);
+            rc = xml_apply_patchset(local_cib, patchset, TRUE);
+            switch (rc) {
+                case pcmk_ok:
+                case -pcmk_err_old_data:
+                    break;
+                case -pcmk_err_diff_resync:
+                case -pcmk_err_diff_failed:
+                    crm_notice("[%s] Patch aborted: %s (%d)", event, pcmk_strerror(rc), rc);
+                    free_xml(local_cib);
+                    local_cib = NULL;
+                    break;
+                default:
+                    crm_warn("[%s] ABORTED: %s (%d)", event, pcmk_strerror(rc), rc);
+                    free_xml(local_cib);
+                    local_cib = NULL;
+            }
         }
     }
 
@@ -39,6 +39,7 @@
 #  define CIB_OP_UPGRADE_OK "cib_upgrade_ok"
 #  define CIB_OP_DELETE_ALT	"cib_delete_alt"
 #  define CIB_OP_NOTIFY	      "cib_notify"
+#  define CIB_OP_STATS	"cib_stats"
 
 #  define F_CIB_CLIENTID  "cib_clientid"
 #  define F_CIB_CALLOPTS  "cib_callopt"
@@ -121,6 +122,23 @@ typedef int (*cib_op_t) (const char *, int, const char *, xmlNode *,
 
 cib_t *cib_new_variant(void);
 
+enum cib_op_phase {
+    cib_phase_apply = 0,
+    cib_phase_acl,
+    cib_phase_diff,
+    cib_phase_validate,
+    cib_phase_digest,
+    cib_phase_send,
+    cib_phase_notify,
+    cib_phase_max
+};
+
+/* Time the last cib_perform_op() call spent in each phase (microseconds)
+ * The send and notify phases are recorded by the caller
+ */
+extern long long cib_op_phase_usec[cib_phase_max];
+const char *cib_op_phase_text(enum cib_op_phase phase);
+
 int cib_perform_op(const char *op, int call_options, cib_op_t * fn, gboolean is_query,
                    const char *section, xmlNode * req, xmlNode * input,
                    gboolean manage_counters, gboolean * config_changed,
@@ -61,6 +61,8 @@ struct crm_remote_s {
 enum crm_client_flags
 {
     crm_client_flag_ipc_proxied = 0x00001, /* ipc_proxy code only */
+    crm_client_flag_batch_notify = 0x00002, /* lrmd only: accepts batched notifications */
+    crm_client_flag_binary_notify = 0x00004, /* lrmd only: accepts binary operation results */
 };
 
 struct crm_client_s {
@@ -80,7 +82,7 @@ struct crm_client_s {
     void *userdata;
 
     int event_timer;
-    GList *event_queue;
+    GList *event_queue;         /* Unused, events are queued in private state */
 
     /* Depending on the value of kind, only some of the following
      * will be populated/valid
@@ -91,6 +93,7 @@ struct crm_client_s {
 
     struct crm_remote_s *remote;        /* TCP/TLS */
 
+    struct crm_client_private_s *private;
 };
 
 extern GHashTable *client_connections;
@@ -113,8 +116,12 @@ void crm_ipcs_send_ack(crm_client_t * c, uint32_t request, uint32_t flags,
 ssize_t crm_ipc_prepare(uint32_t request, xmlNode * message, struct iovec ** result, uint32_t max_send_size);
 ssize_t crm_ipcs_send(crm_client_t * c, uint32_t request, xmlNode * message, enum crm_ipc_flags flags);
 ssize_t crm_ipcs_sendv(crm_client_t * c, struct iovec *iov, enum crm_ipc_flags flags);
+ssize_t crm_ipcs_send_buffer(crm_client_t * c, uint32_t request, char *buffer, unsigned int size,
+                             enum crm_ipc_flags flags);
 xmlNode *crm_ipcs_recv(crm_client_t * c, void *data, size_t size, uint32_t * id, uint32_t * flags);
 
 int crm_ipcs_client_pid(qb_ipcs_connection_t * c);
+unsigned int crm_ipcs_event_backlog(crm_client_t * c);
+void crm_ipcs_event_limits(crm_client_t * c, unsigned int *peak, unsigned int *max);
 
 #endif
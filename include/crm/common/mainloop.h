@@ -65,6 +65,29 @@ mainloop_timer_t *mainloop_timer_add(const char *name, guint period_ms, bool rep
 
 void mainloop_timer_del(mainloop_timer_t *t);
 
+/* Timer wheel, for large numbers of timers that needn't be exact, such as
+ * recurring operations and operation timeouts
+ */
+#  define MAINLOOP_WHEEL_TICK_MS 100
+
+typedef struct mainloop_wheel_stats_s {
+    guint timers;               /* currently scheduled */
+    guint last_due;             /* fired on the most recent tick with any */
+    guint max_due;              /* most fired on a single tick */
+    guint64 fired;              /* fired in total */
+    guint64 busy_ticks;         /* ticks on which any fired */
+} mainloop_wheel_stats_t;
+
+guint mainloop_wheel_add(guint delay_ms, guint jitter_ms, GSourceFunc cb, gpointer userdata);
+
+gboolean mainloop_wheel_remove(guint id);
+
+guint mainloop_wheel_due(guint within_ms, guint * counts);
+
+void mainloop_wheel_stats(mainloop_wheel_stats_t * stats);
+
+void mainloop_wheel_cleanup(void);
+
 
 #  include <crm/common/ipc.h>
 #  include <qb/qbipcs.h>
@@ -48,6 +48,8 @@ typedef struct lrmd_key_value_s {
 #define F_LRMD_IS_IPC_PROVIDER  "lrmd_is_ipc_provider"
 #define F_LRMD_CLIENTID         "lrmd_clientid"
 #define F_LRMD_PROTOCOL_VERSION "lrmd_protocol_version"
+#define F_LRMD_BATCH_NOTIFY     "lrmd_batch_notify"
+#define F_LRMD_BINARY_NOTIFY    "lrmd_binary_notify"
 #define F_LRMD_REMOTE_MSG_TYPE  "lrmd_remote_msg_type"
 #define F_LRMD_REMOTE_MSG_ID    "lrmd_remote_msg_id"
 #define F_LRMD_CALLBACK_TOKEN   "lrmd_async_id"
@@ -89,6 +91,8 @@ typedef struct lrmd_key_value_s {
 #define LRMD_OP_RSC_METADATA      "lrmd_rsc_metadata"
 #define LRMD_OP_POKE              "lrmd_rsc_poke"
 #define LRMD_OP_NEW_CLIENT        "lrmd_rsc_new_client"
+#define LRMD_OP_STATS             "lrmd_stats"
+#define LRMD_OP_NOTIFY_BATCH      "lrmd_notify_batch"
 
 #define F_LRMD_IPC_OP           "lrmd_ipc_op"
 #define F_LRMD_IPC_IPC_SERVER   "lrmd_ipc_server"
@@ -252,6 +256,26 @@ typedef struct lrmd_list_s {
 void lrmd_list_freeall(lrmd_list_t * head);
 void lrmd_key_value_freeall(lrmd_key_value_t * head);
 
+typedef void (*lrmd_metadata_callback) (int rc, const char *metadata, void *user_data);
+
+/*!
+ * \brief Get the metadata documentation for a resource agent without blocking
+ *
+ * \param[in] class      Resource agent class
+ * \param[in] provider   Resource agent provider (for OCF agents)
+ * \param[in] agent      Resource agent type
+ * \param[in] callback   Function to pass the result (or error) to
+ * \param[in] user_data  Argument for \p callback
+ *
+ * \note The callback is invoked from the mainloop once the agent completes,
+ *       or before this returns if the result is already known (for example
+ *       if it is cached on disk or does not require running the agent).
+ * \retval pcmk_ok  callback will be (or was) invoked
+ * \retval negative error code on failure (callback will not be invoked)
+ */
+int lrmd_get_metadata_async(const char *class, const char *provider, const char *agent,
+                            lrmd_metadata_callback callback, void *user_data);
+
 typedef struct lrmd_api_operations_s {
     /*!
      * \brief Connect from the lrmd.
@@ -434,6 +458,20 @@ typedef struct lrmd_api_operations_s {
      */
     int (*list_standards) (lrmd_t * lrmd, lrmd_list_t ** standards);
 
+    /*!
+     * \brief Retrieve the lrmd's execution statistics
+     *
+     * Includes the concurrency limit, the number of operations running and
+     * queued, and histograms of how long operations of each priority class
+     * waited to be executed and took to execute.
+     *
+     * \note stats must be freed using free_xml()
+     *
+     * \retval pcmk_ok success
+     * \retval negative error code on failure
+     */
+    int (*get_stats) (lrmd_t * lrmd, xmlNode ** stats);
+
 } lrmd_api_operations_t;
 
 struct lrmd_s {
@@ -39,6 +39,17 @@ typedef struct synapse_s {
 
     GListPtr actions;           /* crm_action_t* */
     GListPtr inputs;            /* crm_action_t* */
+
+    int pending_inputs;         /* inputs not yet confirmed */
+
+    /* Timeline, as crm_monotonic_usec() values */
+    long long ready_usec;       /* when its last input was confirmed */
+    long long fired_usec;       /* when its actions were initiated */
+    int ready_input;            /* id of the action that made it ready, or -1 */
+
+    int counted;                /* which of the graph's totals include it */
+
+    GSequence *lane;            /* node queue it waits in once ready, NULL for priority */
 } synapse_t;
 
 typedef struct crm_action_s {
@@ -60,6 +71,13 @@ typedef struct crm_action_s {
 
     xmlNode *xml;
 
+    /* Timeline, as crm_monotonic_usec() values */
+    long long sent_usec;        /* when it was sent for execution */
+    long long result_usec;      /* when its result was processed */
+    long long confirmed_usec;   /* when the graph was updated with it */
+    int exec_ms;                /* execution time reported with the result */
+    int queue_ms;               /* queue time reported with the result */
+
 } crm_action_t;
 
 enum timer_reason {
@@ -110,6 +128,30 @@ typedef struct crm_graph_s {
 
     int migration_limit;
 
+    GHashTable *dependents;     /* action id -> GList of crm_action_t* inputs waiting on it */
+    GSequence *ready;           /* synapse_t* with all inputs confirmed, by id (unless by node) */
+
+    GHashTable *actions_by_id;  /* action id -> crm_action_t* */
+    GHashTable *actions_by_key; /* task key -> GList of crm_action_t* */
+    GHashTable *actions_by_node; /* target uuid -> GList of crm_action_t*, in graph order */
+
+    int dispatch_round;         /* rotates which node is served first */
+
+    long long start_usec;       /* when it was unpacked */
+    long long complete_usec;    /* when it completed */
+
+    /* Totals kept up to date as synapses change state */
+    int num_completed;          /* confirmed */
+    int num_pending;            /* executed, waiting for confirmation */
+    int num_failed;             /* failed */
+    int num_waiting;            /* not executed, inputs still unconfirmed */
+
+    /* Ready synapses, queued by node when something can hold them back */
+    gboolean ready_by_node;     /* TRUE if ready synapses are in the queues below */
+    GSequence *ready_priority;  /* synapse_t* that skip the node queues, by id */
+    GHashTable *lanes;          /* node name -> GSequence of synapse_t*, by id */
+    GListPtr lane_order;        /* GSequence*, in the order nodes are served */
+
 } crm_graph_t;
 
 typedef struct crm_graph_functions_s {
@@ -142,5 +184,6 @@ void print_action(int log_level, const char *prefix, crm_action_t * action);
 bool update_abort_priority(crm_graph_t * graph, int priority,
                            enum transition_action action, const char *abort_reason);
 const char *actiontype2text(action_type_e type);
+xmlNode *graph_timeline_xml(crm_graph_t * graph);
 lrmd_event_data_t *convert_graph_action(xmlNode * resource, crm_action_t * action, int status,
                                         int rc);
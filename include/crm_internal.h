@@ -204,6 +204,7 @@ char *generate_hash_key(const char *crm_msg_reference, const char *sys);
 
 bool crm_compress_string(const char *data, int length, int max, char **result,
                          unsigned int *result_len);
+long long crm_monotonic_usec(void);
 
 /*! remote tcp/tls helper functions */
 typedef struct crm_remote_s crm_remote_t;
@@ -359,6 +360,7 @@ static inline void *realloc_safe(void *ptr, size_t size)
 const char *crm_xml_add_last_written(xmlNode *xml_node);
 void crm_xml_dump(xmlNode * data, int options, char **buffer, int *offset, int *max, int depth);
 void crm_buffer_add_char(char **buffer, int *offset, int *max, char c);
+void xml_acl_enforce(xmlNode * xml, xmlNode *acl_source, const char *user);
 
 gboolean crm_digest_verify(xmlNode *input, const char *expected);
 
@@ -377,6 +379,14 @@ typedef struct remote_proxy_s {
     uint32_t last_request_id;
 
 } remote_proxy_t;
+
+/* Operation results sent to local lrmd clients that ask for them, as a
+ * message starting with LRMD_BINARY_MAGIC followed by packed results
+ */
+#  define LRMD_BINARY_MAGIC "LRMB"
+#  define LRMD_BINARY_MAGIC_LEN 4
+char *lrmd_event_pack(lrmd_event_data_t * event, unsigned int *size);
+
 void remote_proxy_notify_destroy(lrmd_t *lrmd, const char *session_id);
 void remote_proxy_relay_event(lrmd_t *lrmd, const char *session_id, xmlNode *msg);
 void remote_proxy_relay_response(lrmd_t *lrmd, const char *session_id, xmlNode *msg, int msg_id);
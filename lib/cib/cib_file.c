@@ -502,6 +502,149 @@ cib_file_new(const char *cib_location)
 
 static xmlNode *in_mem_cib = NULL;
 
+/* Parsed and validated CIBs, most recently used first.  Tools that sign on to
+ * the same file over and over (scripted simulations, shadow CIBs) only pay for
+ * parsing and schema validation once.
+ *
+ * A file whose inode, size and modification time are unchanged is assumed to
+ * be unchanged, unless it was modified in the same second it was cached (the
+ * check could miss a later write in that second).  Otherwise its contents are
+ * hashed, so that an identical copy is still found.
+ */
+#define CIB_FILE_CACHE_MAX 8
+
+typedef struct cib_file_cached_s {
+    char *filename;
+    char *digest;               /* NULL if never calculated */
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    time_t mtime;
+    time_t cached;
+    xmlNode *xml;
+} cib_file_cached_t;
+
+static GQueue *file_cache = NULL;
+
+static void
+cib_file_cached_free(cib_file_cached_t * entry)
+{
+    free(entry->filename);
+    free(entry->digest);
+    free_xml(entry->xml);
+    free(entry);
+}
+
+static gboolean
+cib_file_cached_current(cib_file_cached_t * entry, struct stat *buf)
+{
+    return entry->dev == buf->st_dev && entry->ino == buf->st_ino
+        && entry->size == buf->st_size && entry->mtime == buf->st_mtime
+        && entry->mtime < entry->cached;
+}
+
+/*!
+ * \internal
+ * \brief Look for an earlier parse of a file's contents
+ *
+ * \param[in]  filename  Name of file being loaded
+ * \param[in]  buf       Result of stat() on \p filename
+ * \param[out] digest    Digest of the file's contents, if it was needed
+ * \param[out] contents  Contents of the file, if they were read (caller must free)
+ *
+ * \return Copy of the cached CIB, or NULL if there is none
+ * \note Compressed files are not cached.
+ */
+static xmlNode *
+cib_file_cache_lookup(const char *filename, struct stat *buf, char **digest,
+                      char **contents)
+{
+    GList *iter = NULL;
+    cib_file_cached_t *entry = NULL;
+
+    *digest = NULL;
+    *contents = NULL;
+    if (file_cache == NULL || strstr(filename, ".bz2") != NULL) {
+        return NULL;
+    }
+
+    for (iter = file_cache->head; iter != NULL; iter = iter->next) {
+        entry = iter->data;
+        if (safe_str_eq(entry->filename, filename) && cib_file_cached_current(entry, buf)) {
+            crm_trace("Using cached CIB for unchanged %s", filename);
+            g_queue_unlink(file_cache, iter);
+            g_queue_push_head_link(file_cache, iter);
+            return copy_xml(entry->xml);
+        }
+    }
+
+    *contents = crm_read_contents(filename);
+    if (*contents == NULL) {
+        return NULL;
+    }
+    *digest = crm_md5sum(*contents);
+
+    for (iter = file_cache->head; iter != NULL; iter = iter->next) {
+        entry = iter->data;
+        if (safe_str_eq(entry->digest, *digest)) {
+            crm_trace("Using cached CIB for digest %s", *digest);
+            return copy_xml(entry->xml);
+        }
+    }
+    return NULL;
+}
+
+/*!
+ * \internal
+ * \brief Remember the parsed contents of a file
+ *
+ * \param[in] filename  Name of file \p root was read from or written to
+ * \param[in] digest    Digest of the file's contents (or NULL if not known)
+ * \param[in] root      Parsed and validated contents
+ */
+static void
+cib_file_cache_add(const char *filename, const char *digest, xmlNode * root)
+{
+    GList *iter = NULL;
+    struct stat buf;
+    cib_file_cached_t *entry = NULL;
+
+    if (root == NULL || strstr(filename, ".bz2") != NULL || stat(filename, &buf) < 0) {
+        return;
+    }
+
+    if (file_cache == NULL) {
+        file_cache = g_queue_new();
+    }
+
+    for (iter = file_cache->head; iter != NULL; iter = iter->next) {
+        entry = iter->data;
+        if (safe_str_eq(entry->filename, filename)) {
+            g_queue_delete_link(file_cache, iter);
+            cib_file_cached_free(entry);
+            break;
+        }
+    }
+
+    while (g_queue_get_length(file_cache) >= CIB_FILE_CACHE_MAX) {
+        entry = g_queue_pop_tail(file_cache);
+        crm_trace("Expiring cached CIB for %s", entry->filename);
+        cib_file_cached_free(entry);
+    }
+
+    crm_trace("Caching CIB for %s", filename);
+    entry = calloc(1, sizeof(cib_file_cached_t));
+    entry->filename = strdup(filename);
+    entry->digest = digest? strdup(digest) : NULL;
+    entry->dev = buf.st_dev;
+    entry->ino = buf.st_ino;
+    entry->size = buf.st_size;
+    entry->mtime = buf.st_mtime;
+    entry->cached = time(NULL);
+    entry->xml = copy_xml(root);
+    g_queue_push_head(file_cache, entry);
+}
+
 /*!
  * \internal
  * \brief Read CIB from disk and validate it against XML DTD
@@ -521,6 +664,8 @@ load_file_cib(const char *filename)
 {
     struct stat buf;
     xmlNode *root = NULL;
+    char *digest = NULL;
+    char *contents = NULL;
     const char *ignore_dtd = NULL;
 
     /* Ensure file is readable */
@@ -528,9 +673,27 @@ load_file_cib(const char *filename)
         return -ENXIO;
     }
 
-    /* Parse XML from file */
-    root = filename2xml(filename);
+    /* Re-use an earlier parse of identical contents if we have one */
+    in_mem_cib = cib_file_cache_lookup(filename, &buf, &digest, &contents);
+    if (in_mem_cib) {
+        free(contents);
+        free(digest);
+        return pcmk_ok;
+    }
+
+    /* Parse XML from the contents already read for the digest, or the file */
+    if (contents) {
+        root = string2xml(contents);
+        free(contents);
+        if (root) {
+            strip_text_nodes(root);
+        }
+
+    } else {
+        root = filename2xml(filename);
+    }
     if (root == NULL) {
+        free(digest);
         return -pcmk_err_schema_validation;
     }
 
@@ -544,10 +707,13 @@ load_file_cib(const char *filename)
     if (validate_xml(root, NULL, TRUE) == FALSE) {
         crm_err("CIB does not validate against %s", ignore_dtd);
         free_xml(root);
+        free(digest);
         return -pcmk_err_schema_validation;
     }
 
     /* Remember the parsed XML for later use */
+    cib_file_cache_add(filename, digest, root);
+    free(digest);
     in_mem_cib = root;
     return pcmk_ok;
 }
@@ -696,6 +862,9 @@ cib_file_signoff(cib_t * cib)
         }
 
         if (rc == pcmk_ok) {
+            /* The next sign-on will most likely be for what we just wrote */
+            cib_file_cache_add(private->filename, NULL, in_mem_cib);
+
             crm_info("Wrote CIB to %s", private->filename);
             clear_bit(private->flags, cib_flag_dirty);
         } else {
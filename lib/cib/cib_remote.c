@@ -70,6 +70,14 @@ typedef struct cib_remote_opaque_s {
     crm_remote_t command;
     crm_remote_t callback;
 
+    /* When multiplexed, commands, replies and notifications all share the
+     * callback connection.  Anything that arrives while we are waiting for a
+     * synchronous reply is queued and dispatched from the mainloop later.
+     */
+    gboolean multiplexed;
+    GQueue *pending;
+    crm_trigger_t *dispatch_trigger;
+
 } cib_remote_opaque_t;
 
 void cib_remote_connection_destroy(gpointer user_data);
@@ -83,6 +91,12 @@ int cib_remote_perform_op(cib_t * cib, const char *op, const char *host, const c
                           xmlNode * data, xmlNode ** output_data, int call_options,
                           const char *name);
 
+static crm_remote_t *
+cib_remote_command_channel(cib_remote_opaque_t * private)
+{
+    return private->multiplexed ? &private->callback : &private->command;
+}
+
 static int
 cib_remote_inputfd(cib_t * cib)
 {
@@ -115,6 +129,7 @@ cib_t *
 cib_remote_new(const char *server, const char *user, const char *passwd, int port,
                gboolean encrypted)
 {
+    const char *value = NULL;
     cib_remote_opaque_t *private = NULL;
     cib_t *cib = cib_new_variant();
 
@@ -137,6 +152,8 @@ cib_remote_new(const char *server, const char *user, const char *passwd, int por
 
     private->port = port;
     private->encrypted = encrypted;
+    value = getenv("CIB_multiplex");
+    private->multiplexed = (value == NULL) || crm_is_true(value);
 
     /* assign variant specific ops */
     cib->delegate_fn = cib_remote_perform_op;
@@ -195,6 +212,18 @@ cib_tls_close(cib_t * cib)
     private->command.buffer = NULL;
     private->callback.buffer = NULL;
 
+    if (private->pending) {
+        while (g_queue_is_empty(private->pending) == FALSE) {
+            free_xml(g_queue_pop_head(private->pending));
+        }
+        g_queue_free(private->pending);
+        private->pending = NULL;
+    }
+    if (private->dispatch_trigger) {
+        mainloop_destroy_trigger(private->dispatch_trigger);
+        private->dispatch_trigger = NULL;
+    }
+
     return 0;
 }
 
@@ -336,39 +365,87 @@ cib_remote_command_dispatch(gpointer user_data)
     return 0;
 }
 
-int
-cib_remote_callback_dispatch(gpointer user_data)
+static void
+cib_remote_dispatch_msg(cib_t * cib, xmlNode * msg)
+{
+    const char *type = crm_element_value(msg, F_TYPE);
+
+    crm_trace("Activating %s callbacks...", type);
+
+    if (safe_str_eq(type, T_CIB)) {
+        cib_native_callback(cib, msg, 0, 0);
+
+    } else if (safe_str_eq(type, T_CIB_NOTIFY)) {
+        g_list_foreach(cib->notify_list, cib_native_notify, msg);
+
+    } else {
+        crm_err("Unknown message type: %s", type);
+    }
+}
+
+/* Deliver whatever arrived while we were waiting for a synchronous reply */
+static int
+cib_remote_dispatch_pending(gpointer user_data)
 {
     cib_t *cib = user_data;
     cib_remote_opaque_t *private = cib->variant_opaque;
-
     xmlNode *msg = NULL;
-    int disconnected = 0;
-
-    crm_info("Message on callback channel");
 
-    crm_remote_recv(&private->callback, -1, &disconnected);
+    while (private->pending && (msg = g_queue_pop_head(private->pending))) {
+        cib_remote_dispatch_msg(cib, msg);
+        free_xml(msg);
+    }
 
+    /* Messages received after the reply may still be sitting in the buffer */
     msg = crm_remote_parse_buffer(&private->callback);
     while (msg) {
-        const char *type = crm_element_value(msg, F_TYPE);
-
-        crm_trace("Activating %s callbacks...", type);
+        cib_remote_dispatch_msg(cib, msg);
+        free_xml(msg);
+        msg = crm_remote_parse_buffer(&private->callback);
+    }
+    return TRUE;
+}
 
-        if (safe_str_eq(type, T_CIB)) {
-            cib_native_callback(cib, msg, 0, 0);
+/* Most messages to hold for a client that isn't running a mainloop */
+#define CIB_REMOTE_PENDING_MAX 500
 
-        } else if (safe_str_eq(type, T_CIB_NOTIFY)) {
-            g_list_foreach(cib->notify_list, cib_native_notify, msg);
+/* Takes ownership of msg */
+static void
+cib_remote_queue_msg(cib_t * cib, xmlNode * msg)
+{
+    cib_remote_opaque_t *private = cib->variant_opaque;
 
-        } else {
-            crm_err("Unknown message type: %s", type);
-        }
+    if (private->pending == NULL) {
+        private->pending = g_queue_new();
 
+    } else if (g_queue_get_length(private->pending) >= CIB_REMOTE_PENDING_MAX) {
+        /* Nothing is dispatching them, so behave as before multiplexing */
+        crm_warn("Discarding %s message: %d already waiting for dispatch",
+                 crm_element_value(msg, F_TYPE), CIB_REMOTE_PENDING_MAX);
         free_xml(msg);
-        msg = crm_remote_parse_buffer(&private->callback);
+        return;
+    }
+    if (private->dispatch_trigger == NULL) {
+        private->dispatch_trigger =
+            mainloop_add_trigger(G_PRIORITY_HIGH, cib_remote_dispatch_pending, cib);
     }
 
+    g_queue_push_tail(private->pending, msg);
+}
+
+int
+cib_remote_callback_dispatch(gpointer user_data)
+{
+    cib_t *cib = user_data;
+    cib_remote_opaque_t *private = cib->variant_opaque;
+
+    int disconnected = 0;
+
+    crm_info("Message on callback channel");
+
+    crm_remote_recv(&private->callback, -1, &disconnected);
+    cib_remote_dispatch_pending(cib);
+
     if (disconnected) {
         return -1;
     }
@@ -411,7 +488,7 @@ cib_remote_signon(cib_t * cib, const char *name, enum cib_conn_type type)
         rc = -EINVAL;
     }
 
-    if (rc == pcmk_ok) {
+    if (rc == pcmk_ok && private->multiplexed == FALSE) {
         rc = cib_tls_signon(cib, &(private->command), FALSE);
     }
 
@@ -423,7 +500,7 @@ cib_remote_signon(cib_t * cib, const char *name, enum cib_conn_type type)
         xmlNode *hello =
             cib_create_op(0, private->callback.token, CRM_OP_REGISTER, NULL, NULL, NULL, 0, NULL);
         crm_xml_add(hello, F_CIB_CLIENTNAME, name);
-        crm_remote_send(&private->command, hello);
+        crm_remote_send(cib_remote_command_channel(private), hello);
         free_xml(hello);
     }
 
@@ -486,6 +563,7 @@ cib_remote_perform_op(cib_t * cib, const char *op, const char *host, const char
                       xmlNode * data, xmlNode ** output_data, int call_options, const char *name)
 {
     int rc = pcmk_ok;
+    int timeout = 0;
     int disconnected = 0;
     int remaining_time = 0;
     time_t start_time;
@@ -494,6 +572,7 @@ cib_remote_perform_op(cib_t * cib, const char *op, const char *host, const char
     xmlNode *op_reply = NULL;
 
     cib_remote_opaque_t *private = cib->variant_opaque;
+    crm_remote_t *channel = cib_remote_command_channel(private);
 
     if (cib->state == cib_disconnected) {
         return -ENOTCONN;
@@ -528,7 +607,7 @@ cib_remote_perform_op(cib_t * cib, const char *op, const char *host, const char
     if (!(call_options & cib_sync_call)) {
         crm_remote_send(&private->callback, op_msg);
     } else {
-        crm_remote_send(&private->command, op_msg);
+        crm_remote_send(channel, op_msg);
     }
     free_xml(op_msg);
 
@@ -543,14 +622,19 @@ cib_remote_perform_op(cib_t * cib, const char *op, const char *host, const char
     crm_trace("Waiting for a syncronous reply");
 
     start_time = time(NULL);
-    remaining_time = cib->call_timeout ? cib->call_timeout : 60;
+    timeout = cib->call_timeout ? cib->call_timeout : 60;
+    remaining_time = timeout;
 
     while (remaining_time > 0 && !disconnected) {
         int reply_id = -1;
         int msg_id = cib->call_id;
 
-        crm_remote_recv(&private->command, remaining_time * 1000, &disconnected);
-        op_reply = crm_remote_parse_buffer(&private->command);
+        /* Earlier reads may have left complete messages in the buffer */
+        op_reply = private->multiplexed ? crm_remote_parse_buffer(channel) : NULL;
+        if (op_reply == NULL) {
+            crm_remote_recv(channel, remaining_time * 1000, &disconnected);
+            op_reply = crm_remote_parse_buffer(channel);
+        }
 
         if (!op_reply) {
             break;
@@ -558,9 +642,20 @@ cib_remote_perform_op(cib_t * cib, const char *op, const char *host, const char
 
         crm_element_value_int(op_reply, F_CIB_CALLID, &reply_id);
 
-        if (reply_id == msg_id) {
+        if (reply_id == msg_id
+            && safe_str_eq(crm_element_value(op_reply, F_TYPE), T_CIB_NOTIFY) == FALSE) {
             break;
 
+        } else if (private->multiplexed) {
+            /* A notification or an asynchronous reply, deliver it later */
+            crm_trace("Queueing %s message received while waiting for call %d",
+                      crm_element_value(op_reply, F_TYPE), msg_id);
+            cib_remote_queue_msg(cib, op_reply);
+            mainloop_set_trigger(private->dispatch_trigger);
+            op_reply = NULL;
+            remaining_time = timeout - (time(NULL) - start_time);
+            continue;
+
         } else if (reply_id < msg_id) {
             crm_debug("Received old reply: %d (wanted %d)", reply_id, msg_id);
             crm_log_xml_trace(op_reply, "Old reply");
@@ -577,7 +672,7 @@ cib_remote_perform_op(cib_t * cib, const char *op, const char *host, const char
         op_reply = NULL;
 
         /* wasn't the right reply, try and read some more */
-        remaining_time = time(NULL) - start_time;
+        remaining_time = timeout - (time(NULL) - start_time);
     }
 
     /* if(IPC_ISRCONN(native->command_channel) == FALSE) { */
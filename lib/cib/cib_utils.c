@@ -266,6 +266,35 @@ createEmptyCib(int admin_epoch)
     return cib_root;
 }
 
+long long cib_op_phase_usec[cib_phase_max];
+
+const char *
+cib_op_phase_text(enum cib_op_phase phase)
+{
+    switch (phase) {
+        case cib_phase_apply:
+            return "apply";
+        case cib_phase_acl:
+            return "acl";
+        case cib_phase_diff:
+            return "diff";
+        case cib_phase_validate:
+            return "validate";
+        case cib_phase_digest:
+            return "digest";
+        case cib_phase_send:
+            return "send";
+        case cib_phase_notify:
+            return "notify";
+        case cib_phase_max:
+            break;
+    }
+    return "unknown";
+}
+
+#define cib_phase_begin(start) start = crm_monotonic_usec()
+#define cib_phase_end(phase, start) cib_op_phase_usec[phase] += crm_monotonic_usec() - start
+
 static bool
 cib_acl_enabled(xmlNode *xml, const char *user)
 {
@@ -303,8 +332,10 @@ cib_perform_op(const char *op, int call_options, cib_op_t * fn, gboolean is_quer
     static struct qb_log_callsite *diff_cs = NULL;
     const char *user = crm_element_value(req, F_CIB_USER);
     bool with_digest = FALSE;
+    long long start = 0;
 
     crm_trace("Begin %s%s op", is_query ? "read-only " : "", op);
+    memset(cib_op_phase_usec, 0, sizeof(cib_op_phase_usec));
 
     CRM_CHECK(output != NULL, return -ENOMSG);
     CRM_CHECK(result_cib != NULL, return -ENOMSG);
@@ -325,18 +356,23 @@ cib_perform_op(const char *op, int call_options, cib_op_t * fn, gboolean is_quer
         xmlNode *cib_ro = current_cib;
         xmlNode *cib_filtered = NULL;
 
+        cib_phase_begin(start);
         if(cib_acl_enabled(cib_ro, user)) {
             if(xml_acl_filtered_copy(user, current_cib, current_cib, &cib_filtered)) {
                 if (cib_filtered == NULL) {
                     crm_debug("Pre-filtered the entire cib");
+                    cib_phase_end(cib_phase_acl, start);
                     return -EACCES;
                 }
                 cib_ro = cib_filtered;
                 crm_log_xml_trace(cib_ro, "filtered");
             }
         }
+        cib_phase_end(cib_phase_acl, start);
 
+        cib_phase_begin(start);
         rc = (*fn) (op, call_options, section, req, input, cib_ro, result_cib, output);
+        cib_phase_end(cib_phase_apply, start);
 
         if(output == NULL || *output == NULL) {
             /* nothing */
@@ -371,18 +407,43 @@ cib_perform_op(const char *op, int call_options, cib_op_t * fn, gboolean is_quer
         copy_in_properties(current_cib, scratch);
         top = current_cib;
 
-        xml_track_changes(scratch, user, NULL, cib_acl_enabled(scratch, user));
+        xml_track_changes(scratch, user, NULL, FALSE);
+        if (cib_acl_enabled(scratch, user)) {
+            cib_phase_begin(start);
+            xml_acl_enforce(scratch, NULL, user);
+            cib_phase_end(cib_phase_acl, start);
+        }
+
+        cib_phase_begin(start);
         rc = (*fn) (op, call_options, section, req, input, scratch, &scratch, output);
+        cib_phase_end(cib_phase_apply, start);
 
     } else {
         scratch = copy_xml(current_cib);
-        xml_track_changes(scratch, user, NULL, cib_acl_enabled(scratch, user));
+
+        xml_track_changes(scratch, user, NULL, FALSE);
+        if (cib_acl_enabled(scratch, user)) {
+            cib_phase_begin(start);
+            xml_acl_enforce(scratch, NULL, user);
+            cib_phase_end(cib_phase_acl, start);
+        }
+
+        cib_phase_begin(start);
         rc = (*fn) (op, call_options, section, req, input, current_cib, &scratch, output);
+        cib_phase_end(cib_phase_apply, start);
 
         if(scratch && xml_tracking_changes(scratch) == FALSE) {
             crm_trace("Inferring changes after %s op", op);
-            xml_track_changes(scratch, user, current_cib, cib_acl_enabled(current_cib, user));
+            xml_track_changes(scratch, user, NULL, FALSE);
+            if (cib_acl_enabled(current_cib, user)) {
+                cib_phase_begin(start);
+                xml_acl_enforce(scratch, current_cib, user);
+                cib_phase_end(cib_phase_acl, start);
+            }
+
+            cib_phase_begin(start);
             xml_calculate_changes(current_cib, scratch);
+            cib_phase_end(cib_phase_diff, start);
         }
         CRM_CHECK(current_cib != scratch, return -EINVAL);
     }
@@ -444,6 +505,7 @@ cib_perform_op(const char *op, int call_options, cib_op_t * fn, gboolean is_quer
     strip_text_nodes(scratch);
     fix_plus_plus_recursive(scratch);
 
+    cib_phase_begin(start);
     if (is_set(call_options, cib_zero_copy)) {
         /* At this point, current_cib is just the 'cib' tag and its properties,
          *
@@ -466,13 +528,16 @@ cib_perform_op(const char *op, int call_options, cib_op_t * fn, gboolean is_quer
 
     xml_log_changes(LOG_TRACE, __FUNCTION__, scratch);
     xml_accept_changes(scratch);
+    cib_phase_end(cib_phase_diff, start);
 
     if (diff_cs == NULL) {
         diff_cs = qb_log_callsite_get(__PRETTY_FUNCTION__, __FILE__, "diff-validation", LOG_DEBUG, __LINE__, crm_trace_nonlog);
     }
 
     if(local_diff) {
+        cib_phase_begin(start);
         patchset_process_digest(local_diff, current_cib, scratch, with_digest);
+        cib_phase_end(cib_phase_digest, start);
 
         xml_log_patchset(LOG_INFO, __FUNCTION__, local_diff);
         crm_log_xml_trace(local_diff, "raw patch");
@@ -552,24 +617,28 @@ cib_perform_op(const char *op, int call_options, cib_op_t * fn, gboolean is_quer
     }
 
     crm_trace("Perform validation: %s", check_dtd ? "true" : "false");
+    cib_phase_begin(start);
     if (rc == pcmk_ok && check_dtd && validate_xml(scratch, NULL, TRUE) == FALSE) {
         const char *current_dtd = crm_element_value(scratch, XML_ATTR_VALIDATION);
 
         crm_warn("Updated CIB does not validate against %s schema/dtd", crm_str(current_dtd));
         rc = -pcmk_err_schema_validation;
     }
+    cib_phase_end(cib_phase_validate, start);
 
   done:
 
     *result_cib = scratch;
 #if ENABLE_ACL
     if(rc != pcmk_ok && cib_acl_enabled(current_cib, user)) {
+        cib_phase_begin(start);
         if(xml_acl_filtered_copy(user, current_cib, scratch, result_cib)) {
             if (*result_cib == NULL) {
                 crm_debug("Pre-filtered the entire cib result");
             }
             free_xml(scratch);
         }
+        cib_phase_end(cib_phase_acl, start);
     }
 #endif
 
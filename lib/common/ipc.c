@@ -284,6 +284,29 @@ crm_client_disconnect_all(qb_ipcs_service_t *service)
     }
 }
 
+struct crm_client_private_s {
+    GQueue *event_queue;
+    unsigned int queue_max;     /* Evict the client if its event backlog exceeds this */
+    unsigned int queue_peak;    /* Deepest the event backlog has been */
+};
+
+static unsigned int
+pick_ipc_queue_max(void)
+{
+    static unsigned int global_max = 0;
+
+    if (global_max == 0) {
+        const char *env = getenv("PCMK_ipc_queue_max");
+
+        global_max = crm_parse_int(env, "500");
+        if (global_max < 100) {
+            global_max = 100;
+        }
+    }
+
+    return global_max;
+}
+
 crm_client_t *
 crm_client_new(qb_ipcs_connection_t * c, uid_t uid_client, gid_t gid_client)
 {
@@ -341,6 +364,16 @@ crm_client_new(qb_ipcs_connection_t * c, uid_t uid_client, gid_t gid_client)
     return client;
 }
 
+static void
+crm_ipcs_free_event(gpointer data)
+{
+    struct iovec *event = data;
+
+    free(event[0].iov_base);
+    free(event[1].iov_base);
+    free(event);
+}
+
 void
 crm_client_destroy(crm_client_t * c)
 {
@@ -365,14 +398,15 @@ crm_client_destroy(crm_client_t * c)
         g_source_remove(c->event_timer);
     }
 
-    crm_debug("Destroying %d events", g_list_length(c->event_queue));
-    while (c->event_queue) {
-        struct iovec *event = c->event_queue->data;
+    if (c->private) {
+        GQueue *queue = c->private->event_queue;
 
-        c->event_queue = g_list_remove(c->event_queue, event);
-        free(event[0].iov_base);
-        free(event[1].iov_base);
-        free(event);
+        crm_debug("Destroying %d events", g_queue_get_length(queue));
+        while (g_queue_is_empty(queue) == FALSE) {
+            crm_ipcs_free_event(g_queue_pop_head(queue));
+        }
+        g_queue_free(queue);
+        free(c->private);
     }
 
     free(c->id);
@@ -388,6 +422,36 @@ crm_client_destroy(crm_client_t * c)
     free(c);
 }
 
+/*!
+ * \brief Number of events queued for a client but not yet accepted by it
+ *
+ * \param[in] c  Client to check
+ *
+ * \return Length of the client's event queue
+ */
+unsigned int
+crm_ipcs_event_backlog(crm_client_t * c)
+{
+    if (c == NULL || c->private == NULL) {
+        return 0;
+    }
+    return g_queue_get_length(c->private->event_queue);
+}
+
+/*!
+ * \brief Report how deep a client's event queue has been and may become
+ *
+ * \param[in]  c     Client to check
+ * \param[out] peak  Deepest the client's event queue has been
+ * \param[out] max   Depth at which the client will be evicted
+ */
+void
+crm_ipcs_event_limits(crm_client_t * c, unsigned int *peak, unsigned int *max)
+{
+    *peak = (c && c->private)? c->private->queue_peak : 0;
+    *max = (c && c->private)? c->private->queue_max : pick_ipc_queue_max();
+}
+
 int
 crm_ipcs_client_pid(qb_ipcs_connection_t * c)
 {
@@ -481,10 +545,10 @@ crm_ipcs_flush_events(crm_client_t * c)
         return pcmk_ok;
     }
 
-    queue_len = g_list_length(c->event_queue);
-    while (c->event_queue && sent < 100) {
+    queue_len = crm_ipcs_event_backlog(c);
+    while (queue_len > sent && sent < 100) {
         struct crm_ipc_response_header *header = NULL;
-        struct iovec *event = c->event_queue->data;
+        struct iovec *event = g_queue_peek_head(c->private->event_queue);
 
         rc = qb_ipcs_event_sendv(c->ipcs, event, 2);
         if (rc < 0) {
@@ -501,23 +565,21 @@ crm_ipcs_flush_events(crm_client_t * c)
                       header->qb.id, c->ipcs, c->pid, rc, event[1].iov_base);
         }
 
-        c->event_queue = g_list_remove(c->event_queue, event);
-        free(event[0].iov_base);
-        free(event[1].iov_base);
-        free(event);
+        g_queue_pop_head(c->private->event_queue);
+        crm_ipcs_free_event(event);
     }
 
     queue_len -= sent;
-    if (sent > 0 || c->event_queue) {
+    if (sent > 0 || queue_len) {
         crm_trace("Sent %d events (%d remaining) for %p[%d]: %s (%d)",
                   sent, queue_len, c->ipcs, c->pid, pcmk_strerror(rc < 0 ? rc : 0), rc);
     }
 
-    if (c->event_queue) {
+    if (queue_len) {
         if (queue_len % 100 == 0 && queue_len > 99) {
             crm_warn("Event queue for %p[%d] has grown to %d", c->ipcs, c->pid, queue_len);
 
-        } else if (queue_len > 500) {
+        } else if (queue_len > (int) c->private->queue_max) {
             crm_err("Evicting slow client %p[%d]: event queue reached %d entries",
                     c->ipcs, c->pid, queue_len);
             qb_ipcs_disconnect(c->ipcs);
@@ -530,14 +592,15 @@ crm_ipcs_flush_events(crm_client_t * c)
     return rc;
 }
 
-ssize_t
-crm_ipc_prepare(uint32_t request, xmlNode * message, struct iovec ** result, uint32_t max_send_size)
+/* Takes ownership of buffer */
+static ssize_t
+ipc_prepare_buffer(uint32_t request, char *buffer, unsigned int size, struct iovec ** result,
+                   uint32_t max_send_size)
 {
     static unsigned int biggest = 0;
     struct iovec *iov;
     unsigned int total = 0;
     char *compressed = NULL;
-    char *buffer = dump_xml_unformatted(message);
     struct crm_ipc_response_header *header = calloc(1, sizeof(struct crm_ipc_response_header));
 
     CRM_ASSERT(result != NULL);
@@ -558,7 +621,7 @@ crm_ipc_prepare(uint32_t request, xmlNode * message, struct iovec ** result, uin
     iov[0].iov_base = header;
 
     header->version = PCMK_IPC_VERSION;
-    header->size_uncompressed = 1 + strlen(buffer);
+    header->size_uncompressed = size;
     total = iov[0].iov_len + header->size_uncompressed;
 
     if (total < max_send_size) {
@@ -584,7 +647,6 @@ crm_ipc_prepare(uint32_t request, xmlNode * message, struct iovec ** result, uin
         } else {
             ssize_t rc = -EMSGSIZE;
 
-            crm_log_xml_trace(message, "EMSGSIZE");
             biggest = QB_MAX(header->size_uncompressed, biggest);
 
             crm_err
@@ -609,6 +671,18 @@ crm_ipc_prepare(uint32_t request, xmlNode * message, struct iovec ** result, uin
     return header->qb.size;
 }
 
+ssize_t
+crm_ipc_prepare(uint32_t request, xmlNode * message, struct iovec ** result, uint32_t max_send_size)
+{
+    char *buffer = dump_xml_unformatted(message);
+    ssize_t rc = ipc_prepare_buffer(request, buffer, 1 + strlen(buffer), result, max_send_size);
+
+    if (rc == -EMSGSIZE) {
+        crm_log_xml_trace(message, "EMSGSIZE");
+    }
+    return rc;
+}
+
 ssize_t
 crm_ipcs_sendv(crm_client_t * c, struct iovec * iov, enum crm_ipc_flags flags)
 {
@@ -630,9 +704,16 @@ crm_ipcs_sendv(crm_client_t * c, struct iovec * iov, enum crm_ipc_flags flags)
     if (flags & crm_ipc_server_event) {
         header->qb.id = id++;   /* We don't really use it, but doesn't hurt to set one */
 
+        if (c->private == NULL) {
+            c->private = calloc(1, sizeof(struct crm_client_private_s));
+            CRM_ASSERT(c->private != NULL);
+            c->private->event_queue = g_queue_new();
+            c->private->queue_max = pick_ipc_queue_max();
+        }
+
         if (flags & crm_ipc_server_free) {
             crm_trace("Sending the original to %p[%d]", c->ipcs, c->pid);
-            c->event_queue = g_list_append(c->event_queue, iov);
+            g_queue_push_tail(c->private->event_queue, iov);
 
         } else {
             struct iovec *iov_copy = calloc(2, sizeof(struct iovec));
@@ -646,9 +727,12 @@ crm_ipcs_sendv(crm_client_t * c, struct iovec * iov, enum crm_ipc_flags flags)
             iov_copy[1].iov_base = malloc(iov[1].iov_len);
             memcpy(iov_copy[1].iov_base, iov[1].iov_base, iov[1].iov_len);
 
-            c->event_queue = g_list_append(c->event_queue, iov_copy);
+            g_queue_push_tail(c->private->event_queue, iov_copy);
         }
 
+        c->private->queue_peak = QB_MAX(c->private->queue_peak,
+                                        g_queue_get_length(c->private->event_queue));
+
     } else {
         CRM_LOG_ASSERT(header->qb.id != 0);     /* Replying to a specific request */
 
@@ -706,6 +790,44 @@ crm_ipcs_send(crm_client_t * c, uint32_t request, xmlNode * message,
     return rc;
 }
 
+/*!
+ * \brief Send a message that isn't XML to an IPC client
+ *
+ * \param[in] c        Client to send to
+ * \param[in] request  Request being replied to (or 0 for events)
+ * \param[in] buffer   Message to send (will be freed)
+ * \param[in] size     Size of \p buffer in bytes
+ * \param[in] flags    How to send it
+ *
+ * \note The client receives \p buffer as is, so it must only be used for
+ *       message formats the client has said it understands
+ */
+ssize_t
+crm_ipcs_send_buffer(crm_client_t * c, uint32_t request, char *buffer, unsigned int size,
+                     enum crm_ipc_flags flags)
+{
+    struct iovec *iov = NULL;
+    ssize_t rc = 0;
+
+    if(c == NULL) {
+        free(buffer);
+        return -EDESTADDRREQ;
+    }
+    crm_ipc_init();
+
+    rc = ipc_prepare_buffer(request, buffer, size, &iov, ipc_buffer_max);
+    if (rc > 0) {
+        rc = crm_ipcs_sendv(c, iov, flags | crm_ipc_server_free);
+
+    } else {
+        free(iov);
+        crm_notice("Message to %p[%d] failed: %s (%d)",
+                   c->ipcs, c->pid, pcmk_strerror(rc), rc);
+    }
+
+    return rc;
+}
+
 void
 crm_ipcs_send_ack(crm_client_t * c, uint32_t request, uint32_t flags, const char *tag, const char *function,
                   int line)
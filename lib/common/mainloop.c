@@ -409,6 +409,7 @@ mainloop_cleanup(void)
     if(gio_map) {
         qb_array_free(gio_map);
     }
+    mainloop_wheel_cleanup();
 }
 
 /*
@@ -898,7 +899,7 @@ child_free(mainloop_child_t *child)
 {
     if (child->timerid != 0) {
         crm_trace("Removing timer %d", child->timerid);
-        g_source_remove(child->timerid);
+        mainloop_wheel_remove(child->timerid);
         child->timerid = 0;
     }
     free(child->desc);
@@ -948,7 +949,7 @@ child_timeout_callback(gpointer p)
     child->timeout = TRUE;
     crm_warn("%s process (PID %d) timed out", child->desc, (int)child->pid);
 
-    child->timerid = g_timeout_add(5000, child_timeout_callback, child);
+    child->timerid = mainloop_wheel_add(5000, 0, child_timeout_callback, child);
     return FALSE;
 }
 
@@ -1108,7 +1109,7 @@ mainloop_child_add_with_flags(pid_t pid, int timeout, const char *desc, void *pr
     }
 
     if (timeout) {
-        child->timerid = g_timeout_add(timeout, child_timeout_callback, child);
+        child->timerid = mainloop_wheel_add(timeout, 0, child_timeout_callback, child);
     }
 
     child_list = g_list_append(child_list, child);
@@ -1245,3 +1246,460 @@ mainloop_timer_del(mainloop_timer_t *t)
     }
 }
 
+
+/*
+ * Timer wheel
+ *
+ * GLib keeps its timeouts in a list sorted by expiry, and every one of them
+ * is a GSource the mainloop has to consider on each iteration, which is
+ * expensive when there are tens of thousands of them (one per recurring
+ * operation plus one per operation timeout).  The wheel instead hashes each
+ * timer into a slot by expiry tick: level 0 has a slot for each of the next
+ * WHEEL_SLOTS ticks, and each level above covers WHEEL_SLOTS times the range
+ * of the one below.  Timers are moved ("cascaded") down a level each time the
+ * level below wraps around, so adding, removing and firing a timer are all
+ * constant time, and the whole wheel is driven by a single GLib timeout.
+ *
+ * Timers are one-shot unless their callback returns TRUE, have a resolution
+ * of MAINLOOP_WHEEL_TICK_MS and never fire early.
+ */
+
+#define WHEEL_LEVELS    4
+#define WHEEL_BITS      8
+#define WHEEL_SLOTS     (1 << WHEEL_BITS)
+#define WHEEL_MASK      (WHEEL_SLOTS - 1)
+#define WHEEL_MAX_TICKS ((((guint64) 1) << (WHEEL_LEVELS * WHEEL_BITS)) - 1)
+
+/* Where a timer is when it isn't in a slot */
+#define WHEEL_RUNNING   -1      /* on the list of timers due this tick */
+#define WHEEL_FIRING    -2      /* its callback is being invoked */
+
+typedef struct wheel_timer_s {
+    guint id;
+    guint delay_ms;
+    guint jitter;               /* ticks it may be delayed by to spread the load */
+    guint64 expires;            /* tick */
+    GSourceFunc cb;             /* NULL once removed while firing */
+    gpointer userdata;
+
+    int level;
+    int slot;
+    GList *link;
+} wheel_timer_t;
+
+typedef struct mainloop_wheel_s {
+    guint64 next;               /* next tick to process */
+    guint64 wakeup;             /* tick the driving timeout is for */
+    guint source;               /* the driving timeout */
+    guint last_id;
+
+    GHashTable *timers;         /* id -> wheel_timer_t */
+    GList *slots[WHEEL_LEVELS][WHEEL_SLOTS];
+    guint counts[WHEEL_SLOTS];  /* timers in each level 0 slot */
+    guint pending[WHEEL_SLOTS]; /* timers due in the next turn of level 0 that
+                                 * are still on a higher level, by tick */
+    GList *running;             /* timers due on the tick being processed */
+
+    mainloop_wheel_stats_t stats;
+} mainloop_wheel_t;
+
+static mainloop_wheel_t *wheel = NULL;
+
+static guint64
+wheel_now(void)
+{
+    return crm_monotonic_usec() / (1000 * MAINLOOP_WHEEL_TICK_MS);
+}
+
+/* First tick of the next turn of level 0 (the next tick, if that starts one) */
+static guint64
+wheel_next_turn(void)
+{
+    return (wheel->next + WHEEL_MASK) & ~((guint64) WHEEL_MASK);
+}
+
+/* Number of timers due on a tick within one turn of level 0, on any level */
+static guint
+wheel_tick_count(guint64 tick)
+{
+    guint count = wheel->counts[tick & WHEEL_MASK];
+
+    if (tick >= wheel_next_turn()) {
+        count += wheel->pending[tick & WHEEL_MASK];
+    }
+    return count;
+}
+
+/* Account for a higher-level timer that is due in the next turn of level 0 */
+static void
+wheel_pending_update(wheel_timer_t * t, int change)
+{
+    guint64 turn = wheel_next_turn();
+
+    if (t->level > 0 && t->expires >= turn && t->expires < turn + WHEEL_SLOTS) {
+        wheel->pending[t->expires & WHEEL_MASK] += change;
+    }
+}
+
+/* Recount the timers that the next turn of level 0 will bring down */
+static void
+wheel_pending_refresh(void)
+{
+    int level = 0;
+    GList *gIter = NULL;
+    guint64 turn = wheel_next_turn();
+
+    memset(wheel->pending, 0, sizeof(wheel->pending));
+    for (level = 1; level < WHEEL_LEVELS; level++) {
+        int slot = (turn >> (WHEEL_BITS * level)) & WHEEL_MASK;
+
+        for (gIter = wheel->slots[level][slot]; gIter != NULL; gIter = gIter->next) {
+            wheel_pending_update(gIter->data, 1);
+        }
+    }
+}
+
+static void
+wheel_insert(wheel_timer_t * t)
+{
+    guint64 delta = 0;
+
+    if (t->expires < wheel->next) {
+        t->expires = wheel->next;
+    }
+    delta = t->expires - wheel->next;
+
+    if (delta < WHEEL_SLOTS && t->jitter > 0) {
+        /* Spread the load: use the least busy tick the timer is allowed to */
+        guint64 lpc = 0;
+        guint64 best = t->expires;
+        guint64 last = QB_MIN(t->expires + t->jitter, wheel->next + WHEEL_SLOTS - 1);
+
+        for (lpc = t->expires + 1; lpc <= last; lpc++) {
+            if (wheel_tick_count(lpc) < wheel_tick_count(best)) {
+                best = lpc;
+            }
+        }
+        t->expires = best;
+        t->jitter = 0;
+        delta = t->expires - wheel->next;
+
+    } else if (delta > WHEEL_MAX_TICKS) {
+        t->expires = wheel->next + WHEEL_MAX_TICKS;
+        delta = WHEEL_MAX_TICKS;
+    }
+
+    for (t->level = 0; t->level < WHEEL_LEVELS - 1; t->level++) {
+        if (delta < (((guint64) 1) << (WHEEL_BITS * (t->level + 1)))) {
+            break;
+        }
+    }
+
+    t->slot = (t->expires >> (WHEEL_BITS * t->level)) & WHEEL_MASK;
+    wheel->slots[t->level][t->slot] = g_list_prepend(wheel->slots[t->level][t->slot], t);
+    t->link = wheel->slots[t->level][t->slot];
+    if (t->level == 0) {
+        wheel->counts[t->slot]++;
+    } else {
+        wheel_pending_update(t, 1);
+    }
+}
+
+static void
+wheel_unlink(wheel_timer_t * t)
+{
+    if (t->level == WHEEL_RUNNING) {
+        wheel->running = g_list_delete_link(wheel->running, t->link);
+
+    } else if (t->level >= 0) {
+        wheel->slots[t->level][t->slot] = g_list_delete_link(wheel->slots[t->level][t->slot],
+                                                             t->link);
+        if (t->level == 0) {
+            wheel->counts[t->slot]--;
+        } else {
+            wheel_pending_update(t, -1);
+        }
+    }
+    t->link = NULL;
+}
+
+/* Re-hash the timers in a slot now that they are closer to expiring */
+static int
+wheel_cascade(int level, int slot)
+{
+    GList *timers = wheel->slots[level][slot];
+
+    wheel->slots[level][slot] = NULL;
+    while (timers != NULL) {
+        wheel_timer_t *t = timers->data;
+
+        timers = g_list_delete_link(timers, timers);
+        wheel_insert(t);
+    }
+    return slot;
+}
+
+static void
+wheel_run_tick(void)
+{
+    guint due = 0;
+    guint64 tick = wheel->next;
+    int slot = tick & WHEEL_MASK;
+    int level = 0;
+    GList *gIter = NULL;
+
+    /* When a level wraps, bring down the timers due in the next part of it */
+    for (level = 1; slot == 0 && level < WHEEL_LEVELS; level++) {
+        if (wheel_cascade(level, (tick >> (WHEEL_BITS * level)) & WHEEL_MASK) != 0) {
+            break;
+        }
+    }
+
+    wheel->running = wheel->slots[0][slot];
+    wheel->slots[0][slot] = NULL;
+    wheel->counts[slot] = 0;
+    for (gIter = wheel->running; gIter != NULL; gIter = gIter->next) {
+        ((wheel_timer_t *) gIter->data)->level = WHEEL_RUNNING;
+    }
+
+    /* Anything added by the callbacks belongs to later ticks */
+    wheel->next = tick + 1;
+    if (slot == 0) {
+        wheel_pending_refresh();
+    }
+
+    while (wheel->running != NULL) {
+        wheel_timer_t *t = wheel->running->data;
+        gboolean repeat = FALSE;
+
+        wheel->running = g_list_delete_link(wheel->running, wheel->running);
+        t->link = NULL;
+        t->level = WHEEL_FIRING;
+        due++;
+
+        repeat = t->cb(t->userdata);
+        if (repeat && t->cb != NULL) {
+            guint64 now_ms = crm_monotonic_usec() / 1000;
+
+            t->expires = (now_ms + t->delay_ms + MAINLOOP_WHEEL_TICK_MS - 1) / MAINLOOP_WHEEL_TICK_MS;
+            wheel_insert(t);
+
+        } else {
+            if (t->cb != NULL) {
+                g_hash_table_remove(wheel->timers, GUINT_TO_POINTER(t->id));
+            }
+            free(t);
+        }
+    }
+
+    if (due > 0) {
+        crm_trace("%u timers were due on tick %llu", due, (unsigned long long)tick);
+        wheel->stats.last_due = due;
+        wheel->stats.max_due = QB_MAX(wheel->stats.max_due, due);
+        wheel->stats.fired += due;
+        wheel->stats.busy_ticks++;
+    }
+}
+
+/* The next tick with work to do: one with timers due, or a cascade */
+static guint64
+wheel_next_due(void)
+{
+    guint64 tick = wheel->next;
+
+    while (wheel->slots[0][tick & WHEEL_MASK] == NULL && ((tick + 1) & WHEEL_MASK) != 0) {
+        tick++;
+    }
+    return (wheel->slots[0][tick & WHEEL_MASK] == NULL) ? tick + 1 : tick;
+}
+
+static gboolean wheel_dispatch(gpointer user_data);
+
+static void
+wheel_schedule(void)
+{
+    guint64 due = 0;
+    guint64 now = 0;
+
+    if (g_hash_table_size(wheel->timers) == 0) {
+        if (wheel->source != 0) {
+            g_source_remove(wheel->source);
+            wheel->source = 0;
+        }
+        return;
+    }
+
+    due = wheel_next_due();
+    if (wheel->source != 0) {
+        if (wheel->wakeup <= due) {
+            return;
+        }
+        g_source_remove(wheel->source);
+    }
+
+    now = wheel_now();
+    wheel->wakeup = due;
+    wheel->source = g_timeout_add((due > now) ? (due - now) * MAINLOOP_WHEEL_TICK_MS : 0,
+                                  wheel_dispatch, NULL);
+}
+
+static gboolean
+wheel_dispatch(gpointer user_data)
+{
+    guint64 now = wheel_now();
+
+    wheel->source = 0;
+    while (wheel->next <= now) {
+        wheel_run_tick();
+    }
+    wheel_schedule();
+    return FALSE;
+}
+
+/*!
+ * \brief Add a timer to the mainloop's timer wheel
+ *
+ * \param[in] delay_ms   How long to wait before invoking \p cb
+ * \param[in] jitter_ms  How much longer the timer may wait if that means fewer
+ *                       timers firing at once (for periodic work, such as
+ *                       recurring monitors, that need not be exact)
+ * \param[in] cb         Function to invoke, returning TRUE to be invoked
+ *                       again after another \p delay_ms
+ * \param[in] userdata   Argument for \p cb
+ *
+ * \return Id for mainloop_wheel_remove() (never 0)
+ */
+guint
+mainloop_wheel_add(guint delay_ms, guint jitter_ms, GSourceFunc cb, gpointer userdata)
+{
+    guint64 now_ms = crm_monotonic_usec() / 1000;
+    wheel_timer_t *t = calloc(1, sizeof(wheel_timer_t));
+
+    CRM_ASSERT(t != NULL && cb != NULL);
+
+    if (wheel == NULL) {
+        wheel = calloc(1, sizeof(mainloop_wheel_t));
+        wheel->timers = g_hash_table_new(g_direct_hash, g_direct_equal);
+    }
+
+    if (g_hash_table_size(wheel->timers) == 0 && wheel->next < wheel_now()) {
+        /* The wheel stops turning when there is nothing on it */
+        wheel->next = wheel_now();
+    }
+
+    do {
+        t->id = ++wheel->last_id;
+    } while (t->id == 0 || g_hash_table_lookup(wheel->timers, GUINT_TO_POINTER(t->id)));
+
+    t->delay_ms = delay_ms;
+    t->jitter = jitter_ms / MAINLOOP_WHEEL_TICK_MS;
+    t->expires = (now_ms + delay_ms + MAINLOOP_WHEEL_TICK_MS - 1) / MAINLOOP_WHEEL_TICK_MS;
+    t->cb = cb;
+    t->userdata = userdata;
+
+    g_hash_table_insert(wheel->timers, GUINT_TO_POINTER(t->id), t);
+    wheel_insert(t);
+    wheel_schedule();
+    return t->id;
+}
+
+/*!
+ * \brief Remove a timer from the mainloop's timer wheel
+ *
+ * \param[in] id  Id returned by mainloop_wheel_add()
+ *
+ * \return TRUE if the timer was found (it is safe to remove a timer from
+ *         within its own callback)
+ */
+gboolean
+mainloop_wheel_remove(guint id)
+{
+    wheel_timer_t *t = NULL;
+
+    if (wheel == NULL || id == 0) {
+        return FALSE;
+    }
+
+    t = g_hash_table_lookup(wheel->timers, GUINT_TO_POINTER(id));
+    if (t == NULL) {
+        return FALSE;
+    }
+
+    g_hash_table_remove(wheel->timers, GUINT_TO_POINTER(id));
+    if (t->level == WHEEL_FIRING) {
+        /* Freed once the callback returns */
+        t->cb = NULL;
+    } else {
+        wheel_unlink(t);
+        free(t);
+    }
+    wheel_schedule();
+    return TRUE;
+}
+
+/*!
+ * \brief Count the timers due to fire within a given time
+ *
+ * \param[in]  within_ms  How far ahead to look (at most one turn of level 0)
+ * \param[out] counts     If not NULL, the number due on each tick (must have
+ *                        room for within_ms / MAINLOOP_WHEEL_TICK_MS + 1)
+ *
+ * \return Number of timers due
+ */
+guint
+mainloop_wheel_due(guint within_ms, guint * counts)
+{
+    guint due = 0;
+    guint64 lpc = 0;
+    guint64 ticks = within_ms / MAINLOOP_WHEEL_TICK_MS;
+
+    if (wheel == NULL) {
+        return 0;
+    }
+
+    ticks = QB_MIN(ticks, WHEEL_SLOTS - 1);
+    for (lpc = 0; lpc <= ticks; lpc++) {
+        guint count = wheel_tick_count(wheel->next + lpc);
+
+        if (counts) {
+            counts[lpc] = count;
+        }
+        due += count;
+    }
+    return due;
+}
+
+void
+mainloop_wheel_stats(mainloop_wheel_stats_t * stats)
+{
+    if (wheel == NULL) {
+        memset(stats, 0, sizeof(mainloop_wheel_stats_t));
+        return;
+    }
+
+    *stats = wheel->stats;
+    stats->timers = g_hash_table_size(wheel->timers);
+}
+
+void
+mainloop_wheel_cleanup(void)
+{
+    int level = 0;
+    int slot = 0;
+
+    if (wheel == NULL) {
+        return;
+    }
+
+    if (wheel->source != 0) {
+        g_source_remove(wheel->source);
+    }
+    for (level = 0; level < WHEEL_LEVELS; level++) {
+        for (slot = 0; slot < WHEEL_SLOTS; slot++) {
+            g_list_free_full(wheel->slots[level][slot], free);
+        }
+    }
+    g_hash_table_destroy(wheel->timers);
+    free(wheel);
+    wheel = NULL;
+}
@@ -2362,6 +2362,24 @@ crm_compress_string(const char *data, int length, int max, char **result, unsign
     return TRUE;
 }
 
+/*!
+ * \brief Read a monotonic clock suitable for measuring intervals
+ *
+ * \return Elapsed time in microseconds since an arbitrary starting point
+ */
+long long
+crm_monotonic_usec(void)
+{
+#ifdef CLOCK_MONOTONIC
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec * 1000000LL) + (now.tv_nsec / 1000);
+#else
+    return time(NULL) * 1000000LL;
+#endif
+}
+
 #ifdef HAVE_GNUTLS_GNUTLS_H
 void
 crm_gnutls_global_init(void)
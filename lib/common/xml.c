@@ -1093,6 +1093,25 @@ xml_acl_enabled(xmlNode *xml)
     return FALSE;
 }
 
+/*!
+ * \internal
+ * \brief Unpack and apply the ACLs for a user to a document being tracked
+ *
+ * \param[in] xml         Document whose changes are being tracked
+ * \param[in] acl_source  Document to take the ACL definitions from (or NULL for xml)
+ * \param[in] user        User the changes are being made as
+ */
+void
+xml_acl_enforce(xmlNode * xml, xmlNode *acl_source, const char *user)
+{
+    if(acl_source == NULL) {
+        acl_source = xml;
+    }
+    set_doc_flag(xml, xpf_acl_enabled);
+    __xml_acl_unpack(acl_source, xml, user);
+    __xml_acl_apply(xml);
+}
+
 void
 xml_track_changes(xmlNode * xml, const char *user, xmlNode *acl_source, bool enforce_acls) 
 {
@@ -1100,12 +1119,7 @@ xml_track_changes(xmlNode * xml, const char *user, xmlNode *acl_source, bool enf
     crm_trace("Tracking changes%s to %p", enforce_acls?" with ACLs":"", xml);
     set_doc_flag(xml, xpf_tracking);
     if(enforce_acls) {
-        if(acl_source == NULL) {
-            acl_source = xml;
-        }
-        set_doc_flag(xml, xpf_acl_enabled);
-        __xml_acl_unpack(acl_source, xml, user);
-        __xml_acl_apply(xml);
+        xml_acl_enforce(xml, acl_source, user);
     }
 }
 
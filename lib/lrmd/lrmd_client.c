@@ -28,6 +28,7 @@
 
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/stat.h>
 
 #include <glib.h>
 #include <dirent.h>
@@ -94,6 +95,9 @@ typedef struct lrmd_private_s {
     /* while the async connection is occuring, this is the id
      * of the connection timeout timer. */
     int async_timer;
+    /* while the async tls handshake is occuring, this is the id of the
+     * watch waiting for the socket to become ready */
+    guint handshake_watch;
     int sock;
     /* since tls requires a round trip across the network for a
      * request/reply, there are times where we just want to be able
@@ -242,6 +246,207 @@ lrmd_free_event(lrmd_event_data_t * event)
     free(event);
 }
 
+/*
+ * Packed operation results are a uint32_t total size, the integer fields of
+ * the event in the order below, a uint32_t parameter count, and then the
+ * strings (the event's, then each parameter's name and value).  Each string
+ * is a uint32_t length including the terminating NUL (0 for NULL) followed by
+ * the string itself, so they can be used where they are when unpacking.
+ *
+ * Both ends are on the same host, so native byte order is used throughout.
+ */
+
+#define LRMD_PACK_INTS 11
+
+static unsigned int
+pack_str_size(const char *str)
+{
+    return sizeof(uint32_t) + (str? strlen(str) + 1 : 0);
+}
+
+static char *
+pack_str(char *offset, const char *str)
+{
+    uint32_t len = str? strlen(str) + 1 : 0;
+
+    memcpy(offset, &len, sizeof(len));
+    offset += sizeof(len);
+    if (len) {
+        memcpy(offset, str, len);
+        offset += len;
+    }
+    return offset;
+}
+
+static const char *
+unpack_str(const char **offset, const char *end)
+{
+    uint32_t len = 0;
+    const char *str = NULL;
+
+    if (*offset == NULL || *offset + sizeof(len) > end) {
+        *offset = NULL;
+        return NULL;
+    }
+
+    memcpy(&len, *offset, sizeof(len));
+    *offset += sizeof(len);
+    if (len == 0) {
+        return NULL;
+
+    } else if (*offset + len > end || (*offset)[len - 1] != 0) {
+        *offset = NULL;
+        return NULL;
+    }
+
+    str = *offset;
+    *offset += len;
+    return str;
+}
+
+/*!
+ * \internal
+ * \brief Pack the result of an operation for a local client
+ *
+ * \param[in]  event  Operation result (parameters with no value are skipped)
+ * \param[out] size   Size of the packed result in bytes
+ *
+ * \return Newly allocated packed result
+ */
+char *
+lrmd_event_pack(lrmd_event_data_t * event, unsigned int *size)
+{
+    int32_t ints[LRMD_PACK_INTS] = {
+        event->call_id, event->timeout, event->interval, event->start_delay, event->rc,
+        event->op_status, event->rsc_deleted, event->t_run, event->t_rcchange,
+        event->exec_time, event->queue_time
+    };
+    uint32_t total = sizeof(uint32_t) + sizeof(ints) + sizeof(uint32_t);
+    uint32_t nparams = 0;
+    char *packed = NULL;
+    char *offset = NULL;
+    GHashTableIter iter;
+    const char *key = NULL;
+    const char *value = NULL;
+
+    total += pack_str_size(event->rsc_id) + pack_str_size(event->op_type)
+        + pack_str_size(event->user_data) + pack_str_size(event->output)
+        + pack_str_size(event->exit_reason);
+
+    if (event->params) {
+        g_hash_table_iter_init(&iter, event->params);
+        while (g_hash_table_iter_next(&iter, (gpointer *) & key, (gpointer *) & value)) {
+            if (value) {
+                total += pack_str_size(key) + pack_str_size(value);
+                nparams++;
+            }
+        }
+    }
+
+    packed = malloc(total);
+    CRM_ASSERT(packed != NULL);
+
+    memcpy(packed, &total, sizeof(total));
+    offset = packed + sizeof(total);
+    memcpy(offset, ints, sizeof(ints));
+    offset += sizeof(ints);
+    memcpy(offset, &nparams, sizeof(nparams));
+    offset += sizeof(nparams);
+
+    offset = pack_str(offset, event->rsc_id);
+    offset = pack_str(offset, event->op_type);
+    offset = pack_str(offset, event->user_data);
+    offset = pack_str(offset, event->output);
+    offset = pack_str(offset, event->exit_reason);
+
+    if (nparams) {
+        g_hash_table_iter_init(&iter, event->params);
+        while (g_hash_table_iter_next(&iter, (gpointer *) & key, (gpointer *) & value)) {
+            if (value) {
+                offset = pack_str(offset, key);
+                offset = pack_str(offset, value);
+            }
+        }
+    }
+
+    CRM_ASSERT(offset == packed + total);
+    *size = total;
+    return packed;
+}
+
+static int
+lrmd_dispatch_binary(lrmd_t * lrmd, const char *buffer, ssize_t length)
+{
+    lrmd_private_t *native = lrmd->private;
+    const char *end = buffer + length;
+    const char *record = buffer + LRMD_BINARY_MAGIC_LEN;
+    const unsigned int fixed = sizeof(uint32_t) + LRMD_PACK_INTS * sizeof(int32_t) + sizeof(uint32_t);
+
+    while (record < end) {
+        int32_t ints[LRMD_PACK_INTS];
+        uint32_t size = 0;
+        uint32_t nparams = 0;
+        const char *offset = NULL;
+        lrmd_event_data_t event = { 0, };
+
+        if (record + fixed <= end) {
+            memcpy(&size, record, sizeof(size));
+        }
+        if (size < fixed || record + size > end) {
+            crm_err("Discarding %d bytes of malformed operation results", (int)(end - record));
+            break;
+        }
+
+        offset = record + sizeof(size);
+        memcpy(ints, offset, sizeof(ints));
+        offset += sizeof(ints);
+        memcpy(&nparams, offset, sizeof(nparams));
+        offset += sizeof(nparams);
+
+        event.type = lrmd_event_exec_complete;
+        event.remote_nodename = native->remote_nodename;
+        event.call_id = ints[0];
+        event.timeout = ints[1];
+        event.interval = ints[2];
+        event.start_delay = ints[3];
+        event.rc = ints[4];
+        event.op_status = ints[5];
+        event.rsc_deleted = ints[6];
+        event.t_run = ints[7];
+        event.t_rcchange = ints[8];
+        event.exec_time = ints[9];
+        event.queue_time = ints[10];
+
+        event.rsc_id = unpack_str(&offset, record + size);
+        event.op_type = unpack_str(&offset, record + size);
+        event.user_data = unpack_str(&offset, record + size);
+        event.output = unpack_str(&offset, record + size);
+        event.exit_reason = unpack_str(&offset, record + size);
+
+        event.params = g_hash_table_new_full(crm_str_hash, g_str_equal,
+                                             g_hash_destroy_str, g_hash_destroy_str);
+        for (; nparams > 0 && offset != NULL; nparams--) {
+            const char *key = unpack_str(&offset, record + size);
+            const char *value = unpack_str(&offset, record + size);
+
+            if (key && value) {
+                g_hash_table_insert(event.params, strdup(key), strdup(value));
+            }
+        }
+
+        if (offset == NULL) {
+            crm_err("Discarding malformed result of call %d", event.call_id);
+        } else {
+            crm_trace("Packed result of call %d received", event.call_id);
+            native->callback(&event);
+        }
+
+        g_hash_table_destroy(event.params);
+        record += size;
+    }
+    return 1;
+}
+
 static int
 lrmd_dispatch_internal(lrmd_t * lrmd, xmlNode * msg)
 {
@@ -260,8 +465,17 @@ lrmd_dispatch_internal(lrmd_t * lrmd, xmlNode * msg)
         return 1;
     }
 
-    event.remote_nodename = native->remote_nodename;
     type = crm_element_value(msg, F_LRMD_OPERATION);
+    if (crm_str_eq(type, LRMD_OP_NOTIFY_BATCH, TRUE)) {
+        xmlNode *child = NULL;
+
+        for (child = __xml_first_child(msg); child != NULL; child = __xml_next(child)) {
+            lrmd_dispatch_internal(lrmd, child);
+        }
+        return 1;
+    }
+
+    event.remote_nodename = native->remote_nodename;
     crm_element_value_int(msg, F_LRMD_CALLID, &event.call_id);
     event.rsc_id = crm_element_value(msg, F_LRMD_RSC_ID);
 
@@ -317,6 +531,10 @@ lrmd_ipc_dispatch(const char *buffer, ssize_t length, gpointer userdata)
     if (!native->callback) {
         /* no callback set */
         return 1;
+
+    } else if (length >= LRMD_BINARY_MAGIC_LEN
+               && memcmp(buffer, LRMD_BINARY_MAGIC, LRMD_BINARY_MAGIC_LEN) == 0) {
+        return lrmd_dispatch_binary(lrmd, buffer, length);
     }
 
     msg = string2xml(buffer);
@@ -448,10 +666,12 @@ lrmd_dispatch(lrmd_t * lrmd)
     switch (private->type) {
         case CRM_CLIENT_IPC:
             while (crm_ipc_ready(private->ipc)) {
-                if (crm_ipc_read(private->ipc) > 0) {
+                long length = crm_ipc_read(private->ipc);
+
+                if (length > 0) {
                     const char *msg = crm_ipc_buffer(private->ipc);
 
-                    lrmd_ipc_dispatch(msg, strlen(msg), lrmd);
+                    lrmd_ipc_dispatch(msg, length, lrmd);
                 }
             }
             break;
@@ -892,6 +1112,16 @@ lrmd_handshake(lrmd_t * lrmd, const char *name)
     crm_xml_add(hello, F_LRMD_OPERATION, CRM_OP_REGISTER);
     crm_xml_add(hello, F_LRMD_CLIENTNAME, name);
     crm_xml_add(hello, F_LRMD_PROTOCOL_VERSION, LRMD_PROTOCOL_VERSION);
+    crm_xml_add(hello, F_LRMD_BATCH_NOTIFY, XML_BOOLEAN_TRUE);
+
+    /* Results from the local lrmd needn't be XML */
+    if (native->type == CRM_CLIENT_IPC) {
+        const char *binary = daemon_option("lrmd_binary_notify");
+
+        if (binary == NULL || crm_is_true(binary)) {
+            crm_xml_add(hello, F_LRMD_BINARY_NOTIFY, XML_BOOLEAN_TRUE);
+        }
+    }
 
     /* advertise that we are a proxy provider */
     if (native->proxy_callback) {
@@ -1102,15 +1332,119 @@ report_async_connection_result(lrmd_t * lrmd, int rc)
 
 #ifdef HAVE_GNUTLS_GNUTLS_H
 static void
-lrmd_tcp_connect_cb(void *userdata, int sock)
+lrmd_tls_connect_complete(lrmd_t * lrmd)
 {
-    lrmd_t *lrmd = userdata;
     lrmd_private_t *native = lrmd->private;
     char name[256] = { 0, };
     static struct mainloop_fd_callbacks lrmd_tls_callbacks = {
         .dispatch = lrmd_tls_dispatch,
         .destroy = lrmd_tls_connection_destroy,
     };
+    int rc = pcmk_ok;
+
+    crm_info("Remote lrmd client TLS connection established with server %s:%d", native->server,
+             native->port);
+
+    snprintf(name, 128, "remote-lrmd-%s:%d", native->server, native->port);
+
+    native->process_notify = mainloop_add_trigger(G_PRIORITY_HIGH, lrmd_tls_dispatch, lrmd);
+    native->source =
+        mainloop_add_fd(name, G_PRIORITY_HIGH, native->sock, lrmd, &lrmd_tls_callbacks);
+
+    rc = lrmd_handshake(lrmd, name);
+    report_async_connection_result(lrmd, rc);
+}
+
+static void
+lrmd_tls_handshake_failed(lrmd_t * lrmd)
+{
+    lrmd_private_t *native = lrmd->private;
+
+    gnutls_deinit(*native->remote->tls_session);
+    gnutls_free(native->remote->tls_session);
+    native->remote->tls_session = NULL;
+    lrmd_tls_connection_destroy(lrmd);
+    report_async_connection_result(lrmd, -1);
+}
+
+static gboolean lrmd_tls_handshake_dispatch(GIOChannel * source, GIOCondition condition,
+                                            gpointer userdata);
+
+/*!
+ * \internal
+ * \brief Advance an asynchronous TLS handshake as far as possible without blocking
+ *
+ * Once the handshake completes or fails, the connection result is reported
+ * to the client's callback.  Until then, the handshake is resumed whenever
+ * the socket is ready in the direction gnutls is waiting for, so any number
+ * of handshakes can be in progress at once.
+ */
+static void
+lrmd_tls_handshake_continue(lrmd_t * lrmd)
+{
+    lrmd_private_t *native = lrmd->private;
+    int rc = gnutls_handshake(*native->remote->tls_session);
+
+    if (rc == GNUTLS_E_INTERRUPTED || rc == GNUTLS_E_AGAIN) {
+        GIOChannel *channel = g_io_channel_unix_new(native->sock);
+        GIOCondition cond = gnutls_record_get_direction(*native->remote->tls_session) ?
+            G_IO_OUT : G_IO_IN;
+
+        native->handshake_watch = g_io_add_watch(channel, cond | G_IO_ERR | G_IO_HUP,
+                                                 lrmd_tls_handshake_dispatch, lrmd);
+        g_io_channel_unref(channel);
+        return;
+    }
+
+    if (native->async_timer) {
+        g_source_remove(native->async_timer);
+        native->async_timer = 0;
+    }
+
+    if (rc < 0) {
+        crm_warn("Client tls handshake failed for server %s:%d: %s. Disconnecting",
+                 native->server, native->port, gnutls_strerror(rc));
+        lrmd_tls_handshake_failed(lrmd);
+        return;
+    }
+
+    lrmd_tls_connect_complete(lrmd);
+}
+
+static gboolean
+lrmd_tls_handshake_dispatch(GIOChannel * source, GIOCondition condition, gpointer userdata)
+{
+    lrmd_t *lrmd = userdata;
+    lrmd_private_t *native = lrmd->private;
+
+    native->handshake_watch = 0;
+    lrmd_tls_handshake_continue(lrmd);
+    return FALSE;
+}
+
+static gboolean
+lrmd_tls_handshake_timeout(gpointer userdata)
+{
+    lrmd_t *lrmd = userdata;
+    lrmd_private_t *native = lrmd->private;
+
+    native->async_timer = 0;
+    if (native->handshake_watch) {
+        g_source_remove(native->handshake_watch);
+        native->handshake_watch = 0;
+    }
+
+    crm_warn("Client tls handshake with server %s:%d timed out. Disconnecting",
+             native->server, native->port);
+    lrmd_tls_handshake_failed(lrmd);
+    return FALSE;
+}
+
+static void
+lrmd_tcp_connect_cb(void *userdata, int sock)
+{
+    lrmd_t *lrmd = userdata;
+    lrmd_private_t *native = lrmd->private;
     int rc = sock;
     gnutls_datum_t psk_key = { NULL, 0 };
 
@@ -1138,30 +1472,10 @@ lrmd_tcp_connect_cb(void *userdata, int sock)
 
     native->remote->tls_session = create_psk_tls_session(sock, GNUTLS_CLIENT, native->psk_cred_c);
 
-    if (crm_initiate_client_tls_handshake(native->remote, LRMD_CLIENT_HANDSHAKE_TIMEOUT) != 0) {
-        crm_warn("Client tls handshake failed for server %s:%d. Disconnecting", native->server,
-                 native->port);
-        gnutls_deinit(*native->remote->tls_session);
-        gnutls_free(native->remote->tls_session);
-        native->remote->tls_session = NULL;
-        lrmd_tls_connection_destroy(lrmd);
-        report_async_connection_result(lrmd, -1);
-        return;
-    }
-
-    crm_info("Remote lrmd client TLS connection established with server %s:%d", native->server,
-             native->port);
-
-    snprintf(name, 128, "remote-lrmd-%s:%d", native->server, native->port);
-
-    native->process_notify = mainloop_add_trigger(G_PRIORITY_HIGH, lrmd_tls_dispatch, lrmd);
-    native->source =
-        mainloop_add_fd(name, G_PRIORITY_HIGH, native->sock, lrmd, &lrmd_tls_callbacks);
-
-    rc = lrmd_handshake(lrmd, name);
-    report_async_connection_result(lrmd, rc);
-
-    return;
+    /* Don't block the mainloop (and every other connection) while the server responds */
+    native->async_timer = g_timeout_add(LRMD_CLIENT_HANDSHAKE_TIMEOUT, lrmd_tls_handshake_timeout,
+                                        lrmd);
+    lrmd_tls_handshake_continue(lrmd);
 }
 
 static int
@@ -1348,6 +1662,11 @@ lrmd_tls_disconnect(lrmd_t * lrmd)
         native->async_timer = 0;
     }
 
+    if (native->handshake_watch) {
+        g_source_remove(native->handshake_watch);
+        native->handshake_watch = 0;
+    }
+
     if (native->source != NULL) {
         /* Attached to mainloop */
         mainloop_del_ipc_client(native->source);
@@ -1504,6 +1823,32 @@ lrmd_api_get_rsc_info(lrmd_t * lrmd, const char *rsc_id, enum lrmd_call_options
     return rsc_info;
 }
 
+static int
+lrmd_api_get_stats(lrmd_t * lrmd, xmlNode ** stats)
+{
+    int rc = pcmk_ok;
+    xmlNode *output = NULL;
+    xmlNode *data = create_xml_node(NULL, F_LRMD_RSC);
+
+    crm_xml_add(data, F_LRMD_ORIGIN, __FUNCTION__);
+    rc = lrmd_send_command(lrmd, LRMD_OP_STATS, data, &output, 0, 0, TRUE);
+    free_xml(data);
+
+    *stats = NULL;
+    if (rc == pcmk_ok) {
+        xmlNode *xml = first_named_child(output, "lrmd_stats");
+
+        if (xml) {
+            *stats = copy_xml(xml);
+        } else {
+            rc = -ENOMSG;
+        }
+    }
+
+    free_xml(output);
+    return rc;
+}
+
 static void
 lrmd_api_set_callback(lrmd_t * lrmd, lrmd_event_callback callback)
 {
@@ -1860,10 +2205,136 @@ heartbeat_get_metadata(const char *type, char **output)
 }
 #endif
 
+/*
+ * Metadata for OCF agents is cached on disk, so that it isn't regenerated by
+ * every process that wants it (the crmd, crm_resource, ...) nor every time one
+ * restarts.  Each agent has a file named after its path, which is only used
+ * while the agent's path, modification time and size match its first line.
+ */
+
+static char *
+metadata_agent_path(const char *standard, const char *provider, const char *type)
+{
+    if (safe_str_neq(standard, "ocf") || provider == NULL || type == NULL
+        || strchr(provider, '/') || strchr(type, '/')) {
+        return NULL;
+    }
+    return crm_strdup_printf("%s/resource.d/%s/%s", OCF_ROOT_DIR, provider, type);
+}
+
+static char *
+metadata_cache_file(const char *path)
+{
+    char *file = crm_strdup_printf("%s/%s.xml", CRM_METADATA_DIR, path + 1);
+    char *c = file + strlen(CRM_METADATA_DIR) + 1;
+
+    for (; *c; c++) {
+        if (*c == '/') {
+            *c = '_';
+        }
+    }
+    return file;
+}
+
+static char *
+metadata_cache_header(const char *path)
+{
+    struct stat sb;
+
+    if (stat(path, &sb) < 0) {
+        return NULL;
+    }
+    return crm_strdup_printf("%s %lld %lld\n", path, (long long)sb.st_mtime,
+                             (long long)sb.st_size);
+}
+
+static char *
+metadata_cache_get(const char *standard, const char *provider, const char *type)
+{
+    char *metadata = NULL;
+    char *file = NULL;
+    char *header = NULL;
+    char *contents = NULL;
+    char *path = metadata_agent_path(standard, provider, type);
+
+    if (path == NULL) {
+        return NULL;
+    }
+
+    header = metadata_cache_header(path);
+    if (header) {
+        file = metadata_cache_file(path);
+        contents = crm_read_contents(file);
+    }
+
+    if (contents && strncmp(contents, header, strlen(header)) == 0
+        && contents[strlen(header)] != 0) {
+        crm_trace("Using metadata for %s cached in %s", path, file);
+        metadata = strdup(contents + strlen(header));
+    }
+
+    free(contents);
+    free(header);
+    free(file);
+    free(path);
+    return metadata;
+}
+
+static void
+metadata_cache_put(const char *standard, const char *provider, const char *type,
+                   const char *metadata)
+{
+    int fd = -1;
+    char *tmp = NULL;
+    char *file = NULL;
+    char *header = NULL;
+    char *contents = NULL;
+    char *path = metadata_agent_path(standard, provider, type);
+
+    if (path == NULL || (header = metadata_cache_header(path)) == NULL) {
+        goto done;
+    }
+
+    file = metadata_cache_file(path);
+    tmp = crm_strdup_printf("%s.XXXXXX", file);
+    fd = mkstemp(tmp);
+    if (fd < 0) {
+        /* Not fatal, we may simply not have write access */
+        crm_trace("Could not cache metadata for %s: %s", path, pcmk_strerror(errno));
+        goto done;
+    }
+
+    /* Metadata is public, and readers may run as a different user */
+    fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+    contents = crm_strdup_printf("%s%s", header, metadata);
+    if (crm_write_sync(fd, contents) < 0 || rename(tmp, file) < 0) {
+        crm_debug("Could not cache metadata for %s in %s: %s",
+                  path, file, pcmk_strerror(errno));
+        unlink(tmp);
+    } else {
+        crm_trace("Cached metadata for %s in %s", path, file);
+    }
+
+  done:
+    free(contents);
+    free(header);
+    free(file);
+    free(tmp);
+    free(path);
+}
+
 static int
 generic_get_metadata(const char *standard, const char *provider, const char *type, char **output)
 {
-    svc_action_t *action = resources_action_create(type,
+    svc_action_t *action = NULL;
+
+    *output = metadata_cache_get(standard, provider, type);
+    if (*output) {
+        return pcmk_ok;
+    }
+
+    action = resources_action_create(type,
                                                    standard,
                                                    provider,
                                                    type,
@@ -1886,6 +2357,7 @@ generic_get_metadata(const char *standard, const char *provider, const char *typ
     }
 
     *output = strdup(action->stdout_data);
+    metadata_cache_put(standard, provider, type, *output);
     services_action_free(action);
 
     return pcmk_ok;
@@ -1921,6 +2393,93 @@ lrmd_api_get_metadata(lrmd_t * lrmd,
     return generic_get_metadata(class, provider, type, output);
 }
 
+typedef struct metadata_request_s {
+    char *standard;
+    char *provider;
+    char *type;
+    lrmd_metadata_callback callback;
+    void *user_data;
+} metadata_request_t;
+
+static void
+metadata_request_free(metadata_request_t * request)
+{
+    free(request->standard);
+    free(request->provider);
+    free(request->type);
+    free(request);
+}
+
+static void
+metadata_async_complete(svc_action_t * action)
+{
+    int rc = pcmk_ok;
+    metadata_request_t *request = action->cb_data;
+
+    if (action->status != PCMK_LRM_OP_DONE || action->rc != PCMK_OCF_OK
+        || action->stdout_data == NULL) {
+        crm_err("Failed to retrieve meta-data for %s:%s:%s",
+                request->standard, request->provider, request->type);
+        rc = -EIO;
+
+    } else {
+        metadata_cache_put(request->standard, request->provider, request->type,
+                           action->stdout_data);
+    }
+
+    request->callback(rc, (rc == pcmk_ok)? action->stdout_data : NULL, request->user_data);
+    metadata_request_free(request);
+    action->cb_data = NULL;
+}
+
+int
+lrmd_get_metadata_async(const char *class, const char *provider, const char *type,
+                        lrmd_metadata_callback callback, void *user_data)
+{
+    char *output = NULL;
+    svc_action_t *action = NULL;
+    metadata_request_t *request = NULL;
+
+    if (!class || !type || !callback) {
+        return -EINVAL;
+    }
+
+    if (safe_str_neq(class, "ocf")
+        || (output = metadata_cache_get(class, provider, type)) != NULL) {
+        /* Other classes rarely need to run anything (and never anything slow) */
+        int rc = pcmk_ok;
+
+        if (output == NULL) {
+            rc = lrmd_api_get_metadata(NULL, class, provider, type, &output, 0);
+        }
+        callback(rc, output, user_data);
+        free(output);
+        return pcmk_ok;
+    }
+
+    action = resources_action_create(type, class, provider, type, "meta-data", 0, 30000,
+                                     NULL, 0);
+    if (action == NULL) {
+        return -EINVAL;
+    }
+
+    request = calloc(1, sizeof(metadata_request_t));
+    request->standard = strdup(class);
+    request->provider = provider ? strdup(provider) : NULL;
+    request->type = strdup(type);
+    request->callback = callback;
+    request->user_data = user_data;
+    action->cb_data = request;
+
+    if (services_action_async(action, metadata_async_complete) == FALSE) {
+        crm_err("Failed to retrieve meta-data for %s:%s:%s", class, provider, type);
+        metadata_request_free(request);
+        services_action_free(action);
+        return -EIO;
+    }
+    return pcmk_ok;
+}
+
 static int
 lrmd_api_exec(lrmd_t * lrmd, const char *rsc_id, const char *action, const char *userdata, int interval,        /* ms */
               int timeout,      /* ms */
@@ -2113,6 +2672,7 @@ lrmd_api_new(void)
     new_lrmd->cmds->list_agents = lrmd_api_list_agents;
     new_lrmd->cmds->list_ocf_providers = lrmd_api_list_ocf_providers;
     new_lrmd->cmds->list_standards = lrmd_api_list_standards;
+    new_lrmd->cmds->get_stats = lrmd_api_get_stats;
 
     return new_lrmd;
 }
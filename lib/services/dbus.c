@@ -242,15 +242,41 @@ pcmk_dbus_lookup_result(DBusMessage *reply, struct db_getall_data *data)
     DBusMessageIter dict;
     DBusMessageIter args;
 
-    if(pcmk_dbus_find_error("GetAll", (void*)&error, reply, &error)) {
+    if(pcmk_dbus_find_error(data->name? "Get" : "GetAll", (void*)&error, reply, &error)) {
         crm_err("Cannot get properties from %s for %s", data->target, data->object);
-        goto cleanup;
+        goto error;
     }
 
     dbus_message_iter_init(reply, &args);
+    if(data->name) {
+        /* Reply to Get, which is just the value */
+        DBusMessageIter v;
+        DBusBasicValue value;
+
+        if(!pcmk_dbus_type_check(reply, &args, DBUS_TYPE_VARIANT, __FUNCTION__, __LINE__)) {
+            crm_err("Invalid reply from %s for %s", data->target, data->object);
+            goto error;
+        }
+
+        dbus_message_iter_recurse(&args, &v);
+        if(!pcmk_dbus_type_check(reply, &v, DBUS_TYPE_STRING, __FUNCTION__, __LINE__)) {
+            goto error;
+        }
+
+        dbus_message_iter_get_basic(&v, &value);
+        crm_trace("Property %s[%s] is '%s'", data->object, data->name, value.str);
+
+        if(data->callback) {
+            data->callback(data->name, value.str, data->userdata);
+        } else {
+            output = strdup(value.str);
+        }
+        goto cleanup;
+    }
+
     if(!pcmk_dbus_type_check(reply, &args, DBUS_TYPE_ARRAY, __FUNCTION__, __LINE__)) {
         crm_err("Invalid reply from %s for %s", data->target, data->object);
-        goto cleanup;
+        goto error;
     }
 
     dbus_message_iter_recurse(&args, &dict);
@@ -304,8 +330,13 @@ pcmk_dbus_lookup_result(DBusMessage *reply, struct db_getall_data *data)
         dbus_message_iter_next (&dict);
     }
 
-    if(data->name && data->callback) {
+    if(data->name) {
         crm_trace("No value for property %s[%s]", data->object, data->name);
+    }
+
+  error:
+    /* Callers waiting for a particular property always hear back */
+    if(data->name && data->callback) {
         data->callback(data->name, NULL, data->userdata);
     }
 
@@ -341,7 +372,8 @@ pcmk_dbus_get_property(
     int timeout)
 {
     DBusMessage *msg;
-    const char *method = "GetAll";
+    /* Units have a great many properties, so only fetch all of them if asked */
+    const char *method = name? "Get" : "GetAll";
     char *output = NULL;
 
     struct db_getall_data *query_data = NULL;
@@ -360,6 +392,9 @@ pcmk_dbus_get_property(
     }
 
     CRM_LOG_ASSERT(dbus_message_append_args(msg, DBUS_TYPE_STRING, &iface, DBUS_TYPE_INVALID));
+    if(name) {
+        CRM_LOG_ASSERT(dbus_message_append_args(msg, DBUS_TYPE_STRING, &name, DBUS_TYPE_INVALID));
+    }
 
     query_data = malloc(sizeof(struct db_getall_data));
     if(query_data == NULL) {
@@ -465,6 +500,11 @@ pcmk_dbus_watch_destroy(gpointer userdata)
 {
     mainloop_io_t *client = dbus_watch_get_data(userdata);
     crm_trace("Destroyed %p", client);
+
+    /* The mainloop frees client when the bus hangs up, which is before
+     * DBus removes the watch
+     */
+    dbus_watch_set_data(userdata, NULL, NULL);
 }
 
 
@@ -505,13 +545,17 @@ static gboolean
 pcmk_dbus_timeout_dispatch(gpointer data)
 {
     crm_info("Timeout %p expired", data);
+    dbus_timeout_set_data(data, 0, NULL);
     dbus_timeout_handle(data);
     return FALSE;
 }
 
+/* Every call in flight has a timeout, and they hardly ever expire, so they're
+ * kept on the timer wheel rather than each having a mainloop source
+ */
 static dbus_bool_t
 pcmk_dbus_timeout_add(DBusTimeout *timeout, void *data){
-    guint id = g_timeout_add(dbus_timeout_get_interval(timeout), pcmk_dbus_timeout_dispatch, timeout);
+    guint id = mainloop_wheel_add(dbus_timeout_get_interval(timeout), 0, pcmk_dbus_timeout_dispatch, timeout);
 
     crm_trace("Adding timeout %p (%ld)", timeout, dbus_timeout_get_interval(timeout));
 
@@ -529,7 +573,7 @@ pcmk_dbus_timeout_remove(DBusTimeout *timeout, void *data){
     crm_trace("Removing timeout %p (%p)", timeout, data);
 
     if(id) {
-        g_source_remove(id);
+        mainloop_wheel_remove(id);
         dbus_timeout_set_data(timeout, 0, NULL);
     }
 }
@@ -180,6 +180,8 @@ resources_action_create(const char *name, const char *standard, const char *prov
         CRM_ASSERT(op->standard);
     }
 
+    services_native_init(op, params);
+
     if (strcasecmp(op->standard, "ocf") == 0) {
         op->provider = strdup(provider);
         op->params = params;
@@ -382,6 +384,8 @@ services_set_op_pending(svc_action_t *op, DBusPendingCall *pending)
 void
 services_action_cleanup(svc_action_t * op)
 {
+    services_native_cleanup(op);
+
 #if SUPPORT_DBUS
     if(op->opaque == NULL) {
         return;
@@ -389,10 +393,15 @@ services_action_cleanup(svc_action_t * op)
 
     if(op->opaque->timerid != 0) {
         crm_trace("Removing timer for call %s to %s", op->action, op->rsc);
-        g_source_remove(op->opaque->timerid);
+        mainloop_wheel_remove(op->opaque->timerid);
         op->opaque->timerid = 0;
     }
 
+    if(op->opaque->deferred != 0) {
+        g_source_remove(op->opaque->deferred);
+        op->opaque->deferred = 0;
+    }
+
     if(op->opaque->pending) {
         crm_trace("Cleaning up pending dbus call %p %s for %s", op->opaque->pending, op->action, op->rsc);
         if(dbus_pending_call_get_completed(op->opaque->pending)) {
@@ -426,8 +435,11 @@ services_action_free(svc_action_t * op)
 
     services_action_cleanup(op);
 
+    /* Actions without a child process can be cancelled while in flight */
+    inflight_ops = g_list_remove(inflight_ops, op);
+
     if (op->opaque->repeat_timer) {
-        g_source_remove(op->opaque->repeat_timer);
+        mainloop_wheel_remove(op->opaque->repeat_timer);
         op->opaque->repeat_timer = 0;
     }
 
@@ -438,6 +450,16 @@ services_action_free(svc_action_t * op)
         free(op->opaque->args[i]);
     }
 
+    if (op->opaque->env) {
+        for (i = 0; op->opaque->env[i] != NULL; i++) {
+            free(op->opaque->env[i]);
+        }
+        g_free(op->opaque->env);
+    }
+
+    free(op->opaque->native);
+    services_capture_free(&op->opaque->stdout_capture);
+    services_capture_free(&op->opaque->stderr_capture);
     free(op->opaque);
     free(op->rsc);
     free(op->action);
@@ -467,7 +489,7 @@ cancel_recurring_action(svc_action_t * op)
     }
 
     if (op->opaque->repeat_timer) {
-        g_source_remove(op->opaque->repeat_timer);
+        mainloop_wheel_remove(op->opaque->repeat_timer);
         op->opaque->repeat_timer = 0;
     }
 
@@ -533,7 +555,7 @@ services_action_kick(const char *name, const char *action, int interval /* ms */
         return TRUE;
     } else {
         if (op->opaque->repeat_timer) {
-            g_source_remove(op->opaque->repeat_timer);
+            mainloop_wheel_remove(op->opaque->repeat_timer);
             op->opaque->repeat_timer = 0;
         }
         recurring_action_timer(op);
@@ -568,7 +590,7 @@ handle_duplicate_recurring(svc_action_t * op, void (*action_callback) (svc_actio
         /* immediately execute the next interval */
         if (dup->pid != 0) {
             if (op->opaque->repeat_timer) {
-                g_source_remove(op->opaque->repeat_timer);
+                mainloop_wheel_remove(op->opaque->repeat_timer);
                 op->opaque->repeat_timer = 0;
             }
             recurring_action_timer(dup);
@@ -585,7 +607,10 @@ static gboolean
 action_async_helper(svc_action_t * op) {
     gboolean res = FALSE;
 
-    if (op->standard && strcasecmp(op->standard, "upstart") == 0) {
+    if (op->opaque->native) {
+        res = services_native_execute(op);
+
+    } else if (op->standard && strcasecmp(op->standard, "upstart") == 0) {
 #if SUPPORT_UPSTART
         res = upstart_job_exec(op, FALSE);
 #endif
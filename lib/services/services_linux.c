@@ -37,6 +37,10 @@
 #include <sys/signalfd.h>
 #endif
 
+#ifdef HAVE_SPAWN_H
+#include <spawn.h>
+#endif
+
 #include "crm/crm.h"
 #include "crm/common/mainloop.h"
 #include "crm/services.h"
@@ -64,41 +68,194 @@ set_fd_opts(int fd, int opts)
     }
 }
 
+/* How much agent output to keep by default, see svc_capture_init() */
+#define SVC_OUTPUT_HEAD 4096
+#define SVC_OUTPUT_TAIL 12288
+
+/*!
+ * \internal
+ * \brief Set how much of an action's output will be kept
+ *
+ * Agents occasionally print far more than anyone will read, and everything we
+ * keep is copied into the operation result and on to every client, so only the
+ * beginning (PCMK_agent_output_head bytes) and end (PCMK_agent_output_tail
+ * bytes) of each stream are kept. With PCMK_agent_output_keep=no, stdout isn't
+ * kept at all, and callers are expected to drop stderr once they have the exit
+ * reason.
+ *
+ * Meta-data and synchronous actions are returned to the caller as data rather
+ * than logged, so are always kept in full.
+ */
+static void
+svc_capture_init(svc_action_t * op, gboolean synchronous)
+{
+    static int head_max = -1;
+    static int tail_max = -1;
+    static gboolean keep = TRUE;
+    const char *value = NULL;
+    svc_capture_t *out = &op->opaque->stdout_capture;
+    svc_capture_t *err = &op->opaque->stderr_capture;
+
+    if (head_max < 0) {
+        head_max = crm_parse_int(daemon_option("agent_output_head"), NULL);
+        tail_max = crm_parse_int(daemon_option("agent_output_tail"), NULL);
+        value = daemon_option("agent_output_keep");
+        keep = (value == NULL) || crm_is_true(value);
+
+        head_max = (head_max < 0)? SVC_OUTPUT_HEAD : head_max;
+        tail_max = (tail_max < 0)? SVC_OUTPUT_TAIL : tail_max;
+        crm_debug("Keeping the first %d and last %d bytes of %s agent output",
+                  head_max, tail_max, keep? "all" : "stderr");
+    }
+
+    services_capture_free(out);
+    services_capture_free(err);
+
+    if (synchronous || safe_str_eq(op->action, "meta-data")) {
+        out->head_max = err->head_max = SIZE_MAX;
+        return;
+    }
+
+    out->head_max = err->head_max = head_max;
+    out->tail_max = err->tail_max = tail_max;
+
+    /* Heartbeat agents report status on stdout */
+    if (keep == FALSE && safe_str_neq(op->standard, "heartbeat")) {
+        out->head_max = out->tail_max = 0;
+    }
+}
+
+static void
+svc_capture_append(svc_capture_t * capture, const char *buf, size_t len)
+{
+    size_t n = 0;
+
+    capture->total += len;
+
+    if (capture->head_len < capture->head_max) {
+        n = QB_MIN(len, capture->head_max - capture->head_len);
+        if (capture->head_len + n >= capture->head_size) {
+            capture->head_size = QB_MAX(2 * capture->head_size, capture->head_len + n + 1);
+            capture->head = realloc_safe(capture->head, capture->head_size);
+        }
+        memcpy(capture->head + capture->head_len, buf, n);
+        capture->head_len += n;
+        capture->head[capture->head_len] = 0;
+        buf += n;
+        len -= n;
+    }
+
+    if (len == 0 || capture->tail_max == 0) {
+        return;
+
+    } else if (capture->tail == NULL) {
+        capture->tail = malloc(capture->tail_max);
+        CRM_ASSERT(capture->tail != NULL);
+    }
+
+    if (len >= capture->tail_max) {
+        memcpy(capture->tail, buf + len - capture->tail_max, capture->tail_max);
+        capture->tail_len = capture->tail_max;
+        capture->tail_next = 0;
+        return;
+    }
+
+    n = QB_MIN(len, capture->tail_max - capture->tail_next);
+    memcpy(capture->tail + capture->tail_next, buf, n);
+    memcpy(capture->tail, buf + n, len - n);
+    capture->tail_next = (capture->tail_next + len) % capture->tail_max;
+    capture->tail_len = QB_MIN(capture->tail_len + len, capture->tail_max);
+}
+
+void
+services_capture_free(svc_capture_t * capture)
+{
+    free(capture->head);
+    free(capture->tail);
+    memset(capture, 0, sizeof(svc_capture_t));
+}
+
+/*!
+ * \internal
+ * \brief Turn captured output into a string, emptying the capture
+ *
+ * \return Captured output (the capture's own buffer when nothing was
+ *         discarded), or NULL if there was none
+ */
+static char *
+svc_capture_take(svc_action_t * op, svc_capture_t * capture, const char *stream)
+{
+    char *output = NULL;
+    unsigned long long omitted = capture->total - capture->head_len - capture->tail_len;
+
+    if (capture->total == capture->head_len) {
+        output = capture->head;
+        capture->head = NULL;
+
+    } else if (capture->head_len + capture->tail_len > 0) {
+        /* Oldest byte in the ring is the next one to be overwritten once it's full */
+        size_t start = (capture->tail_len < capture->tail_max)? 0 : capture->tail_next;
+        char *marker = omitted? crm_strdup_printf("\n... %llu bytes omitted ...\n", omitted) : strdup("");
+        size_t marker_len = strlen(marker);
+        size_t offset = 0;
+
+        output = malloc(capture->head_len + marker_len + capture->tail_len + 1);
+        CRM_ASSERT(output != NULL);
+
+        memcpy(output, capture->head, capture->head_len);
+        offset = capture->head_len;
+        memcpy(output + offset, marker, marker_len);
+        offset += marker_len;
+        memcpy(output + offset, capture->tail + start, capture->tail_len - start);
+        offset += capture->tail_len - start;
+        memcpy(output + offset, capture->tail, start);
+        offset += start;
+        output[offset] = 0;
+        free(marker);
+    }
+
+    if (omitted) {
+        crm_info("Discarded %llu of %llu bytes of %s:%d %s output",
+                 omitted, capture->total, op->id, op->pid, stream);
+    }
+    services_capture_free(capture);
+    return output;
+}
+
+/*!
+ * \internal
+ * \brief Make an action's captured output available as stdout_data/stderr_data
+ */
+static void
+svc_capture_done(svc_action_t * op)
+{
+    free(op->stderr_data);
+    op->stderr_data = svc_capture_take(op, &op->opaque->stderr_capture, "stderr");
+
+    free(op->stdout_data);
+    op->stdout_data = svc_capture_take(op, &op->opaque->stdout_capture, "stdout");
+}
+
 static gboolean
 svc_read_output(int fd, svc_action_t * op, bool is_stderr)
 {
-    char *data = NULL;
-    int rc = 0, len = 0;
-    char buf[500];
-    static const size_t buf_read_len = sizeof(buf) - 1;
-
+    int rc = 0;
+    char buf[4096];
+    svc_capture_t *capture = is_stderr? &op->opaque->stderr_capture : &op->opaque->stdout_capture;
 
     if (fd < 0) {
         crm_trace("No fd for %s", op->id);
         return FALSE;
     }
 
-    if (is_stderr && op->stderr_data) {
-        len = strlen(op->stderr_data);
-        data = op->stderr_data;
-        crm_trace("Reading %s stderr into offset %d", op->id, len);
-
-    } else if (is_stderr == FALSE && op->stdout_data) {
-        len = strlen(op->stdout_data);
-        data = op->stdout_data;
-        crm_trace("Reading %s stdout into offset %d", op->id, len);
-
-    } else {
-        crm_trace("Reading %s %s", op->id, is_stderr?"stderr":"stdout", len);
-    }
+    crm_trace("Reading %s %s into offset %llu", op->id, is_stderr?"stderr":"stdout",
+              capture->total);
 
     do {
-        rc = read(fd, buf, buf_read_len);
+        rc = read(fd, buf, sizeof(buf));
         if (rc > 0) {
-            crm_trace("Got %d chars: %.80s", rc, buf);
-            buf[rc] = 0;
-            data = realloc_safe(data, len + rc + 1);
-            len += sprintf(data + len, "%s", buf);
+            crm_trace("Got %d chars: %.*s", rc, QB_MIN(rc, 80), buf);
+            svc_capture_append(capture, buf, rc);
 
         } else if (errno != EINTR) {
             /* error or EOF
@@ -108,13 +265,7 @@ svc_read_output(int fd, svc_action_t * op, bool is_stderr)
             break;
         }
 
-    } while (rc == buf_read_len || rc < 0);
-
-    if (is_stderr) {
-        op->stderr_data = data;
-    } else {
-        op->stdout_data = data;
-    }
+    } while (rc == sizeof(buf) || rc < 0);
 
     return rc;
 }
@@ -171,10 +322,24 @@ static struct mainloop_fd_callbacks stderr_callbacks = {
     .destroy = pipe_err_done,
 };
 
+/*!
+ * \internal
+ * \brief Set an agent environment variable
+ *
+ * \param[in]     key        Variable name
+ * \param[in]     value      Variable value
+ * \param[in,out] user_data  If not NULL, a GPtrArray to add "key=value" to
+ *                           instead of setting it in our own environment
+ */
 static void
 set_ocf_env(const char *key, const char *value, gpointer user_data)
 {
-    if (setenv(key, value, 1) != 0) {
+    GPtrArray *env = user_data;
+
+    if (env != NULL) {
+        g_ptr_array_add(env, crm_strdup_printf("%s=%s", key, value));
+
+    } else if (setenv(key, value, 1) != 0) {
         crm_perror(LOG_ERR, "setenv failed for key:%s and value:%s", key, value);
     }
 }
@@ -189,32 +354,32 @@ set_ocf_env_with_prefix(gpointer key, gpointer value, gpointer user_data)
 }
 
 static void
-add_OCF_env_vars(svc_action_t * op)
+add_OCF_env_vars(svc_action_t * op, GPtrArray * env)
 {
     if (!op->standard || strcasecmp("ocf", op->standard) != 0) {
         return;
     }
 
     if (op->params) {
-        g_hash_table_foreach(op->params, set_ocf_env_with_prefix, NULL);
+        g_hash_table_foreach(op->params, set_ocf_env_with_prefix, env);
     }
 
-    set_ocf_env("OCF_RA_VERSION_MAJOR", "1", NULL);
-    set_ocf_env("OCF_RA_VERSION_MINOR", "0", NULL);
-    set_ocf_env("OCF_ROOT", OCF_ROOT_DIR, NULL);
-    set_ocf_env("OCF_EXIT_REASON_PREFIX", PCMK_OCF_REASON_PREFIX, NULL);
+    set_ocf_env("OCF_RA_VERSION_MAJOR", "1", env);
+    set_ocf_env("OCF_RA_VERSION_MINOR", "0", env);
+    set_ocf_env("OCF_ROOT", OCF_ROOT_DIR, env);
+    set_ocf_env("OCF_EXIT_REASON_PREFIX", PCMK_OCF_REASON_PREFIX, env);
 
     if (op->rsc) {
-        set_ocf_env("OCF_RESOURCE_INSTANCE", op->rsc, NULL);
+        set_ocf_env("OCF_RESOURCE_INSTANCE", op->rsc, env);
     }
 
     if (op->agent != NULL) {
-        set_ocf_env("OCF_RESOURCE_TYPE", op->agent, NULL);
+        set_ocf_env("OCF_RESOURCE_TYPE", op->agent, env);
     }
 
     /* Notes: this is not added to specification yet. Sept 10,2004 */
     if (op->provider != NULL) {
-        set_ocf_env("OCF_RESOURCE_PROVIDER", op->provider, NULL);
+        set_ocf_env("OCF_RESOURCE_PROVIDER", op->provider, env);
     }
 }
 
@@ -248,8 +413,12 @@ operation_finalize(svc_action_t * op)
             cancel_recurring_action(op);
         } else {
             recurring = 1;
-            op->opaque->repeat_timer = g_timeout_add(op->interval,
-                                                     recurring_action_timer, (void *)op);
+            /* Recurring operations needn't be exact, so let the timer wheel
+             * spread them out a little rather than run lots at once
+             */
+            op->opaque->repeat_timer = mainloop_wheel_add(op->interval,
+                                                          QB_MIN(op->interval / 20, 2000),
+                                                          recurring_action_timer, (void *)op);
         }
     }
 
@@ -293,7 +462,7 @@ operation_finished(mainloop_child_t * p, pid_t pid, int core, int signo, int exi
          * could occur before all the reads are done.  Force the read now.*/
         crm_trace("%s dispatching stderr", prefix);
         dispatch_stderr(op);
-        crm_trace("%s: %p", op->id, op->stderr_data);
+        crm_trace("%s: %llu", op->id, op->opaque->stderr_capture.total);
         mainloop_del_fd(op->opaque->stderr_gsource);
         op->opaque->stderr_gsource = NULL;
     }
@@ -304,7 +473,7 @@ operation_finished(mainloop_child_t * p, pid_t pid, int core, int signo, int exi
          * could occur before all the reads are done.  Force the read now.*/
         crm_trace("%s dispatching stdout", prefix);
         dispatch_stdout(op);
-        crm_trace("%s: %p", op->id, op->stdout_data);
+        crm_trace("%s: %llu", op->id, op->opaque->stdout_capture.total);
         mainloop_del_fd(op->opaque->stdout_gsource);
         op->opaque->stdout_gsource = NULL;
     }
@@ -327,6 +496,8 @@ operation_finished(mainloop_child_t * p, pid_t pid, int core, int signo, int exi
         crm_debug("%s - exited with rc=%d", prefix, exitcode);
     }
 
+    svc_capture_done(op);
+
     free(prefix);
     prefix = crm_strdup_printf("%s:%d:stderr", op->id, op->pid);
     crm_log_output(LOG_NOTICE, prefix, op->stderr_data);
@@ -446,7 +617,7 @@ action_launch_child(svc_action_t *op)
     }
 #endif
     /* Setup environment correctly */
-    add_OCF_env_vars(op);
+    add_OCF_env_vars(op, NULL);
 
     /* execute the RA */
     execvp(op->opaque->exec, op->opaque->args);
@@ -457,6 +628,209 @@ action_launch_child(svc_action_t *op)
     _exit(op->rc);
 }
 
+#ifdef HAVE_SPAWN_H
+/*!
+ * \internal
+ * \brief Check whether an action can be launched with posix_spawn()
+ *
+ * Forking copies our page tables and then closes every possible descriptor
+ * in the child, which with many recurring monitors is a noticeable share of
+ * the lrmd's CPU.  posix_spawn() avoids both, but can't do everything
+ * action_launch_child() does, so those (rare) actions still fork.
+ */
+static gboolean
+action_can_spawn(svc_action_t * op)
+{
+    static int enabled = -1;
+
+    if (enabled < 0) {
+        const char *value = daemon_option("agent_spawn");
+
+        enabled = (value == NULL) || crm_is_true(value);
+        crm_debug("Launching resource agents with %s", enabled ? "posix_spawn()" : "fork()");
+    }
+
+    if (enabled == FALSE) {
+        return FALSE;
+    }
+
+    /* posix_spawn() can reset the scheduling policy but not the nice value */
+    errno = 0;
+    if (getpriority(PRIO_PROCESS, 0) != 0 && errno == 0) {
+        return FALSE;
+    }
+
+#if SUPPORT_CIBSECRETS
+    /* Secrets are read by the child so they're never kept in our memory */
+    if (op->params) {
+        GHashTableIter iter;
+        const char *value = NULL;
+
+        g_hash_table_iter_init(&iter, op->params);
+        while (g_hash_table_iter_next(&iter, NULL, (gpointer *) & value)) {
+            if (safe_str_eq(value, "lrm://")) {
+                return FALSE;
+            }
+        }
+    }
+#endif
+    return TRUE;
+}
+
+/*!
+ * \internal
+ * \brief Build the environment for an agent
+ *
+ * The action's own variables are built once and kept with it, so a recurring
+ * action only has to combine them with our current environment.
+ *
+ * \return Environment block to pass to posix_spawn() (the strings are owned
+ *         elsewhere, only the array itself should be freed)
+ */
+static char **
+action_spawn_env(svc_action_t * op)
+{
+    int lpc = 0;
+    int len = 0;
+    int env_len = 0;
+    char **envp = NULL;
+
+    if (op->opaque->env == NULL) {
+        GPtrArray *env = g_ptr_array_new();
+
+        add_OCF_env_vars(op, env);
+        g_ptr_array_add(env, NULL);
+        op->opaque->env = (char **)g_ptr_array_free(env, FALSE);
+    }
+
+    for (env_len = 0; op->opaque->env[env_len] != NULL; env_len++) {
+        /* Just counting */
+    }
+    for (lpc = 0; environ && environ[lpc] != NULL; lpc++) {
+        /* Just counting */
+    }
+
+    envp = calloc(env_len + lpc + 1, sizeof(char *));
+    for (len = 0; len < env_len; len++) {
+        envp[len] = op->opaque->env[len];
+    }
+
+    for (lpc = 0; environ && environ[lpc] != NULL; lpc++) {
+        const char *var = environ[lpc];
+        gboolean replaced = FALSE;
+
+        if (env_len > 0 && strncmp(var, "OCF_", 4) == 0) {
+            const char *eq = strchr(var, '=');
+            int name_len = eq ? (eq - var) + 1 : strlen(var);
+            int n = 0;
+
+            for (n = 0; n < env_len && replaced == FALSE; n++) {
+                replaced = (strncmp(op->opaque->env[n], var, name_len) == 0);
+            }
+        }
+        if (replaced == FALSE) {
+            envp[len++] = (char *)var;
+        }
+    }
+    return envp;
+}
+
+/*!
+ * \internal
+ * \brief Close everything but stdin/out/err in a spawned agent
+ */
+static void
+action_spawn_close_fds(posix_spawn_file_actions_t * actions)
+{
+#ifdef HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCLOSEFROM_NP
+    posix_spawn_file_actions_addclosefrom_np(actions, STDERR_FILENO + 1);
+#else
+    int lpc = 0;
+    DIR *dir = opendir("/proc/self/fd");
+
+    if (dir != NULL) {
+        /* Only close what is actually open */
+        struct dirent *entry = NULL;
+
+        while ((entry = readdir(dir)) != NULL) {
+            lpc = crm_parse_int(entry->d_name, "-1");
+            if (lpc > STDERR_FILENO && lpc != dirfd(dir)) {
+                posix_spawn_file_actions_addclose(actions, lpc);
+            }
+        }
+        closedir(dir);
+        return;
+    }
+
+    for (lpc = getdtablesize() - 1; lpc > STDERR_FILENO; lpc--) {
+        posix_spawn_file_actions_addclose(actions, lpc);
+    }
+#endif
+}
+
+/*!
+ * \internal
+ * \brief Launch an agent with posix_spawn(), set up as action_launch_child() would
+ *
+ * \return 0 on success, otherwise an errno value
+ */
+static int
+action_spawn_child(svc_action_t * op, int stdout_fd[2], int stderr_fd[2])
+{
+    int rc = 0;
+    short flags = POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK;
+    char **envp = action_spawn_env(op);
+    sigset_t signals;
+    posix_spawnattr_t attr;
+    posix_spawn_file_actions_t actions;
+
+    posix_spawnattr_init(&attr);
+    posix_spawn_file_actions_init(&actions);
+
+    /* New process group, default signal handling (including SIGPIPE, see
+     * action_launch_child()) and nothing blocked
+     */
+    posix_spawnattr_setpgroup(&attr, 0);
+    sigfillset(&signals);
+    posix_spawnattr_setsigdefault(&attr, &signals);
+    sigemptyset(&signals);
+    posix_spawnattr_setsigmask(&attr, &signals);
+
+#if defined(HAVE_SCHED_SETSCHEDULER)
+    if (sched_getscheduler(0) != SCHED_OTHER) {
+        struct sched_param sp;
+
+        memset(&sp, 0, sizeof(sp));
+        flags |= POSIX_SPAWN_SETSCHEDULER;
+        posix_spawnattr_setschedpolicy(&attr, SCHED_OTHER);
+        posix_spawnattr_setschedparam(&attr, &sp);
+    }
+#endif
+#ifdef POSIX_SPAWN_USEVFORK
+    flags |= POSIX_SPAWN_USEVFORK;
+#endif
+    posix_spawnattr_setflags(&attr, flags);
+
+    if (STDOUT_FILENO != stdout_fd[1]) {
+        posix_spawn_file_actions_adddup2(&actions, stdout_fd[1], STDOUT_FILENO);
+    }
+    if (STDERR_FILENO != stderr_fd[1]) {
+        posix_spawn_file_actions_adddup2(&actions, stderr_fd[1], STDERR_FILENO);
+    }
+    action_spawn_close_fds(&actions);
+
+    rc = posix_spawnp(&op->pid, op->opaque->exec, &actions, &attr, op->opaque->args, envp);
+    if (rc != 0) {
+        op->pid = -1;
+    }
+
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    free(envp);
+    return rc;
+}
+#endif
+
 static void
 action_synced_wait(svc_action_t * op, sigset_t mask)
 {
@@ -580,6 +954,7 @@ action_synced_wait(svc_action_t * op, sigset_t mask)
 
     svc_read_output(op->opaque->stdout_fd, op, FALSE);
     svc_read_output(op->opaque->stderr_fd, op, TRUE);
+    svc_capture_done(op);
 
     close(op->opaque->stdout_fd);
     close(op->opaque->stderr_fd);
@@ -618,6 +993,8 @@ services_os_action_execute(svc_action_t * op, gboolean synchronous)
         return FALSE;
     }
 
+    svc_capture_init(op, synchronous);
+
     if (synchronous) {
         sigemptyset(&mask);
         sigaddset(&mask, SIGCHLD);
@@ -628,6 +1005,27 @@ services_os_action_execute(svc_action_t * op, gboolean synchronous)
         }
     }
 
+#ifdef HAVE_SPAWN_H
+    if (action_can_spawn(op)) {
+        int rc = action_spawn_child(op, stdout_fd, stderr_fd);
+
+        if (rc != 0) {
+            close(stdout_fd[0]);
+            close(stdout_fd[1]);
+            close(stderr_fd[0]);
+            close(stderr_fd[1]);
+
+            crm_err("Could not execute '%s': %s (%d)", op->opaque->exec, pcmk_strerror(rc), rc);
+            services_handle_exec_error(op, rc);
+            if (!synchronous) {
+                return operation_finalize(op);
+            }
+            return FALSE;
+        }
+        goto launched;
+    }
+#endif
+
     op->pid = fork();
     switch (op->pid) {
         case -1:
@@ -665,6 +1063,9 @@ services_os_action_execute(svc_action_t * op, gboolean synchronous)
             action_launch_child(op);
     }
 
+#ifdef HAVE_SPAWN_H
+  launched:
+#endif
     /* Only the parent reaches here */
     close(stdout_fd[1]);
     close(stderr_fd[1]);
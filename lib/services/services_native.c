@@ -0,0 +1,322 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * In-process recurring monitors
+ *
+ * Most monitors of simple resources boil down to "is the process in the
+ * pidfile alive" or "is anything listening on this port", which costs a fork
+ * and a shell to answer.  A resource can instead name one of the checks below
+ * in its monitor's native-monitor meta-attribute, for example
+ *
+ *     native-monitor=pidfile:/run/httpd.pid
+ *     native-monitor=tcp:127.0.0.1:80
+ *
+ * and its recurring monitors are then answered without running the agent.
+ * Probes, and every other action, still run the agent, and results go through
+ * operation_finalize() like any other.
+ *
+ * Checks can only tell running from not running, so are limited to OCF and
+ * LSB resources and are not suitable for promotable ones.
+ */
+
+#include <crm_internal.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <crm/crm.h>
+#include <crm/services.h>
+#include <crm/common/mainloop.h>
+
+#include "services_private.h"
+
+#define SVC_NATIVE_ATTR CRM_META "_native_monitor"
+#define SVC_ROLE_ATTR   CRM_META "_role"
+
+static int native_pidfile(svc_action_t * op, const char *arg);
+static int native_tcp(svc_action_t * op, const char *arg);
+
+static const svc_native_t native_monitors[] = {
+    { "pidfile", native_pidfile },
+    { "tcp", native_tcp },
+};
+
+static const svc_native_t *
+native_find(const char *spec, const char **arg)
+{
+    int lpc = 0;
+
+    for (lpc = 0; lpc < DIMOF(native_monitors); lpc++) {
+        size_t len = strlen(native_monitors[lpc].name);
+
+        if (strncmp(spec, native_monitors[lpc].name, len) == 0 && spec[len] == ':') {
+            if (arg) {
+                *arg = spec + len + 1;
+            }
+            return &native_monitors[lpc];
+        }
+    }
+    return NULL;
+}
+
+/*!
+ * \internal
+ * \brief Check process liveness using a pidfile
+ *
+ * A missing or empty pidfile, or one naming a process that doesn't exist,
+ * means the resource isn't running.
+ */
+static int
+native_pidfile(svc_action_t * op, const char *arg)
+{
+    long pid = crm_read_pidfile(arg);
+
+    if (pid <= 0) {
+        crm_trace("%s: No pid in %s", op->id, arg);
+        return PCMK_OCF_NOT_RUNNING;
+
+    } else if (kill(pid, 0) < 0 && errno == ESRCH) {
+        crm_trace("%s: Process %ld from %s is gone", op->id, pid, arg);
+        return PCMK_OCF_NOT_RUNNING;
+    }
+    return PCMK_OCF_OK;
+}
+
+static gboolean
+native_tcp_connected(GIOChannel * source, GIOCondition condition, gpointer user_data)
+{
+    svc_action_t *op = user_data;
+    int error = 0;
+    socklen_t len = sizeof(error);
+
+    op->opaque->native_source = 0;
+    if (getsockopt(op->opaque->native_fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0) {
+        error = errno;
+    }
+
+    crm_trace("%s: Connection %s", op->id, error? pcmk_strerror(error) : "succeeded");
+    services_native_done(op, error? PCMK_OCF_NOT_RUNNING : PCMK_OCF_OK);
+    return FALSE;
+}
+
+/*!
+ * \internal
+ * \brief Check that something accepts connections on a TCP port
+ *
+ * The address must be numeric (an IPv6 one in brackets), so that looking it
+ * up can't block.
+ */
+static int
+native_tcp(svc_action_t * op, const char *arg)
+{
+    int rc = 0;
+    int fd = -1;
+    char *host = strdup(arg);
+    char *port = strrchr(host, ':');
+    struct addrinfo hints;
+    struct addrinfo *addr = NULL;
+    GIOChannel *channel = NULL;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_NUMERICHOST | AI_NUMERICSERV;
+
+    if (port) {
+        *port++ = 0;
+        if (host[0] == '[' && host[strlen(host) - 1] == ']') {
+            host[strlen(host) - 1] = 0;
+            memmove(host, host + 1, strlen(host));
+        }
+        rc = getaddrinfo(host, port, &hints, &addr);
+    }
+
+    if (port == NULL || rc != 0) {
+        crm_err("Invalid native-monitor address for %s: %s", op->rsc, arg);
+        free(host);
+        return PCMK_OCF_NOT_CONFIGURED;
+    }
+    free(host);
+
+    fd = socket(addr->ai_family, SOCK_STREAM, 0);
+    if (fd < 0) {
+        crm_perror(LOG_ERR, "Could not create socket for %s", op->id);
+        freeaddrinfo(addr);
+        return PCMK_OCF_UNKNOWN_ERROR;
+    }
+
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    rc = connect(fd, addr->ai_addr, addr->ai_addrlen);
+    freeaddrinfo(addr);
+
+    if (rc == 0) {
+        close(fd);
+        return PCMK_OCF_OK;
+
+    } else if (errno != EINPROGRESS) {
+        crm_trace("%s: Connection to %s failed: %s", op->id, arg, pcmk_strerror(errno));
+        close(fd);
+        return PCMK_OCF_NOT_RUNNING;
+    }
+
+    op->opaque->native_fd = fd;
+    channel = g_io_channel_unix_new(fd);
+    op->opaque->native_source = g_io_add_watch(channel, G_IO_OUT | G_IO_ERR | G_IO_HUP,
+                                               native_tcp_connected, op);
+    g_io_channel_unref(channel);
+    return -1;
+}
+
+/*!
+ * \internal
+ * \brief Decide whether an action can be handled in-process
+ *
+ * \param[in,out] op      Newly created action
+ * \param[in]     params  Parameters the action was created with
+ */
+void
+services_native_init(svc_action_t * op, GHashTable * params)
+{
+    const char *spec = params? g_hash_table_lookup(params, SVC_NATIVE_ATTR) : NULL;
+
+    if (spec == NULL || op->interval <= 0) {
+        return;
+
+    } else if (safe_str_neq(op->action, "monitor") && safe_str_neq(op->action, "status")) {
+        return;
+
+    } else if (safe_str_neq(op->standard, "ocf") && safe_str_neq(op->standard, "lsb")) {
+        crm_warn("Ignoring native-monitor for %s: %s resources are not supported",
+                 op->rsc, op->standard);
+        return;
+
+    } else if (g_hash_table_lookup(params, SVC_ROLE_ATTR)) {
+        /* Checks can't tell a master from a slave */
+        crm_warn("Ignoring native-monitor for %s: monitors for a particular role are not supported",
+                 op->rsc);
+        return;
+
+    } else if (native_find(spec, NULL) == NULL) {
+        crm_warn("Ignoring native-monitor for %s: '%s' is not a known check", op->rsc, spec);
+        return;
+    }
+
+    crm_debug("Checking %s with %s instead of running its agent", op->id, spec);
+    op->opaque->native = strdup(spec);
+    op->opaque->native_fd = -1;
+}
+
+static gboolean
+native_timeout(gpointer user_data)
+{
+    svc_action_t *op = user_data;
+
+    op->opaque->native_timer = 0;
+    crm_warn("%s - timed out after %dms", op->id, op->timeout);
+
+    services_native_cleanup(op);
+    op->status = PCMK_LRM_OP_TIMEOUT;
+    op->rc = PCMK_OCF_TIMEOUT;
+    operation_finalize(op);
+    return FALSE;
+}
+
+static gboolean
+native_dispatch(gpointer user_data)
+{
+    int rc = 0;
+    const char *arg = NULL;
+    svc_action_t *op = user_data;
+    const svc_native_t *native = native_find(op->opaque->native, &arg);
+
+    op->opaque->native_source = 0;
+    rc = native->monitor(op, arg);
+    if (rc >= 0) {
+        services_native_done(op, rc);
+    }
+    return FALSE;
+}
+
+/*!
+ * \internal
+ * \brief Start an in-process check
+ *
+ * The check is run from the mainloop, as some complete immediately and our
+ * caller expects the action to be in flight when we return.
+ */
+gboolean
+services_native_execute(svc_action_t * op)
+{
+    op->pid = 0;
+    op->opaque->native_source = g_idle_add(native_dispatch, op);
+    if (op->timeout > 0) {
+        op->opaque->native_timer = mainloop_wheel_add(op->timeout, 0, native_timeout, op);
+    }
+    return TRUE;
+}
+
+/*!
+ * \internal
+ * \brief Complete an in-process check
+ *
+ * \param[in,out] op  Action being checked (may be freed on return)
+ * \param[in]     rc  OCF exit code of the check
+ */
+void
+services_native_done(svc_action_t * op, int rc)
+{
+    services_native_cleanup(op);
+
+    /* Callers map LSB status codes */
+    if (safe_str_eq(op->standard, "lsb") && rc == PCMK_OCF_NOT_RUNNING) {
+        rc = PCMK_LSB_STATUS_NOT_RUNNING;
+    }
+
+    crm_debug("%s - %s check returned rc=%d", op->id, op->opaque->native, rc);
+    op->status = PCMK_LRM_OP_DONE;
+    op->rc = rc;
+    operation_finalize(op);
+}
+
+void
+services_native_cleanup(svc_action_t * op)
+{
+    if (op->opaque == NULL || op->opaque->native == NULL) {
+        return;
+    }
+
+    if (op->opaque->native_source) {
+        g_source_remove(op->opaque->native_source);
+        op->opaque->native_source = 0;
+    }
+    if (op->opaque->native_timer) {
+        mainloop_wheel_remove(op->opaque->native_timer);
+        op->opaque->native_timer = 0;
+    }
+    if (op->opaque->native_fd >= 0) {
+        close(op->opaque->native_fd);
+        op->opaque->native_fd = -1;
+    }
+}
@@ -24,6 +24,33 @@
 #endif
 
 #define MAX_ARGC        255
+
+/* Output captured from one of an agent's pipes */
+typedef struct svc_capture_s {
+    char *head;                 /* the first head_max bytes */
+    size_t head_len;
+    size_t head_size;
+    size_t head_max;
+
+    char *tail;                 /* ring buffer of the last tail_max bytes after those */
+    size_t tail_len;
+    size_t tail_next;
+    size_t tail_max;
+
+    unsigned long long total;   /* everything read, including discarded bytes */
+} svc_capture_t;
+
+/* In-process alternative to running an agent's recurring monitor */
+typedef struct svc_native_s {
+    const char *name;
+
+    /* Check op's resource given the text after "name:" in its native-monitor
+     * meta-attribute.  Returns an OCF exit code, or -1 having arranged to
+     * call services_native_done() later.
+     */
+    int (*monitor)(svc_action_t * op, const char *arg);
+} svc_native_t;
+
 struct svc_action_private_s {
     char *exec;
     char *args[MAX_ARGC];
@@ -36,9 +63,20 @@ struct svc_action_private_s {
 
     int stdout_fd;
     mainloop_io_t *stdout_gsource;
+
+    svc_capture_t stderr_capture;
+    svc_capture_t stdout_capture;
+
+    char **env;                 /* agent variables for posix_spawn(), built on first use */
+
+    char *native;               /* in-process check to use instead of the agent */
+    int native_fd;
+    guint native_source;
+    guint native_timer;
 #if SUPPORT_DBUS
     DBusPendingCall* pending;
     unsigned timerid;
+    guint deferred;             /* idle source that will start the action */
 #endif
 };
 
@@ -57,8 +95,14 @@ GList *resources_os_list_nagios_agents(void);
 gboolean cancel_recurring_action(svc_action_t * op);
 
 gboolean recurring_action_timer(gpointer data);
+void services_capture_free(svc_capture_t * capture);
 gboolean operation_finalize(svc_action_t * op);
 
+void services_native_init(svc_action_t * op, GHashTable * params);
+gboolean services_native_execute(svc_action_t * op);
+void services_native_done(svc_action_t * op, int rc);
+void services_native_cleanup(svc_action_t * op);
+
 void handle_blocked_ops(void);
 
 gboolean is_op_blocked(const char *rsc);
@@ -72,15 +72,101 @@ static DBusMessage *systemd_new_method(const char *iface, const char *method)
 
 
 static DBusConnection* systemd_proxy = NULL;
+
+/* Object paths of the units we've loaded, by unit name.  A unit's path follows
+ * from its name, but entries are dropped whenever systemd reloads or unloads
+ * the unit so that nothing stale is ever used.
+ */
+static GHashTable *unit_paths = NULL;
+
+#define SYSTEMD_SIGNAL_MATCH(member) \
+    "type='signal',sender='" BUS_NAME "',interface='" BUS_NAME ".Manager',member='" member "'"
+
+static DBusHandlerResult
+systemd_signal_filter(DBusConnection *connection, DBusMessage *msg, void *user_data)
+{
+    const char *id = NULL;
+    const char *path = NULL;
+
+    if (dbus_message_is_signal(msg, BUS_NAME".Manager", "Reloading")) {
+        crm_trace("systemd is reloading, forgetting %d unit paths", g_hash_table_size(unit_paths));
+        g_hash_table_remove_all(unit_paths);
+
+    } else if (dbus_message_is_signal(msg, BUS_NAME".Manager", "UnitRemoved")
+               && dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &id,
+                                        DBUS_TYPE_OBJECT_PATH, &path, DBUS_TYPE_INVALID)) {
+        crm_trace("systemd unloaded %s (%s)", id, path);
+        g_hash_table_remove(unit_paths, id);
+    }
+
+    /* Other filters may be interested too */
+    return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+}
+
+static void
+systemd_subscribe_complete(DBusPendingCall *pending, void *user_data)
+{
+    DBusError error;
+    DBusMessage *reply = NULL;
+
+    dbus_error_init(&error);
+    if(pending) {
+        reply = dbus_pending_call_steal_reply(pending);
+    }
+
+    if(pcmk_dbus_find_error("Subscribe", pending, reply, &error)) {
+        crm_warn("Could not subscribe to systemd signals: %s", error.message);
+    }
+
+    if(pending) {
+        dbus_pending_call_unref(pending);
+    }
+    if(reply) {
+        dbus_message_unref(reply);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Ask systemd to tell us when the unit path cache may be out of date
+ *
+ * Neither the match rules nor the subscription wait for a reply.
+ */
+static void
+systemd_subscribe(void)
+{
+    DBusMessage *msg = NULL;
+
+    dbus_connection_add_filter(systemd_proxy, systemd_signal_filter, NULL, NULL);
+    dbus_bus_add_match(systemd_proxy, SYSTEMD_SIGNAL_MATCH("Reloading"), NULL);
+    dbus_bus_add_match(systemd_proxy, SYSTEMD_SIGNAL_MATCH("UnitRemoved"), NULL);
+
+    /* UnitRemoved is only sent to subscribers */
+    msg = systemd_new_method(BUS_NAME".Manager", "Subscribe");
+    CRM_ASSERT(msg != NULL);
+    pcmk_dbus_send(msg, systemd_proxy, systemd_subscribe_complete, NULL, DBUS_TIMEOUT_USE_DEFAULT);
+    dbus_message_unref(msg);
+}
+
 static gboolean
 systemd_init(void)
 {
     static int need_init = 1;
     /* http://dbus.freedesktop.org/doc/api/html/group__DBusConnection.html */
 
+    if (systemd_proxy && dbus_connection_get_is_connected(systemd_proxy) == FALSE) {
+        crm_warn("Lost connection to the system bus, reconnecting");
+        systemd_cleanup();
+        need_init = 1;
+    }
+
     if (need_init) {
         need_init = 0;
         systemd_proxy = pcmk_dbus_connect();
+        if (systemd_proxy) {
+            unit_paths = g_hash_table_new_full(crm_str_hash, g_str_equal, free, free);
+            systemd_subscribe();
+        }
     }
     if (systemd_proxy == NULL) {
         return FALSE;
@@ -92,9 +178,15 @@ void
 systemd_cleanup(void)
 {
     if (systemd_proxy) {
+        dbus_connection_remove_filter(systemd_proxy, systemd_signal_filter, NULL);
         pcmk_dbus_disconnect(systemd_proxy);
+        dbus_connection_unref(systemd_proxy);
         systemd_proxy = NULL;
     }
+    if (unit_paths) {
+        g_hash_table_destroy(unit_paths);
+        unit_paths = NULL;
+    }
 }
 
 static char *
@@ -155,6 +247,12 @@ systemd_daemon_reload(int timeout)
     return TRUE;
 }
 
+static const char *
+systemd_unit_path_cached(const char *name)
+{
+    return unit_paths? g_hash_table_lookup(unit_paths, name) : NULL;
+}
+
 static const char *
 systemd_loadunit_result(DBusMessage *reply, svc_action_t * op)
 {
@@ -171,6 +269,10 @@ systemd_loadunit_result(DBusMessage *reply, svc_action_t * op)
                                DBUS_TYPE_INVALID);
     }
 
+    if(op && path && unit_paths) {
+        g_hash_table_replace(unit_paths, systemd_service_name(op->agent), strdup(path));
+    }
+
     if(op) {
         systemd_unit_exec_with_unit(op, path);
     }
@@ -221,12 +323,22 @@ systemd_unit_by_name(const gchar * arg_name, svc_action_t *op)
         return FALSE;
     }
 
+    name = systemd_service_name(arg_name);
+    if((op == NULL || op->synchronous) && systemd_unit_path_cached(name)) {
+        char *unit = strdup(systemd_unit_path_cached(name));
+
+        crm_trace("Using cached path %s for %s", unit, name);
+        free(name);
+        if(op) {
+            systemd_unit_exec_with_unit(op, unit);
+        }
+        return unit;
+    }
+
     msg = systemd_new_method(BUS_NAME".Manager", "LoadUnit");
     CRM_ASSERT(msg != NULL);
 
-    name = systemd_service_name(arg_name);
     CRM_LOG_ASSERT(dbus_message_append_args(msg, DBUS_TYPE_STRING, &name, DBUS_TYPE_INVALID));
-    free(name);
 
     if(op == NULL || op->synchronous) {
         const char *unit = NULL;
@@ -240,12 +352,17 @@ systemd_unit_by_name(const gchar * arg_name, svc_action_t *op)
         unit = systemd_loadunit_result(reply, op);
         if(unit) {
             munit = strdup(unit);
+            if(op == NULL && unit_paths) {
+                g_hash_table_replace(unit_paths, strdup(name), strdup(unit));
+            }
         }
+        free(name);
         if(reply) {
             dbus_message_unref(reply);
         }
         return munit;
     }
+    free(name);
 
     pending = pcmk_dbus_send(msg, systemd_proxy, systemd_loadunit_cb, op, op->timeout);
     if(pending) {
@@ -357,17 +474,13 @@ systemd_unit_exists(const char *name)
 }
 
 static char *
-systemd_unit_metadata(const char *name, int timeout)
+systemd_unit_metadata_xml(const char *name, const char *desc)
 {
+    char *generic = NULL;
     char *meta = NULL;
-    char *desc = NULL;
-    char *path = systemd_unit_by_name(name, NULL);
 
-    if (path) {
-        /* TODO: Worth a making blocking call for? Probably not. Possibly if cached. */
-        desc = pcmk_dbus_get_property(systemd_proxy, BUS_NAME, path, BUS_NAME ".Unit", "Description", NULL, NULL, NULL, timeout);
-    } else {
-        desc = crm_strdup_printf("Systemd unit file for %s", name);
+    if (desc == NULL) {
+        desc = generic = crm_strdup_printf("Systemd unit file for %s", name);
     }
 
     meta = crm_strdup_printf("<?xml version=\"1.0\"?>\n"
@@ -390,11 +503,39 @@ systemd_unit_metadata(const char *name, int timeout)
                            "  </actions>\n"
                            "  <special tag=\"systemd\">\n"
                            "  </special>\n" "</resource-agent>\n", name, desc, name);
+    free(generic);
+    return meta;
+}
+
+static char *
+systemd_unit_metadata(const char *name, int timeout)
+{
+    char *meta = NULL;
+    char *desc = NULL;
+    char *path = systemd_unit_by_name(name, NULL);
+
+    if (path) {
+        desc = pcmk_dbus_get_property(systemd_proxy, BUS_NAME, path, BUS_NAME ".Unit", "Description", NULL, NULL, NULL, timeout);
+    }
+
+    meta = systemd_unit_metadata_xml(name, desc);
     free(desc);
     free(path);
     return meta;
 }
 
+static void
+systemd_metadata_check(const char *name, const char *desc, void *userdata)
+{
+    svc_action_t * op = userdata;
+
+    op->stdout_data = systemd_unit_metadata_xml(op->agent, desc);
+    op->rc = PCMK_OCF_OK;
+
+    services_set_op_pending(op, NULL);
+    operation_finalize(op);
+}
+
 static bool
 systemd_mask_error(svc_action_t *op, const char *error)
 {
@@ -507,6 +648,24 @@ systemd_unit_exec_with_unit(svc_action_t * op, const char *unit)
     DBusMessage *msg = NULL;
     DBusMessage *reply = NULL;
 
+    if (safe_str_eq(op->action, "meta-data")) {
+        /* Only asynchronous requests get here */
+        DBusPendingCall *pending = NULL;
+
+        if (unit) {
+            pcmk_dbus_get_property(systemd_proxy, BUS_NAME, unit, BUS_NAME ".Unit", "Description",
+                                   systemd_metadata_check, op, &pending, op->timeout);
+        }
+        if (pending) {
+            services_set_op_pending(op, pending);
+            return TRUE;
+        }
+
+        op->stdout_data = systemd_unit_metadata_xml(op->agent, NULL);
+        op->rc = PCMK_OCF_OK;
+        goto cleanup;
+    }
+
     if (unit == NULL) {
         crm_debug("Could not obtain unit named '%s'", op->agent);
         op->rc = PCMK_OCF_NOT_INSTALLED;
@@ -648,6 +807,26 @@ systemd_timeout_callback(gpointer p)
     return FALSE;
 }
 
+static gboolean
+systemd_unit_exec_cached(gpointer p)
+{
+    svc_action_t * op = p;
+    char *name = systemd_service_name(op->agent);
+    char *unit = systemd_unit_path_cached(name)? strdup(systemd_unit_path_cached(name)) : NULL;
+
+    op->opaque->deferred = 0;
+    if (unit) {
+        systemd_unit_exec_with_unit(op, unit);
+    } else {
+        /* Forgotten since the action was scheduled */
+        free(systemd_unit_by_name(op->agent, op));
+    }
+
+    free(unit);
+    free(name);
+    return FALSE;
+}
+
 gboolean
 systemd_unit_exec(svc_action_t * op)
 {
@@ -659,24 +838,32 @@ systemd_unit_exec(svc_action_t * op)
     crm_debug("Performing %ssynchronous %s op on systemd unit %s named '%s'",
               op->synchronous ? "" : "a", op->action, op->agent, op->rsc);
 
-    if (safe_str_eq(op->action, "meta-data")) {
-        /* TODO: See if we can teach the lrmd not to make these calls synchronously */
+    if (op->synchronous && safe_str_eq(op->action, "meta-data")) {
         op->stdout_data = systemd_unit_metadata(op->agent, op->timeout);
         op->rc = PCMK_OCF_OK;
+        return TRUE;
+    }
+
+    if (op->synchronous == FALSE) {
+        char *name = systemd_service_name(op->agent);
+
+        op->opaque->timerid = mainloop_wheel_add(op->timeout + 5000, 0, systemd_timeout_callback, op);
 
-        if (op->synchronous == FALSE) {
-            operation_finalize(op);
+        /* Skip LoadUnit for units we already know.  The action may complete
+         * straight away, which our caller isn't ready for, so run it from
+         * the mainloop.
+         */
+        if (systemd_unit_path_cached(name)) {
+            op->opaque->deferred = g_idle_add(systemd_unit_exec_cached, op);
+        } else {
+            free(systemd_unit_by_name(op->agent, op));
         }
+        free(name);
         return TRUE;
     }
 
     unit = systemd_unit_by_name(op->agent, op);
     free(unit);
 
-    if (op->synchronous == FALSE) {
-        op->opaque->timerid = g_timeout_add(op->timeout + 5000, systemd_timeout_callback, op);
-        return TRUE;
-    }
-
     return op->rc == PCMK_OCF_OK;
 }
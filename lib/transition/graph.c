@@ -24,39 +24,183 @@
 #include <crm/transition.h>
 /* #include <sys/param.h> */
 /*  */
+#include "transition_private.h"
 
 crm_graph_functions_t *graph_fns = NULL;
 
-static gboolean
-update_synapse_ready(synapse_t * synapse, int action_id)
+/* Which of the graph's totals a synapse is included in */
+enum synapse_totals {
+    synapse_in_completed = 0x01,
+    synapse_in_pending   = 0x02,
+    synapse_in_failed    = 0x04,
+    synapse_in_waiting   = 0x08,
+};
+
+static gint
+sort_synapse_by_id(gconstpointer a, gconstpointer b, gpointer user_data)
 {
-    GListPtr lpc = NULL;
-    gboolean updates = FALSE;
+    const synapse_t *synapse_a = a;
+    const synapse_t *synapse_b = b;
 
-    CRM_CHECK(synapse->executed == FALSE, return FALSE);
-    CRM_CHECK(synapse->confirmed == FALSE, return FALSE);
+    if (synapse_a->id < synapse_b->id) {
+        return -1;
+    } else if (synapse_a->id > synapse_b->id) {
+        return 1;
+    }
+    return 0;
+}
 
-    synapse->ready = TRUE;
-    for (lpc = synapse->inputs; lpc != NULL; lpc = lpc->next) {
-        crm_action_t *prereq = (crm_action_t *) lpc->data;
+static void
+adjust_total(int *total, int before, int after, int flag)
+{
+    if ((after & flag) && (before & flag) == 0) {
+        (*total)++;
 
-        crm_trace("Processing input %d", prereq->id);
+    } else if ((before & flag) && (after & flag) == 0) {
+        (*total)--;
+    }
+}
 
-        if (prereq->id == action_id) {
-            crm_trace("Marking input %d of synapse %d confirmed", action_id, synapse->id);
-            prereq->confirmed = TRUE;
-            updates = TRUE;
+/*!
+ * \internal
+ * \brief Bring the graph's totals up to date with a synapse's state
+ *
+ * Called whenever a synapse may have been confirmed, failed, executed or had
+ * an input confirmed, so that run_graph() doesn't have to walk every synapse.
+ */
+void
+graph_update_totals(crm_graph_t * graph, synapse_t * synapse)
+{
+    int counted = 0;
 
-        } else if (prereq->confirmed == FALSE) {
-            synapse->ready = FALSE;
+    if (synapse->confirmed) {
+        counted |= synapse_in_completed;
+
+    } else if (synapse->failed == FALSE && synapse->executed) {
+        counted |= synapse_in_pending;
+    }
+
+    if (synapse->failed) {
+        counted |= synapse_in_failed;
+
+    } else if (synapse->confirmed == FALSE && synapse->executed == FALSE
+               && synapse->pending_inputs > 0) {
+        counted |= synapse_in_waiting;
+    }
+
+    if (counted != synapse->counted) {
+        adjust_total(&graph->num_completed, synapse->counted, counted, synapse_in_completed);
+        adjust_total(&graph->num_pending, synapse->counted, counted, synapse_in_pending);
+        adjust_total(&graph->num_failed, synapse->counted, counted, synapse_in_failed);
+        adjust_total(&graph->num_waiting, synapse->counted, counted, synapse_in_waiting);
+        synapse->counted = counted;
+    }
+}
+
+/*!
+ * \internal
+ * \brief Add a synapse whose inputs are all confirmed to the ready set
+ *
+ * The set is kept in graph order so synapses fire as they always have, either
+ * as a whole or, when synapses can be held back, in the node queues.
+ */
+void
+graph_ready_add(crm_graph_t * graph, synapse_t * synapse)
+{
+    GSequence *queue = NULL;
+
+    if (graph->ready_by_node) {
+        queue = synapse->lane? synapse->lane : graph->ready_priority;
+
+    } else {
+        if (graph->ready == NULL) {
+            graph->ready = g_sequence_new(NULL);
         }
+        queue = graph->ready;
+    }
+    g_sequence_insert_sorted(queue, synapse, sort_synapse_by_id, NULL);
+}
 
+static void
+init_lanes(crm_graph_t * graph)
+{
+    if (graph->lanes == NULL) {
+        graph->ready_priority = g_sequence_new(NULL);
+        graph->lanes = g_hash_table_new_full(crm_str_hash, g_str_equal, NULL,
+                                             (GDestroyNotify) g_sequence_free);
     }
+}
 
-    if (updates) {
-        crm_trace("Updated synapse %d", synapse->id);
+static void
+move_ready(crm_graph_t * graph, GSequence * from)
+{
+    GSequenceIter *iter = NULL;
+
+    if (from == NULL) {
+        return;
     }
-    return updates;
+
+    iter = g_sequence_get_begin_iter(from);
+    while (g_sequence_iter_is_end(iter) == FALSE) {
+        GSequenceIter *current = iter;
+
+        iter = g_sequence_iter_next(current);
+        graph_ready_add(graph, g_sequence_get(current));
+        g_sequence_remove(current);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Switch between the single ready set and the node queues
+ *
+ * Only happens when the batch limit is turned on or off, normally never
+ * after the first pass.
+ */
+static void
+set_ready_by_node(crm_graph_t * graph, gboolean by_node)
+{
+    GListPtr lpc = NULL;
+
+    if (graph->ready_by_node == by_node) {
+        return;
+    }
+
+    crm_trace("Queueing ready synapses %s", by_node? "by node" : "in graph order");
+    init_lanes(graph);
+    graph->ready_by_node = by_node;
+    if (by_node) {
+        move_ready(graph, graph->ready);
+        return;
+    }
+
+    move_ready(graph, graph->ready_priority);
+    for (lpc = graph->lane_order; lpc != NULL; lpc = lpc->next) {
+        move_ready(graph, lpc->data);
+    }
+}
+
+static gboolean
+update_synapse_ready(crm_graph_t * graph, synapse_t * synapse, crm_action_t * prereq)
+{
+    CRM_CHECK(synapse->executed == FALSE, return FALSE);
+    CRM_CHECK(synapse->confirmed == FALSE, return FALSE);
+
+    crm_trace("Marking input %d of synapse %d confirmed", prereq->id, synapse->id);
+    if (prereq->confirmed == FALSE) {
+        prereq->confirmed = TRUE;
+        synapse->pending_inputs--;
+
+        if (synapse->pending_inputs == 0) {
+            synapse->ready = TRUE;
+            synapse->ready_usec = crm_monotonic_usec();
+            synapse->ready_input = prereq->id;
+            graph_ready_add(graph, synapse);
+        }
+    }
+
+    crm_trace("Updated synapse %d", synapse->id);
+    return TRUE;
 }
 
 static gboolean
@@ -104,20 +248,45 @@ update_graph(crm_graph_t * graph, crm_action_t * action)
     gboolean rc = FALSE;
     gboolean updates = FALSE;
     GListPtr lpc = NULL;
+    synapse_t *synapse = action->synapse;
+
+    if (action->confirmed_usec == 0) {
+        action->confirmed_usec = crm_monotonic_usec();
+    }
 
-    for (lpc = graph->synapses; lpc != NULL; lpc = lpc->next) {
-        synapse_t *synapse = (synapse_t *) lpc->data;
+    /* The synapse the action belongs to... */
+    if (synapse == NULL || synapse->confirmed || synapse->failed) {
+        crm_trace("Synapse complete");
+
+    } else if (synapse->executed) {
+        crm_trace("Synapse executed");
+        updates = update_synapse_confirmed(synapse, action->id);
+    }
+    if (synapse) {
+        graph_update_totals(graph, synapse);
+    }
+
+    /* ...and those waiting on it */
+    if (graph->dependents) {
+        lpc = g_hash_table_lookup(graph->dependents, GINT_TO_POINTER(action->id));
+    }
+
+    for (; lpc != NULL; lpc = lpc->next) {
+        crm_action_t *prereq = (crm_action_t *) lpc->data;
+
+        synapse = prereq->synapse;
+        rc = FALSE;
 
         if (synapse->confirmed || synapse->failed) {
             crm_trace("Synapse complete");
 
         } else if (synapse->executed) {
             crm_trace("Synapse executed");
-            rc = update_synapse_confirmed(synapse, action->id);
 
         } else if (action->failed == FALSE || synapse->priority == INFINITY) {
-            rc = update_synapse_ready(synapse, action->id);
+            rc = update_synapse_ready(graph, synapse, prereq);
         }
+        graph_update_totals(graph, synapse);
         updates = updates || rc;
     }
 
@@ -222,6 +391,7 @@ fire_synapse(crm_graph_t * graph, synapse_t * synapse)
 
     crm_trace("Synapse %d fired", synapse->id);
     synapse->executed = TRUE;
+    synapse->fired_usec = crm_monotonic_usec();
     for (lpc = synapse->actions; lpc != NULL; lpc = lpc->next) {
         crm_action_t *action = (crm_action_t *) lpc->data;
 
@@ -243,10 +413,223 @@ fire_synapse(crm_graph_t * graph, synapse_t * synapse)
     return TRUE;
 }
 
+/*!
+ * \internal
+ * \brief Try to fire a synapse that has all its inputs confirmed
+ *
+ * \return TRUE if the synapse no longer needs to be on the ready list
+ */
+static gboolean
+run_ready_synapse(crm_graph_t * graph, synapse_t * synapse, int *log_level)
+{
+    if (synapse->failed || synapse->confirmed || synapse->executed) {
+        /* Already handled */
+        return TRUE;
+
+    } else if (should_fire_synapse(graph, synapse) == FALSE) {
+        crm_trace("Synapse %d cannot fire", synapse->id);
+        graph->incomplete++;
+        return FALSE;
+    }
+
+    crm_trace("Synapse %d fired", synapse->id);
+    graph->fired++;
+    if(fire_synapse(graph, synapse) == FALSE) {
+        crm_err("Synapse %d failed to fire", synapse->id);
+        *log_level = LOG_ERR;
+        graph->abort_priority = INFINITY;
+        graph->incomplete++;
+        graph->fired--;
+    }
+    graph_update_totals(graph, synapse);
+
+    if (synapse->confirmed == FALSE) {
+        graph->pending++;
+    }
+    return TRUE;
+}
+
+static gboolean
+batch_limit_reached(crm_graph_t * graph)
+{
+    if (graph->batch_limit > 0 && graph->pending >= graph->batch_limit) {
+        crm_debug("Throttling output: batch limit (%d) reached", graph->batch_limit);
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/*!
+ * \internal
+ * \brief Decide which node's queue a synapse joins once it is ready
+ *
+ * \return Node name, or NULL if the synapse should skip the per-node queues
+ *         (fencing, remote connections and pseudo actions)
+ */
+static const char *
+synapse_lane(synapse_t * synapse)
+{
+    GListPtr lpc = NULL;
+    const char *lane = NULL;
+
+    for (lpc = synapse->actions; lpc != NULL; lpc = lpc->next) {
+        crm_action_t *action = (crm_action_t *) lpc->data;
+        const char *task = crm_element_value(action->xml, XML_LRM_ATTR_TASK);
+
+        if (action->type == action_type_pseudo) {
+            continue;
+
+        } else if (action->type == action_type_crm) {
+            if (safe_str_eq(task, CRM_OP_FENCE)) {
+                return NULL;
+            }
+
+        } else if (action->type == action_type_rsc) {
+            xmlNode *primitive = first_named_child(action->xml, XML_CIB_TAG_RESOURCE);
+
+            if (safe_str_eq(crm_element_value(primitive, XML_AGENT_ATTR_PROVIDER), "pacemaker")
+                && safe_str_eq(crm_element_value(primitive, XML_ATTR_TYPE), "remote")) {
+                /* Everything on the remote node is waiting for this */
+                return NULL;
+            }
+        }
+
+        if (lane == NULL) {
+            /* Match how crmd accounts for jobs on remote nodes */
+            lane = crm_element_value(action->xml, XML_LRM_ATTR_ROUTER_NODE);
+        }
+        if (lane == NULL) {
+            lane = crm_element_value(action->xml, XML_LRM_ATTR_TARGET);
+        }
+    }
+    return lane;
+}
+
+/*!
+ * \internal
+ * \brief Work out which queue a synapse will wait in, once, when unpacking
+ */
+void
+graph_assign_lane(crm_graph_t * graph, synapse_t * synapse)
+{
+    const char *lane = synapse_lane(synapse);
+
+    init_lanes(graph);
+    if (lane == NULL) {
+        synapse->lane = NULL;
+        return;
+    }
+
+    synapse->lane = g_hash_table_lookup(graph->lanes, lane);
+    if (synapse->lane == NULL) {
+        synapse->lane = g_sequence_new(NULL);
+        g_hash_table_insert(graph->lanes, (gpointer) lane, synapse->lane);
+        graph->lane_order = g_list_prepend(graph->lane_order, synapse->lane);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Fire the synapses in a ready queue, in order, until one is handled
+ *
+ * \param[in,out] cursor  Where to start, updated to where to carry on from
+ * \param[in]     all     Keep going until the end rather than stopping
+ */
+static void
+run_ready_queue(crm_graph_t * graph, GSequenceIter ** cursor, gboolean all, int *log_level)
+{
+    while (g_sequence_iter_is_end(*cursor) == FALSE) {
+        GSequenceIter *current = *cursor;
+        gboolean handled = run_ready_synapse(graph, g_sequence_get(current), log_level);
+
+        /* Firing may have made later synapses ready, pick them up this pass */
+        *cursor = g_sequence_iter_next(current);
+        if (handled) {
+            g_sequence_remove(current);
+            if (all == FALSE) {
+                return;
+            }
+        }
+        /* Deferred, try the next synapse instead */
+    }
+}
+
+/*!
+ * \internal
+ * \brief Fire ready synapses, sharing the batch limit fairly between nodes
+ *
+ * Fencing, remote connections and pseudo actions go first, regardless of the
+ * batch limit, since everything else on the affected nodes is waiting for
+ * them.  Everything else waits in a queue per node, in graph order, and the
+ * queues are served one synapse at a time in turn.  A node that is at its job
+ * limit (as decided by the allowed() callback) just keeps its remaining
+ * synapses for the next pass, so one slow node can't hold up the others or
+ * use up the whole batch limit.
+ */
+static void
+run_ready_by_node(crm_graph_t * graph, int *log_level)
+{
+    GListPtr lpc = NULL;
+    GSequenceIter *iter = g_sequence_get_begin_iter(graph->ready_priority);
+    GSequenceIter **cursors = NULL;
+    int lanes = g_list_length(graph->lane_order);
+    int active = 0;
+    int start = 0;
+    int lane = 0;
+
+    run_ready_queue(graph, &iter, TRUE, log_level);
+    if (lanes == 0) {
+        return;
+    }
+
+    /* Rotate the starting point so the batch limit is shared over time */
+    start = graph->dispatch_round++ % lanes;
+
+    cursors = calloc(lanes, sizeof(GSequenceIter *));
+    for (lpc = graph->lane_order; lpc != NULL; lpc = lpc->next) {
+        cursors[lane++] = g_sequence_get_begin_iter(lpc->data);
+    }
+
+    active = lanes;
+    while (active > 0 && batch_limit_reached(graph) == FALSE) {
+        active = 0;
+        for (lane = 0; lane < lanes; lane++) {
+            GSequenceIter **cursor = &cursors[(start + lane) % lanes];
+
+            if (batch_limit_reached(graph)) {
+                break;
+            }
+
+            /* Synapses that become ready now wait for the next pass, unless
+             * they happen to sort after the cursor
+             */
+            run_ready_queue(graph, cursor, FALSE, log_level);
+            if (g_sequence_iter_is_end(*cursor) == FALSE) {
+                active++;
+            }
+        }
+    }
+    free(cursors);
+}
+
+/*!
+ * \internal
+ * \brief Fire ready synapses in graph order
+ *
+ * Used when nothing can hold a synapse back, which keeps the execution order
+ * (and therefore crm_simulate output) exactly as it has always been.
+ */
+static void
+run_ready_in_order(crm_graph_t * graph, int *log_level)
+{
+    GSequenceIter *iter = g_sequence_get_begin_iter(graph->ready);
+
+    run_ready_queue(graph, &iter, TRUE, log_level);
+}
+
 int
 run_graph(crm_graph_t * graph)
 {
-    GListPtr lpc = NULL;
     int stat_log_level = LOG_DEBUG;
     int pass_result = transition_active;
 
@@ -259,63 +642,27 @@ run_graph(crm_graph_t * graph)
         return transition_complete;
     }
 
+    /* Start from the totals of completed, in-flight and failed synapses */
     graph->fired = 0;
-    graph->pending = 0;
-    graph->skipped = 0;
-    graph->completed = 0;
+    graph->pending = graph->num_pending;
+    graph->skipped = graph->num_failed;
+    graph->completed = graph->num_completed;
     graph->incomplete = 0;
     crm_trace("Entering graph %d callback", graph->id);
 
-    /* Pre-calculate the number of completed and in-flight operations */
-    for (lpc = graph->synapses; lpc != NULL; lpc = lpc->next) {
-        synapse_t *synapse = (synapse_t *) lpc->data;
-
-        if (synapse->confirmed) {
-            crm_trace("Synapse %d complete", synapse->id);
-            graph->completed++;
+    /* Now check if there is work to do, only synapses with all inputs
+     * confirmed can fire so there is no need to look at any others
+     */
+    set_ready_by_node(graph, graph->batch_limit > 0 || graph_fns->allowed != NULL);
+    if (graph->ready_by_node) {
+        run_ready_by_node(graph, &stat_log_level);
 
-        } else if (synapse->failed == FALSE && synapse->executed) {
-            crm_trace("Synapse %d: confirmation pending", synapse->id);
-            graph->pending++;
-        }
+    } else if (graph->ready) {
+        run_ready_in_order(graph, &stat_log_level);
     }
 
-    /* Now check if there is work to do */
-    for (lpc = graph->synapses; lpc != NULL; lpc = lpc->next) {
-        synapse_t *synapse = (synapse_t *) lpc->data;
-
-        if (graph->batch_limit > 0 && graph->pending >= graph->batch_limit) {
-            crm_debug("Throttling output: batch limit (%d) reached", graph->batch_limit);
-            break;
-        } else if (synapse->failed) {
-            graph->skipped++;
-            continue;
-
-        } else if (synapse->confirmed || synapse->executed) {
-            /* Already handled */
-            continue;
-        }
-
-        if (should_fire_synapse(graph, synapse)) {
-            crm_trace("Synapse %d fired", synapse->id);
-            graph->fired++;
-            if(fire_synapse(graph, synapse) == FALSE) {
-                crm_err("Synapse %d failed to fire", synapse->id);
-                stat_log_level = LOG_ERR;
-                graph->abort_priority = INFINITY;
-                graph->incomplete++;
-                graph->fired--;
-            }
-
-            if (synapse->confirmed == FALSE) {
-                graph->pending++;
-            }
-
-        } else {
-            crm_trace("Synapse %d cannot fire", synapse->id);
-            graph->incomplete++;
-        }
-    }
+    /* Those still waiting on inputs are blocked too */
+    graph->incomplete += graph->num_waiting;
 
     if (graph->pending == 0 && graph->fired == 0) {
         graph->complete = TRUE;
@@ -0,0 +1,28 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef TRANSITION_PRIVATE__H
+#  define TRANSITION_PRIVATE__H
+
+/* Include after crm/transition.h */
+
+void graph_assign_lane(crm_graph_t * graph, synapse_t * synapse);
+void graph_ready_add(crm_graph_t * graph, synapse_t * synapse);
+void graph_update_totals(crm_graph_t * graph, synapse_t * synapse);
+
+#endif
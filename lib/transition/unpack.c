@@ -25,6 +25,7 @@
 #include <crm/common/xml.h>
 #include <crm/transition.h>
 #include <sys/stat.h>
+#include "transition_private.h"
 
 CRM_TRACE_INIT_DATA(transitioner);
 
@@ -97,6 +98,7 @@ unpack_synapse(crm_graph_t * new_graph, xmlNode * xml_synapse)
 
     new_synapse = calloc(1, sizeof(synapse_t));
     new_synapse->id = crm_parse_int(ID(xml_synapse), NULL);
+    new_synapse->ready_input = -1;
 
     value = crm_element_value(xml_synapse, XML_CIB_ATTR_PRIORITY);
     if (value != NULL) {
@@ -158,6 +160,101 @@ unpack_synapse(crm_graph_t * new_graph, xmlNode * xml_synapse)
     return new_synapse;
 }
 
+static void
+index_graph_append(GHashTable * index, gpointer key, gpointer value)
+{
+    GListPtr existing = g_hash_table_lookup(index, key);
+
+    if (existing) {
+        /* Don't let the destroy function free the list we're extending */
+        g_hash_table_steal(index, key);
+    }
+    g_hash_table_insert(index, key, g_list_prepend(existing, value));
+}
+
+/* index_graph_append() builds lists backwards, callers expect graph order */
+static void
+index_graph_reverse(GHashTable * index)
+{
+    GListPtr keys = g_hash_table_get_keys(index);
+    GListPtr gIter = NULL;
+
+    for (gIter = keys; gIter != NULL; gIter = gIter->next) {
+        GListPtr values = g_hash_table_lookup(index, gIter->data);
+
+        g_hash_table_steal(index, gIter->data);
+        g_hash_table_insert(index, gIter->data, g_list_reverse(values));
+    }
+    g_list_free(keys);
+}
+
+/*!
+ * \internal
+ * \brief Build the lookup tables used while the graph is executing
+ *
+ * Actions are indexed by id, task key and target node so incoming events can
+ * be matched without walking the whole graph.  We also record which synapse
+ * inputs each action will satisfy, so a confirmed action only updates the
+ * synapses depending on it, decide which node's queue each synapse will wait
+ * in once it is ready, and seed the ready set with the synapses that have no
+ * inputs.
+ */
+static void
+index_graph(crm_graph_t * graph)
+{
+    GListPtr lpc = NULL;
+    GListPtr gIter = NULL;
+
+    graph->dependents = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                                              (GDestroyNotify) g_list_free);
+    graph->actions_by_id = g_hash_table_new(g_direct_hash, g_direct_equal);
+    graph->actions_by_key = g_hash_table_new_full(crm_str_hash, g_str_equal, NULL,
+                                                  (GDestroyNotify) g_list_free);
+    graph->actions_by_node = g_hash_table_new_full(crm_str_hash, g_str_equal, NULL,
+                                                   (GDestroyNotify) g_list_free);
+
+    for (lpc = graph->synapses; lpc != NULL; lpc = lpc->next) {
+        synapse_t *synapse = (synapse_t *) lpc->data;
+
+        for (gIter = synapse->actions; gIter != NULL; gIter = gIter->next) {
+            crm_action_t *action = (crm_action_t *) gIter->data;
+            const char *key = crm_element_value(action->xml, XML_LRM_ATTR_TASK_KEY);
+            const char *node = crm_element_value(action->xml, XML_LRM_ATTR_TARGET_UUID);
+
+            g_hash_table_insert(graph->actions_by_id, GINT_TO_POINTER(action->id), action);
+            if (key) {
+                index_graph_append(graph->actions_by_key, (gpointer) key, action);
+            }
+            if (node) {
+                index_graph_append(graph->actions_by_node, (gpointer) node, action);
+            }
+        }
+
+        for (gIter = synapse->inputs; gIter != NULL; gIter = gIter->next) {
+            crm_action_t *input = (crm_action_t *) gIter->data;
+            index_graph_append(graph->dependents, GINT_TO_POINTER(input->id), input);
+
+            if (input->confirmed == FALSE) {
+                synapse->pending_inputs++;
+            }
+        }
+
+        graph_assign_lane(graph, synapse);
+        if (synapse->pending_inputs == 0) {
+            synapse->ready = TRUE;
+            synapse->ready_usec = graph->start_usec;
+            graph_ready_add(graph, synapse);
+        }
+        graph_update_totals(graph, synapse);
+    }
+
+    graph->lane_order = g_list_reverse(graph->lane_order);
+
+    index_graph_reverse(graph->actions_by_key);
+    index_graph_reverse(graph->actions_by_node);
+    index_graph_reverse(graph->dependents);
+}
+
 crm_graph_t *
 unpack_graph(xmlNode * xml_graph, const char *reference)
 {
@@ -184,6 +281,7 @@ unpack_graph(xmlNode * xml_graph, const char *reference)
     new_graph->transition_timeout = -1;
     new_graph->stonith_timeout = -1;
     new_graph->completion_action = tg_done;
+    new_graph->start_usec = crm_monotonic_usec();
 
     if (reference) {
         new_graph->source = strdup(reference);
@@ -221,10 +319,13 @@ unpack_graph(xmlNode * xml_graph, const char *reference)
             synapse_t *new_synapse = unpack_synapse(new_graph, synapse);
 
             if (new_synapse != NULL) {
-                new_graph->synapses = g_list_append(new_graph->synapses, new_synapse);
+                new_graph->synapses = g_list_prepend(new_graph->synapses, new_synapse);
             }
         }
     }
+    new_graph->synapses = g_list_reverse(new_graph->synapses);
+
+    index_graph(new_graph);
 
     crm_debug("Unpacked transition %d: %d actions in %d synapses",
               new_graph->id, new_graph->num_actions, new_graph->num_synapses);
@@ -272,6 +373,21 @@ destroy_graph(crm_graph_t * graph)
     if (graph == NULL) {
         return;
     }
+
+    /* The indexes are keyed on strings owned by the actions */
+    if (graph->dependents) {
+        g_hash_table_destroy(graph->dependents);
+    }
+    if (graph->actions_by_id) {
+        g_hash_table_destroy(graph->actions_by_id);
+    }
+    if (graph->actions_by_key) {
+        g_hash_table_destroy(graph->actions_by_key);
+    }
+    if (graph->actions_by_node) {
+        g_hash_table_destroy(graph->actions_by_node);
+    }
+
     while (g_list_length(graph->synapses) > 0) {
         synapse_t *synapse = g_list_nth_data(graph->synapses, 0);
 
@@ -279,6 +395,14 @@ destroy_graph(crm_graph_t * graph)
         destroy_synapse(synapse);
     }
 
+    if (graph->ready) {
+        g_sequence_free(graph->ready);
+    }
+    if (graph->lanes) {
+        g_sequence_free(graph->ready_priority);
+        g_hash_table_destroy(graph->lanes);
+        g_list_free(graph->lane_order);
+    }
     free(graph->source);
     free(graph);
 }
@@ -119,25 +119,10 @@ actiontype2text(action_type_e type)
 static crm_action_t *
 find_action(crm_graph_t * graph, int id)
 {
-    GListPtr sIter = NULL;
-
-    if (graph == NULL) {
+    if (graph == NULL || graph->actions_by_id == NULL) {
         return NULL;
     }
-
-    for (sIter = graph->synapses; sIter != NULL; sIter = sIter->next) {
-        GListPtr aIter = NULL;
-        synapse_t *synapse = (synapse_t *) sIter->data;
-
-        for (aIter = synapse->actions; aIter != NULL; aIter = aIter->next) {
-            crm_action_t *action = (crm_action_t *) aIter->data;
-
-            if (action->id == id) {
-                return action;
-            }
-        }
-    }
-    return NULL;
+    return g_hash_table_lookup(graph->actions_by_id, GINT_TO_POINTER(id));
 }
 
 static void
@@ -288,3 +273,101 @@ update_abort_priority(crm_graph_t * graph, int priority,
 
     return change;
 }
+
+static void
+timeline_add_usec(xmlNode * xml, const char *name, crm_graph_t * graph, long long usec)
+{
+    char *value = NULL;
+
+    if (usec <= 0) {
+        return;
+    }
+    value = crm_strdup_printf("%lld", usec - graph->start_usec);
+    crm_xml_add(xml, name, value);
+    free(value);
+}
+
+/*!
+ * \brief Describe when each part of a transition happened
+ *
+ * Times are in microseconds since the graph was unpacked.  Each synapse
+ * records when it became ready, which input made it so and when it fired;
+ * each of its actions records when it was sent, when its result was
+ * processed and when the graph was updated with it, along with the queue
+ * and execution times reported with the result.
+ *
+ * \param[in] graph  Transition graph to describe
+ *
+ * \return Newly allocated XML, which the caller must free
+ */
+xmlNode *
+graph_timeline_xml(crm_graph_t * graph)
+{
+    GListPtr lpc = NULL;
+    GListPtr gIter = NULL;
+    xmlNode *xml = create_xml_node(NULL, XML_TAG_GRAPH_TIMELINE);
+
+    crm_xml_add_int(xml, XML_ATTR_ID, graph->id);
+    crm_xml_add(xml, "source", graph->source);
+    crm_xml_add_int(xml, "batch-limit", graph->batch_limit);
+    crm_xml_add(xml, "complete", graph->complete ? XML_BOOLEAN_TRUE : XML_BOOLEAN_FALSE);
+    crm_xml_add(xml, "abort-reason", graph->abort_reason);
+    crm_xml_add_int(xml, "abort-priority", graph->abort_priority);
+    timeline_add_usec(xml, "duration", graph, graph->complete_usec);
+
+    for (lpc = graph->synapses; lpc != NULL; lpc = lpc->next) {
+        synapse_t *synapse = (synapse_t *) lpc->data;
+        xmlNode *s_xml = create_xml_node(xml, "synapse");
+        char *inputs = NULL;
+        int len = 0;
+
+        crm_xml_add_int(s_xml, XML_ATTR_ID, synapse->id);
+        crm_xml_add_int(s_xml, XML_CIB_ATTR_PRIORITY, synapse->priority);
+        if (synapse->ready) {
+            /* Synapses ready from the start have ready_usec == start_usec */
+            char *value = crm_strdup_printf("%lld", synapse->ready_usec - graph->start_usec);
+
+            crm_xml_add(s_xml, "ready", value);
+            free(value);
+        }
+        timeline_add_usec(s_xml, "fired", graph, synapse->fired_usec);
+        if (synapse->ready_input >= 0) {
+            crm_xml_add_int(s_xml, "ready-input", synapse->ready_input);
+        }
+
+        for (gIter = synapse->inputs; gIter != NULL; gIter = gIter->next) {
+            crm_action_t *input = (crm_action_t *) gIter->data;
+
+            inputs = realloc_safe(inputs, len + 13);
+            len += sprintf(inputs + len, "%s%d", len ? " " : "", input->id);
+        }
+        crm_xml_add(s_xml, "inputs", inputs);
+        free(inputs);
+
+        for (gIter = synapse->actions; gIter != NULL; gIter = gIter->next) {
+            crm_action_t *action = (crm_action_t *) gIter->data;
+            xmlNode *a_xml = create_xml_node(s_xml, crm_element_name(action->xml));
+            const char *key = crm_element_value(action->xml, XML_LRM_ATTR_TASK_KEY);
+
+            if (key == NULL) {
+                key = crm_element_value(action->xml, XML_LRM_ATTR_TASK);
+            }
+
+            crm_xml_add_int(a_xml, XML_ATTR_ID, action->id);
+            crm_xml_add(a_xml, XML_LRM_ATTR_TASK_KEY, key);
+            crm_xml_add(a_xml, XML_LRM_ATTR_TARGET,
+                        crm_element_value(action->xml, XML_LRM_ATTR_TARGET));
+            timeline_add_usec(a_xml, "sent", graph, action->sent_usec);
+            timeline_add_usec(a_xml, "result", graph, action->result_usec);
+            timeline_add_usec(a_xml, "confirmed", graph, action->confirmed_usec);
+            if (action->result_usec > 0) {
+                crm_xml_add_int(a_xml, XML_RSC_OP_T_QUEUE, action->queue_ms);
+                crm_xml_add_int(a_xml, XML_RSC_OP_T_EXEC, action->exec_ms);
+            }
+            if (action->failed) {
+                crm_xml_add(a_xml, "failed", XML_BOOLEAN_TRUE);
+            }
+        }
+    }
+    return xml;
+}
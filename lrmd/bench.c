@@ -0,0 +1,612 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/*
+ * Measure how a running lrmd copes with many recurring monitors
+ *
+ * Registers a number of resources with a local lrmd (or pacemaker_remoted,
+ * over TLS on the loopback interface), starts recurring monitors on them and
+ * reports periodically:
+ *
+ *  - latency: from requesting a monitor until its first result arrives
+ *  - drift: how far the gap between successive results of one monitor
+ *    strays from its interval
+ *  - queue: how long results say operations waited inside the lrmd
+ *  - CPU used per result, by the daemon and by this client
+ *  - the daemon's resident memory
+ *
+ * Unless --agent is given, monitors run a no-op OCF agent that is installed
+ * for the duration of the run, so that what is measured is the lrmd, the
+ * services library and the client library rather than the agent.
+ */
+
+#include <crm_internal.h>
+
+#include <glib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include <crm/crm.h>
+#include <crm/services.h>
+#include <crm/common/mainloop.h>
+#include <crm/lrmd.h>
+
+#define BENCH_PROVIDER  "pacemaker-bench"
+#define BENCH_AGENT     "noop"
+#define BENCH_AGENT_DIR OCF_ROOT_DIR "/resource.d/" BENCH_PROVIDER
+
+/* *INDENT-OFF* */
+static struct crm_option long_options[] = {
+    {"help",      0, 0, '?'},
+    {"verbose",   0, 0, 'V', "\tPrint out logs and events to screen"},
+    {"resources", 1, 0, 'r', "Number of resources to register (default 100)"},
+    {"monitors",  1, 0, 'm', "Number of recurring monitors, spread over the resources (default one each)"},
+    {"interval",  1, 0, 'i', "Monitor interval in ms (default 10000).  Extra monitors on a resource use\n"
+                             "\t\t\t  multiples of a second more, as each needs a different interval"},
+    {"duration",  1, 0, 'd', "Seconds to run the monitors for (default 60)"},
+    {"report",    1, 0, 'R', "\tSeconds between reports (default 5)"},
+    {"agent",     1, 0, 'a', "\tstandard:provider:type of the agent to monitor (default a no-op OCF agent)"},
+    {"tls",       0, 0, 'S', "\tConnect to pacemaker_remoted on the loopback interface instead"},
+    {"port",      1, 0, 'p', "\tPort to use with --tls (default 3121)"},
+    {"pid",       1, 0, 'P', "\tProcess ID of the daemon (default found by name)"},
+    {"-spacer-",  1, 0, '-', "\nExamples:"},
+    {"-spacer-",  1, 0, '-', "Run 1000 monitors every two seconds against the local lrmd:", pcmk_option_paragraph},
+    {"-spacer-",  1, 0, '-', " lrmd_bench --resources 1000 --interval 2000", pcmk_option_example},
+    {"-spacer-",  1, 0, '-', "Do the same through pacemaker_remoted for five minutes:", pcmk_option_paragraph},
+    {"-spacer-",  1, 0, '-', " lrmd_bench --resources 1000 --interval 2000 --tls --duration 300", pcmk_option_example},
+    {0, 0, 0, 0}
+};
+/* *INDENT-ON* */
+
+static struct {
+    int resources;
+    int monitors;
+    int interval;
+    int duration;
+    int report;
+    int port;
+    int pid;
+    gboolean tls;
+    char *standard;
+    const char *provider;
+    const char *type;
+} options;
+
+typedef struct bench_monitor_s {
+    char *rsc_id;
+    int interval;
+    long long requested;        /* crm_monotonic_usec() values */
+    long long last;
+} bench_monitor_t;
+
+typedef struct bench_stat_s {
+    unsigned int count;
+    long long sum;
+    long long max;
+} bench_stat_t;
+
+/* One per report, and one for the whole run */
+typedef struct bench_period_s {
+    long long start;
+    long long cpu;              /* ours, in usec */
+    long long daemon_cpu;       /* in usec, or -1 if unknown */
+    unsigned int results;
+    unsigned int failed;
+    bench_stat_t latency;
+    bench_stat_t drift;
+    bench_stat_t queue;
+} bench_period_t;
+
+static GMainLoop *mainloop = NULL;
+static lrmd_t *lrmd_conn = NULL;
+static bench_monitor_t *monitors = NULL;
+static bench_period_t period;
+static bench_period_t total;
+static long max_rss = 0;
+static gboolean agent_installed = FALSE;
+static int exit_code = 0;
+
+static void
+stat_add(bench_stat_t * stat, long long value)
+{
+    stat->count++;
+    stat->sum += value;
+    stat->max = QB_MAX(stat->max, value);
+}
+
+static double
+stat_avg(bench_stat_t * stat)
+{
+    return stat->count? (double) stat->sum / stat->count : 0.0;
+}
+
+static long long
+cpu_usec(void)
+{
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL
+        + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+/*!
+ * \internal
+ * \brief Find a process by name, as it appears in /proc/<pid>/comm
+ */
+static int
+find_daemon(const char *name)
+{
+    int pid = 0;
+    DIR *dp = opendir("/proc");
+    struct dirent *entry = NULL;
+
+    if (dp == NULL) {
+        return 0;
+    }
+
+    while (pid == 0 && (entry = readdir(dp)) != NULL) {
+        char comm[64];
+        char *path = NULL;
+        FILE *file = NULL;
+
+        if (entry->d_name[0] < '0' || entry->d_name[0] > '9') {
+            continue;
+        }
+
+        path = crm_strdup_printf("/proc/%s/comm", entry->d_name);
+        file = fopen(path, "r");
+        free(path);
+        if (file == NULL) {
+            continue;
+        }
+
+        if (fgets(comm, sizeof(comm), file)) {
+            comm[strcspn(comm, "\n")] = 0;
+            if (safe_str_eq(comm, name)) {
+                pid = crm_parse_int(entry->d_name, "0");
+            }
+        }
+        fclose(file);
+    }
+    closedir(dp);
+    return pid;
+}
+
+/*!
+ * \internal
+ * \brief Read a process's CPU time (in usec) and resident memory (in kB)
+ *
+ * \return TRUE on success, FALSE if the process couldn't be read
+ */
+static gboolean
+daemon_usage(int pid, long long *cpu, long *rss)
+{
+    char buffer[1024];
+    char *path = NULL;
+    char *fields = NULL;
+    FILE *file = NULL;
+    size_t len = 0;
+    unsigned long utime = 0;
+    unsigned long stime = 0;
+    long pages = 0;
+
+    if (pid <= 0) {
+        return FALSE;
+    }
+
+    path = crm_strdup_printf("/proc/%d/stat", pid);
+    file = fopen(path, "r");
+    free(path);
+    if (file == NULL) {
+        return FALSE;
+    }
+    len = fread(buffer, 1, sizeof(buffer) - 1, file);
+    fclose(file);
+    buffer[len] = 0;
+
+    /* The name may contain anything, so skip past its closing parenthesis */
+    fields = strrchr(buffer, ')');
+    if (fields == NULL
+        || sscanf(fields + 2,
+                  "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu %*d %*d %*d %*d %*d %*d %*u %*u %ld",
+                  &utime, &stime, &pages) != 3) {
+        return FALSE;
+    }
+
+    *cpu = (utime + stime) * 1000000LL / sysconf(_SC_CLK_TCK);
+    *rss = pages * (getpagesize() / 1024);
+    return TRUE;
+}
+
+static void
+period_start(bench_period_t * p)
+{
+    long rss = 0;
+
+    memset(p, 0, sizeof(bench_period_t));
+    p->start = crm_monotonic_usec();
+    p->cpu = cpu_usec();
+    if (daemon_usage(options.pid, &p->daemon_cpu, &rss) == FALSE) {
+        p->daemon_cpu = -1;
+    }
+}
+
+static void
+period_print(bench_period_t * p, const char *label)
+{
+    long rss = 0;
+    long long daemon_cpu = 0;
+    long long now = crm_monotonic_usec();
+    double elapsed = QB_MAX(now - p->start, 1) / 1000000.0;
+    unsigned int results = QB_MAX(p->results, 1);
+    char *daemon = NULL;
+
+    if (p->daemon_cpu >= 0 && daemon_usage(options.pid, &daemon_cpu, &rss)) {
+        max_rss = QB_MAX(max_rss, rss);
+        daemon = crm_strdup_printf("daemon %.1fus/result %ldkB",
+                                   (double) (daemon_cpu - p->daemon_cpu) / results, rss);
+    }
+
+    printf("%s %.1fs: %u results (%u failed) %.1f/s"
+           " | latency avg %.1fms max %lldms"
+           " | drift avg %.1fms max %lldms"
+           " | queue avg %.1fms max %lldms"
+           " | client %.1fus/result | %s\n",
+           label, (now - total.start) / 1000000.0, p->results, p->failed, p->results / elapsed,
+           stat_avg(&p->latency) / 1000.0, p->latency.max / 1000,
+           stat_avg(&p->drift) / 1000.0, p->drift.max / 1000,
+           stat_avg(&p->queue), p->queue.max,
+           (double) (cpu_usec() - p->cpu) / results,
+           daemon? daemon : "daemon not found");
+    fflush(stdout);
+    free(daemon);
+}
+
+static void
+bench_event(lrmd_event_data_t * event)
+{
+    int index = 0;
+    long long now = crm_monotonic_usec();
+    bench_monitor_t *mon = NULL;
+
+    if (event->type == lrmd_event_disconnect) {
+        crm_err("Lost connection to the daemon");
+        exit_code = 1;
+        g_main_quit(mainloop);
+        return;
+
+    } else if (event->type != lrmd_event_exec_complete || event->user_data == NULL) {
+        return;
+    }
+
+    index = crm_parse_int(event->user_data, "-1");
+    if (index < 0 || index >= options.monitors || event->op_status == PCMK_LRM_OP_CANCELLED) {
+        return;
+    }
+    mon = &monitors[index];
+
+    period.results++;
+    total.results++;
+    if (event->rc != PCMK_OCF_OK || event->op_status != PCMK_LRM_OP_DONE) {
+        crm_info("%s monitor failed: rc=%d status=%d", mon->rsc_id, event->rc, event->op_status);
+        period.failed++;
+        total.failed++;
+    }
+
+    if (mon->last == 0) {
+        stat_add(&period.latency, now - mon->requested);
+        stat_add(&total.latency, now - mon->requested);
+    } else {
+        long long drift = now - mon->last - mon->interval * 1000LL;
+
+        drift = (drift < 0)? -drift : drift;
+        stat_add(&period.drift, drift);
+        stat_add(&total.drift, drift);
+    }
+    mon->last = now;
+
+    stat_add(&period.queue, event->queue_time);
+    stat_add(&total.queue, event->queue_time);
+}
+
+static gboolean
+bench_report(gpointer user_data)
+{
+    period_print(&period, "report");
+    period_start(&period);
+    return TRUE;
+}
+
+static gboolean
+bench_finish(gpointer user_data)
+{
+    g_main_quit(mainloop);
+    return FALSE;
+}
+
+static void
+bench_shutdown(int nsig)
+{
+    g_main_quit(mainloop);
+}
+
+static gboolean
+install_agent(void)
+{
+    FILE *file = NULL;
+    const char *path = BENCH_AGENT_DIR "/" BENCH_AGENT;
+
+    if (mkdir(BENCH_AGENT_DIR, 0755) < 0 && errno != EEXIST) {
+        crm_perror(LOG_ERR, "Could not create %s", BENCH_AGENT_DIR);
+        return FALSE;
+    }
+
+    file = fopen(path, "w");
+    if (file == NULL) {
+        crm_perror(LOG_ERR, "Could not create %s", path);
+        return FALSE;
+    }
+    fprintf(file, "#!/bin/sh\nexit 0\n");
+    fclose(file);
+    chmod(path, 0755);
+    agent_installed = TRUE;
+    return TRUE;
+}
+
+static void
+remove_agent(void)
+{
+    if (agent_installed) {
+        unlink(BENCH_AGENT_DIR "/" BENCH_AGENT);
+        rmdir(BENCH_AGENT_DIR);
+    }
+}
+
+static gboolean
+parse_agent(const char *agent)
+{
+    char *provider = NULL;
+    char *type = NULL;
+
+    options.standard = strdup(agent);
+    provider = strchr(options.standard, ':');
+    if (provider == NULL) {
+        return FALSE;
+    }
+    *provider++ = 0;
+    type = strchr(provider, ':');
+    if (type == NULL) {
+        options.type = provider;
+    } else {
+        *type++ = 0;
+        options.provider = provider;
+        options.type = type;
+    }
+    return TRUE;
+}
+
+static int
+bench_start(void)
+{
+    int lpc = 0;
+    int rc = pcmk_ok;
+
+    for (lpc = 0; lpc < options.resources; lpc++) {
+        char *id = crm_strdup_printf("bench-%d", lpc);
+
+        rc = lrmd_conn->cmds->register_rsc(lrmd_conn, id, options.standard, options.provider,
+                                           options.type, 0);
+        free(id);
+        if (rc < 0) {
+            fprintf(stderr, "Could not register resources: %s\n", pcmk_strerror(rc));
+            return rc;
+        }
+    }
+
+    period_start(&total);
+    period = total;
+
+    monitors = calloc(options.monitors, sizeof(bench_monitor_t));
+    for (lpc = 0; lpc < options.monitors; lpc++) {
+        bench_monitor_t *mon = &monitors[lpc];
+        char *index = crm_itoa(lpc);
+        int delay = (int) ((long long) lpc * options.interval / options.monitors);
+
+        mon->rsc_id = crm_strdup_printf("bench-%d", lpc % options.resources);
+        mon->interval = options.interval + (lpc / options.resources) * 1000;
+        mon->requested = crm_monotonic_usec() + delay * 1000LL;
+
+        /* Spread the first runs over the interval, as a cluster's would be */
+        rc = lrmd_conn->cmds->exec(lrmd_conn, mon->rsc_id, "monitor", index, mon->interval,
+                                   mon->interval, delay, 0, NULL);
+        free(index);
+        if (rc < 0) {
+            fprintf(stderr, "Could not start monitor of %s: %s\n", mon->rsc_id, pcmk_strerror(rc));
+            return rc;
+        }
+    }
+    return pcmk_ok;
+}
+
+static void
+bench_stop(void)
+{
+    int lpc = 0;
+
+    if (lrmd_conn->cmds->is_connected(lrmd_conn) == FALSE) {
+        return;
+    }
+
+    for (lpc = 0; monitors && lpc < options.monitors; lpc++) {
+        lrmd_conn->cmds->cancel(lrmd_conn, monitors[lpc].rsc_id, "monitor",
+                                monitors[lpc].interval);
+    }
+    for (lpc = 0; lpc < options.resources; lpc++) {
+        char *id = crm_strdup_printf("bench-%d", lpc);
+
+        lrmd_conn->cmds->unregister_rsc(lrmd_conn, id, 0);
+        free(id);
+    }
+    lrmd_conn->cmds->disconnect(lrmd_conn);
+}
+
+int
+main(int argc, char **argv)
+{
+    int flag = 0;
+    int argerr = 0;
+    int option_index = 0;
+    int lpc = 0;
+    int rc = pcmk_ok;
+    const char *agent = NULL;
+
+    options.resources = 100;
+    options.interval = 10000;
+    options.duration = 60;
+    options.report = 5;
+    options.port = DEFAULT_REMOTE_PORT;
+
+    crm_set_options(NULL, "[options]", long_options,
+                    "Measure how the lrmd copes with many recurring monitors\n");
+
+    while (1) {
+        flag = crm_get_option(argc, argv, &option_index);
+        if (flag == -1)
+            break;
+
+        switch (flag) {
+            case '?':
+                crm_help(flag, EX_OK);
+                break;
+            case 'V':
+                crm_bump_log_level(argc, argv);
+                break;
+            case 'r':
+                options.resources = crm_parse_int(optarg, "100");
+                break;
+            case 'm':
+                options.monitors = crm_parse_int(optarg, "0");
+                break;
+            case 'i':
+                options.interval = crm_parse_int(optarg, "10000");
+                break;
+            case 'd':
+                options.duration = crm_parse_int(optarg, "60");
+                break;
+            case 'R':
+                options.report = crm_parse_int(optarg, "5");
+                break;
+            case 'a':
+                agent = optarg;
+                break;
+            case 'S':
+                options.tls = TRUE;
+                break;
+            case 'p':
+                options.port = crm_parse_int(optarg, "0");
+                break;
+            case 'P':
+                options.pid = crm_parse_int(optarg, "0");
+                break;
+            default:
+                ++argerr;
+                break;
+        }
+    }
+
+    if (options.monitors <= 0) {
+        options.monitors = options.resources;
+    }
+    if (agent && parse_agent(agent) == FALSE) {
+        ++argerr;
+    }
+    if (argerr || options.resources < 1 || options.interval < 1 || options.duration < 1) {
+        crm_help('?', EX_USAGE);
+    }
+
+    crm_log_init(NULL, LOG_INFO, FALSE, FALSE, argc, argv, FALSE);
+
+    if (agent == NULL) {
+        if (install_agent() == FALSE) {
+            return 1;
+        }
+        options.standard = strdup("ocf");
+        options.provider = BENCH_PROVIDER;
+        options.type = BENCH_AGENT;
+    }
+
+    if (options.pid <= 0) {
+        /* /proc/<pid>/comm holds at most 15 characters */
+        options.pid = find_daemon(options.tls? "pacemaker_remot" : "lrmd");
+    }
+
+    if (options.tls) {
+        lrmd_conn = lrmd_remote_api_new(NULL, "localhost", options.port);
+    } else {
+        lrmd_conn = lrmd_api_new();
+    }
+    lrmd_conn->cmds->set_callback(lrmd_conn, bench_event);
+
+    rc = lrmd_conn->cmds->connect(lrmd_conn, "lrmd_bench", NULL);
+    if (rc < 0) {
+        fprintf(stderr, "Could not connect to %s: %s\n",
+                options.tls? "pacemaker_remoted" : "lrmd", pcmk_strerror(rc));
+        exit_code = 1;
+
+    } else {
+        printf("Running %d monitors of %d %s:%s:%s resources every %dms for %ds via %s\n",
+               options.monitors, options.resources, options.standard,
+               options.provider? options.provider : "", options.type, options.interval,
+               options.duration, options.tls? "TLS" : "IPC");
+
+        mainloop = g_main_new(FALSE);
+        mainloop_add_signal(SIGTERM, bench_shutdown);
+        mainloop_add_signal(SIGINT, bench_shutdown);
+        if (bench_start() == pcmk_ok) {
+            if (options.report > 0) {
+                g_timeout_add_seconds(options.report, bench_report, NULL);
+            }
+            g_timeout_add_seconds(options.duration, bench_finish, NULL);
+            g_main_run(mainloop);
+
+            period_print(&total, "total");
+            if (max_rss) {
+                printf("daemon peak resident memory %ldkB\n", max_rss);
+            }
+        } else {
+            exit_code = 1;
+        }
+        bench_stop();
+    }
+
+    lrmd_api_delete(lrmd_conn);
+    remove_agent();
+
+    for (lpc = 0; monitors && lpc < options.monitors; lpc++) {
+        free(monitors[lpc].rsc_id);
+    }
+    free(monitors);
+    free(options.standard);
+    return exit_code;
+}
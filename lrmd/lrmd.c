@@ -86,12 +86,19 @@ typedef struct lrmd_cmd_s {
     int last_notify_op_status;
     int last_pid;
 
+    /* Executor bookkeeping */
+    int exec_class;
+    gboolean exec_slot;         /* counts against the concurrency limit */
+    long long queued_usec;
+    long long started_usec;
+
     GHashTable *params;
 } lrmd_cmd_t;
 
 static void cmd_finalize(lrmd_cmd_t * cmd, lrmd_rsc_t * rsc);
 static gboolean lrmd_rsc_dispatch(gpointer user_data);
 static void cancel_all_recurring(lrmd_rsc_t * rsc, const char *client_id);
+static void exec_slot_release(lrmd_cmd_t * cmd);
 
 static void
 log_finished(lrmd_cmd_t * cmd, int exec_time, int queue_time)
@@ -208,11 +215,12 @@ create_lrmd_cmd(xmlNode * msg, crm_client_t * client, lrmd_rsc_t *rsc)
 static void
 free_lrmd_cmd(lrmd_cmd_t * cmd)
 {
+    exec_slot_release(cmd);
     if (cmd->stonith_recurring_id) {
-        g_source_remove(cmd->stonith_recurring_id);
+        mainloop_wheel_remove(cmd->stonith_recurring_id);
     }
     if (cmd->delay_id) {
-        g_source_remove(cmd->delay_id);
+        mainloop_wheel_remove(cmd->delay_id);
     }
     if (cmd->params) {
         g_hash_table_destroy(cmd->params);
@@ -247,6 +255,7 @@ stonith_recurring_op_helper(gpointer data)
      * to be executed */
     rsc->recurring_ops = g_list_remove(rsc->recurring_ops, cmd);
     rsc->pending_ops = g_list_append(rsc->pending_ops, cmd);
+    cmd->queued_usec = crm_monotonic_usec();
 #ifdef HAVE_SYS_TIMEB_H
     ftime(&cmd->t_queue);
     if (cmd->t_first_queue.time == 0) {
@@ -265,6 +274,7 @@ start_delay_helper(gpointer data)
     lrmd_rsc_t *rsc = NULL;
 
     cmd->delay_id = 0;
+    cmd->queued_usec = crm_monotonic_usec();
     rsc = cmd->rsc_id ? g_hash_table_lookup(rsc_list, cmd->rsc_id) : NULL;
 
     if (rsc) {
@@ -323,7 +333,7 @@ merge_dup:
     if (safe_str_eq(rsc->class, "stonith")) {
         /* if we are waiting for the next interval, kick it off now */
         if (dup_pending == TRUE) {
-            g_source_remove(cmd->stonith_recurring_id);
+            mainloop_wheel_remove(cmd->stonith_recurring_id);
             cmd->stonith_recurring_id = 0;
             stonith_recurring_op_helper(cmd);
         }
@@ -358,6 +368,7 @@ schedule_lrmd_cmd(lrmd_rsc_t * rsc, lrmd_cmd_t * cmd)
     }
 
     rsc->pending_ops = g_list_append(rsc->pending_ops, cmd);
+    cmd->queued_usec = crm_monotonic_usec();
 #ifdef HAVE_SYS_TIMEB_H
     ftime(&cmd->t_queue);
     if (cmd->t_first_queue.time == 0) {
@@ -367,7 +378,7 @@ schedule_lrmd_cmd(lrmd_rsc_t * rsc, lrmd_cmd_t * cmd)
     mainloop_set_trigger(rsc->work);
 
     if (cmd->start_delay) {
-        cmd->delay_id = g_timeout_add(cmd->start_delay, start_delay_helper, cmd);
+        cmd->delay_id = mainloop_wheel_add(cmd->start_delay, 0, start_delay_helper, cmd);
     }
 }
 
@@ -409,6 +420,188 @@ send_client_notify(gpointer key, gpointer value, gpointer user_data)
     }
 }
 
+/*
+ * Operation results are not sent as soon as they are known, but collected for
+ * up to PCMK_lrmd_notify_window milliseconds (or LRMD_NOTIFY_BATCH_MAX
+ * results) and then sent to each client that supports it as a single
+ * LRMD_OP_NOTIFY_BATCH notification, so that a burst of results (such as
+ * during mass starts) costs one message per client rather than one per result.
+ * Other notifications flush the batch first, so the order clients see is
+ * unchanged.
+ *
+ * Local clients that ask for it get results packed by lrmd_event_pack()
+ * instead of as XML, and XML is only built when a client still needs it.
+ */
+
+#define LRMD_NOTIFY_BATCH_MAX 100
+
+typedef struct notify_entry_s {
+    xmlNode *notify;            /* NULL if no client needed XML */
+    char *packed;               /* NULL if no client accepted binary */
+    unsigned int packed_len;
+    char *client_id;            /* only send to this client, if not NULL */
+} notify_entry_t;
+
+static GList *notify_batch = NULL;
+static int notify_batch_len = 0;
+static unsigned int notify_batch_packed = 0;   /* total size of packed results */
+static int notify_window = -1;
+static mainloop_timer_t *notify_timer = NULL;
+
+static void
+notify_entry_free(gpointer data)
+{
+    notify_entry_t *entry = data;
+
+    free_xml(entry->notify);
+    free(entry->packed);
+    free(entry->client_id);
+    free(entry);
+}
+
+static void
+notify_batch_flush(void)
+{
+    GList *gIter = NULL;
+    GHashTableIter iter;
+    crm_client_t *client = NULL;
+
+    if (notify_batch == NULL) {
+        return;
+    }
+    if (notify_timer) {
+        mainloop_timer_stop(notify_timer);
+    }
+
+    crm_trace("Sending batch of %d operation results", notify_batch_len);
+
+    g_hash_table_iter_init(&iter, client_connections);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) & client)) {
+        xmlNode *batch = NULL;
+        char *packed = NULL;
+        unsigned int packed_len = 0;
+
+        for (gIter = notify_batch; gIter != NULL; gIter = gIter->next) {
+            notify_entry_t *entry = gIter->data;
+
+            if (entry->client_id && safe_str_neq(entry->client_id, client->id)) {
+                continue;
+
+            } else if (is_set(client->flags, crm_client_flag_binary_notify)) {
+                if (entry->packed == NULL) {
+                    /* Client signed on after the result was known */
+                    continue;
+
+                } else if (packed == NULL) {
+                    packed = malloc(LRMD_BINARY_MAGIC_LEN + notify_batch_packed);
+                    CRM_ASSERT(packed != NULL);
+                    memcpy(packed, LRMD_BINARY_MAGIC, LRMD_BINARY_MAGIC_LEN);
+                    packed_len = LRMD_BINARY_MAGIC_LEN;
+                }
+                memcpy(packed + packed_len, entry->packed, entry->packed_len);
+                packed_len += entry->packed_len;
+                continue;
+
+            } else if (entry->notify == NULL) {
+                continue;
+
+            } else if (is_not_set(client->flags, crm_client_flag_batch_notify)) {
+                send_client_notify(client->id, client, entry->notify);
+                continue;
+            }
+
+            if (batch == NULL) {
+                batch = create_xml_node(NULL, T_LRMD_NOTIFY);
+                crm_xml_add(batch, F_LRMD_ORIGIN, __FUNCTION__);
+                crm_xml_add(batch, F_LRMD_OPERATION, LRMD_OP_NOTIFY_BATCH);
+            }
+            add_node_copy(batch, entry->notify);
+        }
+
+        if (batch) {
+            send_client_notify(client->id, client, batch);
+            free_xml(batch);
+        }
+
+        if (packed && lrmd_server_send_binary(client, packed, packed_len) <= 0) {
+            crm_warn("Notification of client %s/%s failed", client->name, client->id);
+        }
+    }
+
+    g_list_free_full(notify_batch, notify_entry_free);
+    notify_batch = NULL;
+    notify_batch_len = 0;
+    notify_batch_packed = 0;
+}
+
+static gboolean
+notify_batch_timeout(gpointer data)
+{
+    notify_batch_flush();
+    return FALSE;
+}
+
+/*!
+ * \internal
+ * \brief Check which forms of operation result the clients to be notified need
+ *
+ * \param[in]  client_id  Only check this client, if not NULL
+ * \param[out] binary     Whether any client accepts binary results
+ *
+ * \return TRUE if any client needs results as XML
+ */
+static gboolean
+notify_clients_need(const char *client_id, gboolean * binary)
+{
+    gboolean xml = FALSE;
+    GHashTableIter iter;
+    crm_client_t *client = NULL;
+
+    *binary = FALSE;
+    g_hash_table_iter_init(&iter, client_connections);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) & client)) {
+        if (client_id && safe_str_neq(client_id, client->id)) {
+            continue;
+        } else if (is_set(client->flags, crm_client_flag_binary_notify)) {
+            *binary = TRUE;
+        } else {
+            xml = TRUE;
+        }
+    }
+    return xml;
+}
+
+/* Takes ownership of notify and packed */
+static void
+notify_batch_add(xmlNode * notify, char *packed, unsigned int packed_len, const char *client_id)
+{
+    notify_entry_t *entry = NULL;
+
+    if (notify_window < 0) {
+        notify_window = crm_parse_int(daemon_option("lrmd_notify_window"), "10");
+        if (notify_window > 0) {
+            notify_timer = mainloop_timer_add("lrmd-notify", notify_window, FALSE,
+                                              notify_batch_timeout, NULL);
+        }
+    }
+
+    entry = calloc(1, sizeof(notify_entry_t));
+    entry->notify = notify;
+    entry->packed = packed;
+    entry->packed_len = packed ? packed_len : 0;
+    entry->client_id = client_id ? strdup(client_id) : NULL;
+    notify_batch = g_list_append(notify_batch, entry);
+    notify_batch_len++;
+    notify_batch_packed += entry->packed_len;
+
+    if (notify_timer == NULL || notify_batch_len >= LRMD_NOTIFY_BATCH_MAX) {
+        notify_batch_flush();
+
+    } else if (mainloop_timer_running(notify_timer) == FALSE) {
+        mainloop_timer_start(notify_timer);
+    }
+}
+
 #ifdef HAVE_SYS_TIMEB_H
 /*!
  * \internal
@@ -468,6 +661,11 @@ send_cmd_complete_notify(lrmd_cmd_t * cmd)
     int exec_time = 0;
     int queue_time = 0;
     xmlNode *notify = NULL;
+    char *packed = NULL;
+    unsigned int packed_len = 0;
+    gboolean binary = FALSE;
+    gboolean need_xml = FALSE;
+    const char *client_id = NULL;
 
 #ifdef HAVE_SYS_TIMEB_H
     exec_time = time_diff_ms(NULL, &cmd->t_run);
@@ -493,6 +691,50 @@ send_cmd_complete_notify(lrmd_cmd_t * cmd)
     cmd->last_notify_rc = cmd->exec_rc;
     cmd->last_notify_op_status = cmd->lrmd_op_status;
 
+    if (cmd->client_id && (cmd->call_opts & lrmd_opt_notify_orig_only)) {
+        if (crm_client_get_by_id(cmd->client_id) == NULL) {
+            return;
+        }
+        client_id = cmd->client_id;
+    }
+
+    need_xml = notify_clients_need(client_id, &binary);
+    if (need_xml == FALSE && binary == FALSE) {
+        return;
+    }
+
+    if (binary) {
+        lrmd_event_data_t event;
+
+        memset(&event, 0, sizeof(event));
+        event.type = lrmd_event_exec_complete;
+        event.rsc_id = cmd->rsc_id;
+        event.op_type = cmd->real_action? cmd->real_action : cmd->action;
+        event.user_data = cmd->userdata_str;
+        event.call_id = cmd->call_id;
+        event.timeout = cmd->timeout;
+        event.interval = cmd->interval;
+        event.start_delay = cmd->start_delay;
+        event.rsc_deleted = cmd->rsc_deleted;
+        event.rc = cmd->exec_rc;
+        event.op_status = cmd->lrmd_op_status;
+        event.output = cmd->output;
+        event.exit_reason = cmd->exit_reason;
+        event.params = cmd->params;
+#ifdef HAVE_SYS_TIMEB_H
+        event.t_run = cmd->t_run.time;
+        event.t_rcchange = cmd->t_rcchange.time;
+        event.exec_time = exec_time;
+        event.queue_time = queue_time;
+#endif
+        packed = lrmd_event_pack(&event, &packed_len);
+
+        if (need_xml == FALSE) {
+            notify_batch_add(NULL, packed, packed_len, client_id);
+            return;
+        }
+    }
+
     notify = create_xml_node(NULL, T_LRMD_NOTIFY);
 
     crm_xml_add(notify, F_LRMD_ORIGIN, __FUNCTION__);
@@ -535,17 +777,7 @@ send_cmd_complete_notify(lrmd_cmd_t * cmd)
         }
     }
 
-    if (cmd->client_id && (cmd->call_opts & lrmd_opt_notify_orig_only)) {
-        crm_client_t *client = crm_client_get_by_id(cmd->client_id);
-
-        if (client) {
-            send_client_notify(client->id, client, notify);
-        }
-    } else {
-        g_hash_table_foreach(client_connections, send_client_notify, notify);
-    }
-
-    free_xml(notify);
+    notify_batch_add(notify, packed, packed_len, client_id);
 }
 
 static void
@@ -566,6 +798,7 @@ send_generic_notify(int rc, xmlNode * request)
     crm_xml_add(notify, F_LRMD_OPERATION, op);
     crm_xml_add(notify, F_LRMD_RSC_ID, rsc_id);
 
+    notify_batch_flush();
     g_hash_table_foreach(client_connections, send_client_notify, notify);
 
     free_xml(notify);
@@ -591,6 +824,7 @@ cmd_finalize(lrmd_cmd_t * cmd, lrmd_rsc_t * rsc)
     crm_trace("Resource operation rsc:%s action:%s completed (%p %p)", cmd->rsc_id, cmd->action,
               rsc ? rsc->active : NULL, cmd);
 
+    exec_slot_release(cmd);
     if (rsc && (rsc->active == cmd)) {
         rsc->active = NULL;
         mainloop_set_trigger(rsc->work);
@@ -774,6 +1008,7 @@ notify_of_new_client(crm_client_t *new_client)
     crm_xml_add(notify, F_LRMD_ORIGIN, __FUNCTION__);
     crm_xml_add(notify, F_LRMD_OPERATION, LRMD_OP_NEW_CLIENT);
 
+    notify_batch_flush();
     g_hash_table_iter_init(&iter, client_connections);
     while (g_hash_table_iter_next(&iter, (gpointer *) & key, (gpointer *) & client)) {
 
@@ -829,6 +1064,26 @@ parse_exit_reason(const char *output)
     return reason;
 }
 
+/*!
+ * \internal
+ * \brief Whether agent output should be passed on to clients
+ *
+ * With PCMK_agent_output_keep=no, only the exit reason of an operation is
+ * kept, so its output never reaches the crmd (or its logs).
+ */
+static gboolean
+keep_agent_output(void)
+{
+    static int keep = -1;
+
+    if (keep < 0) {
+        const char *value = daemon_option("agent_output_keep");
+
+        keep = (value == NULL) || crm_is_true(value);
+    }
+    return keep;
+}
+
 void
 client_disconnect_cleanup(const char *client_id)
 {
@@ -965,6 +1220,7 @@ action_complete(svc_action_t * action)
             }
 
             cmd_reset(cmd);
+            exec_slot_release(cmd);
             if(rsc) {
                 rsc->active = NULL;
             }
@@ -983,12 +1239,22 @@ action_complete(svc_action_t * action)
     }
 #endif
 
+    /* The services library is done with the output by now, so take it
+     * rather than copying what might be a sizeable string
+     */
     if (action->stderr_data) {
-        cmd->output = strdup(action->stderr_data);
         cmd->exit_reason = parse_exit_reason(action->stderr_data);
+        cmd->output = action->stderr_data;
+        action->stderr_data = NULL;
 
     } else if (action->stdout_data) {
-        cmd->output = strdup(action->stdout_data);
+        cmd->output = action->stdout_data;
+        action->stdout_data = NULL;
+    }
+
+    if (cmd->output && keep_agent_output() == FALSE) {
+        free(cmd->output);
+        cmd->output = NULL;
     }
 
     cmd_finalize(cmd, rsc);
@@ -1036,9 +1302,11 @@ stonith_action_complete(lrmd_cmd_t * cmd, int rc)
 
     if (recurring && rsc) {
         if (cmd->stonith_recurring_id) {
-            g_source_remove(cmd->stonith_recurring_id);
+            mainloop_wheel_remove(cmd->stonith_recurring_id);
         }
-        cmd->stonith_recurring_id = g_timeout_add(cmd->interval, stonith_recurring_op_helper, cmd);
+        cmd->stonith_recurring_id = mainloop_wheel_add(cmd->interval,
+                                                        QB_MIN(cmd->interval / 20, 2000),
+                                                        stonith_recurring_op_helper, cmd);
     }
 
     cmd_finalize(cmd, rsc);
@@ -1255,43 +1523,222 @@ lrmd_rsc_execute_service_lib(lrmd_rsc_t * rsc, lrmd_cmd_t * cmd)
     return TRUE;
 }
 
-static gboolean
-lrmd_rsc_execute(lrmd_rsc_t * rsc)
+/*
+ * Commands are run by a global executor.  Each resource still runs one
+ * command at a time, in order, but once its next command is ready the
+ * resource waits in the queue for that command's priority class, and no more
+ * than PCMK_lrmd_exec_limit commands are dispatched at once.  Higher classes
+ * are always dispatched first, so that the stops and starts a transition is
+ * waiting on aren't stuck behind a flood of monitors.
+ *
+ * Recurring monitors only pass through the executor for their first run,
+ * after which the services library repeats them on its own timer, so the
+ * limit does not cover those repeats.
+ */
+
+enum lrmd_exec_class {
+    lrmd_exec_stop = 0,
+    lrmd_exec_start,            /* start, promote, demote, migrate, notify, ... */
+    lrmd_exec_monitor,          /* recurring monitors */
+    lrmd_exec_probe,            /* one-off monitors */
+    lrmd_exec_max
+};
+
+/* log2 milliseconds, so the last bucket is everything over about 70 minutes */
+#define LRMD_EXEC_BUCKETS 23
+
+typedef struct lrmd_histogram_s {
+    unsigned long count;
+    unsigned long long total;
+    unsigned long long max;
+    unsigned long buckets[LRMD_EXEC_BUCKETS];
+} lrmd_histogram_t;
+
+static struct lrmd_executor_s {
+    int limit;                  /* 0 for no limit */
+    int active;
+    GList *ready[lrmd_exec_max];        /* lrmd_rsc_t waiting to execute */
+    lrmd_histogram_t wait[lrmd_exec_max];
+    lrmd_histogram_t run[lrmd_exec_max];
+    crm_trigger_t *trigger;
+} executor;
+
+static const char *
+exec_class_text(enum lrmd_exec_class class)
 {
-    lrmd_cmd_t *cmd = NULL;
+    switch (class) {
+        case lrmd_exec_stop:
+            return "stop";
+        case lrmd_exec_start:
+            return "start";
+        case lrmd_exec_monitor:
+            return "monitor";
+        case lrmd_exec_probe:
+            return "probe";
+        case lrmd_exec_max:
+            break;
+    }
+    return "unknown";
+}
 
-    CRM_CHECK(rsc != NULL, return FALSE);
+static enum lrmd_exec_class
+exec_class(lrmd_cmd_t * cmd)
+{
+    /* Systemd starts and stops are re-queued as monitors until they complete */
+    const char *action = cmd->real_action ? cmd->real_action : cmd->action;
 
-    if (rsc->active) {
-        crm_trace("%s is still active", rsc->rsc_id);
-        return TRUE;
+    if (safe_str_eq(action, "stop")) {
+        return lrmd_exec_stop;
+
+    } else if (safe_str_eq(action, "monitor") || safe_str_eq(action, "status")) {
+        return cmd->interval ? lrmd_exec_monitor : lrmd_exec_probe;
     }
+    return lrmd_exec_start;
+}
 
-    if (rsc->pending_ops) {
-        GList *first = rsc->pending_ops;
-
-        cmd = first->data;
-        if (cmd->delay_id) {
-            crm_trace
-                ("Command %s %s was asked to run too early, waiting for start_delay timeout of %dms",
-                 cmd->rsc_id, cmd->action, cmd->start_delay);
-            return TRUE;
+static void
+exec_histogram_add(lrmd_histogram_t * histogram, long long ms)
+{
+    int bucket = 0;
+
+    if (ms < 0) {
+        ms = 0;
+    }
+    while (bucket < (LRMD_EXEC_BUCKETS - 1) && (1LL << bucket) <= ms) {
+        bucket++;
+    }
+
+    histogram->count++;
+    histogram->total += ms;
+    histogram->buckets[bucket]++;
+    if (ms > histogram->max) {
+        histogram->max = ms;
+    }
+}
+
+/* Returns the upper bound of the bucket containing the given percentile */
+static unsigned long long
+exec_histogram_percentile(lrmd_histogram_t * histogram, int percentile)
+{
+    int bucket = 0;
+    unsigned long seen = 0;
+    unsigned long wanted = ((histogram->count * percentile) + 99) / 100;
+
+    if (histogram->count == 0) {
+        return 0;
+    }
+    for (bucket = 0; bucket < LRMD_EXEC_BUCKETS; bucket++) {
+        seen += histogram->buckets[bucket];
+        if (seen >= wanted) {
+            break;
         }
-        rsc->pending_ops = g_list_remove_link(rsc->pending_ops, first);
-        g_list_free_1(first);
+    }
+    if (bucket >= LRMD_EXEC_BUCKETS - 1) {
+        return histogram->max;
+    }
+    return QB_MIN(1ULL << bucket, histogram->max);
+}
 
-#ifdef HAVE_SYS_TIMEB_H
-        if (cmd->t_first_run.time == 0) {
-            ftime(&cmd->t_first_run);
+static void
+exec_histogram_xml(lrmd_histogram_t * histogram, xmlNode * parent, const char *name)
+{
+    int bucket = 0;
+    char buffer[64];
+    xmlNode *xml = create_xml_node(parent, name);
+
+    crm_xml_add_int(xml, "count", histogram->count);
+
+    snprintf(buffer, sizeof(buffer), "%llu", histogram->total);
+    crm_xml_add(xml, "total-ms", buffer);
+
+    snprintf(buffer, sizeof(buffer), "%llu", exec_histogram_percentile(histogram, 50));
+    crm_xml_add(xml, "p50-ms", buffer);
+
+    snprintf(buffer, sizeof(buffer), "%llu", exec_histogram_percentile(histogram, 99));
+    crm_xml_add(xml, "p99-ms", buffer);
+
+    snprintf(buffer, sizeof(buffer), "%llu", histogram->max);
+    crm_xml_add(xml, "max-ms", buffer);
+
+    for (bucket = 0; bucket < LRMD_EXEC_BUCKETS; bucket++) {
+        if (histogram->buckets[bucket]) {
+            xmlNode *xml_bucket = create_xml_node(xml, "bucket");
+
+            /* Counts of values below this many milliseconds */
+            snprintf(buffer, sizeof(buffer), "%llu", 1ULL << bucket);
+            crm_xml_add(xml_bucket, "lt-ms", (bucket < LRMD_EXEC_BUCKETS - 1) ? buffer : "inf");
+            crm_xml_add_int(xml_bucket, "count", histogram->buckets[bucket]);
         }
-        ftime(&cmd->t_run);
-#endif
     }
+}
 
-    if (!cmd) {
-        crm_trace("Nothing further to do for %s", rsc->rsc_id);
-        return TRUE;
+static xmlNode *
+exec_stats_xml(void)
+{
+    int lpc = 0;
+    xmlNode *xml = create_xml_node(NULL, "lrmd_stats");
+
+    crm_xml_add_int(xml, "limit", executor.limit);
+    crm_xml_add_int(xml, "active", executor.active);
+
+    for (lpc = 0; lpc < lrmd_exec_max; lpc++) {
+        xmlNode *class = create_xml_node(xml, "exec_class");
+
+        crm_xml_add(class, "name", exec_class_text(lpc));
+        crm_xml_add_int(class, "queued", g_list_length(executor.ready[lpc]));
+        exec_histogram_xml(&executor.wait[lpc], class, "queue_wait");
+        exec_histogram_xml(&executor.run[lpc], class, "exec_time");
+    }
+    return xml;
+}
+
+static void
+exec_slot_release(lrmd_cmd_t * cmd)
+{
+    if (cmd->exec_slot == FALSE) {
+        return;
+    }
+
+    cmd->exec_slot = FALSE;
+    executor.active--;
+    exec_histogram_add(&executor.run[cmd->exec_class],
+                       (crm_monotonic_usec() - cmd->started_usec) / 1000);
+
+    if (executor.trigger) {
+        mainloop_set_trigger(executor.trigger);
+    }
+}
+
+/* Run a resource's next command, now that the executor has a slot for it */
+static void
+lrmd_rsc_execute_next(lrmd_rsc_t * rsc)
+{
+    lrmd_cmd_t *cmd = NULL;
+    GList *first = rsc->pending_ops;
+
+    /* Things may have changed while the resource was queued */
+    if (rsc->active || first == NULL || ((lrmd_cmd_t *) first->data)->delay_id) {
+        mainloop_set_trigger(rsc->work);
+        return;
+    }
+
+    cmd = first->data;
+    rsc->pending_ops = g_list_remove_link(rsc->pending_ops, first);
+    g_list_free_1(first);
+
+#ifdef HAVE_SYS_TIMEB_H
+    if (cmd->t_first_run.time == 0) {
+        ftime(&cmd->t_first_run);
     }
+    ftime(&cmd->t_run);
+#endif
+
+    cmd->exec_class = exec_class(cmd);
+    cmd->exec_slot = TRUE;
+    cmd->started_usec = crm_monotonic_usec();
+    executor.active++;
+    exec_histogram_add(&executor.wait[cmd->exec_class],
+                       (cmd->started_usec - cmd->queued_usec) / 1000);
 
     rsc->active = cmd;          /* only one op at a time for a rsc */
     if (cmd->interval) {
@@ -1305,7 +1752,102 @@ lrmd_rsc_execute(lrmd_rsc_t * rsc)
     } else {
         lrmd_rsc_execute_service_lib(rsc, cmd);
     }
+}
+
+static gboolean
+exec_dispatch(gpointer user_data)
+{
+    int lpc = 0;
+
+    for (lpc = 0; lpc < lrmd_exec_max; lpc++) {
+        while (executor.ready[lpc]
+               && (executor.limit <= 0 || executor.active < executor.limit)) {
+            lrmd_rsc_t *rsc = executor.ready[lpc]->data;
+
+            executor.ready[lpc] = g_list_delete_link(executor.ready[lpc], executor.ready[lpc]);
+            rsc->exec_queued = FALSE;
+            lrmd_rsc_execute_next(rsc);
+        }
+
+        if (executor.ready[lpc]) {
+            crm_trace("Executor is full (%d active), %d %s operations waiting",
+                      executor.active, g_list_length(executor.ready[lpc]),
+                      exec_class_text(lpc));
+            break;
+        }
+    }
+    return TRUE;
+}
+
+static void
+exec_init(void)
+{
+    const char *value = daemon_option("lrmd_exec_limit");
+
+    /* By default, allow more than the crmd's node-action-limit (twice the
+     * number of cores) so that transition actions aren't throttled twice
+     */
+    executor.limit = 4 * QB_MAX(sysconf(_SC_NPROCESSORS_ONLN), 1);
+    if (value) {
+        executor.limit = crm_parse_int(value, "0");
+    }
+
+    crm_info("Executing at most %d operations at once%s", executor.limit,
+             executor.limit > 0 ? " (plus recurring monitor repeats)" : " (no limit)");
+    executor.trigger = mainloop_add_trigger(G_PRIORITY_HIGH, exec_dispatch, NULL);
+}
+
+static void
+exec_dequeue(lrmd_rsc_t * rsc)
+{
+    int lpc = 0;
+
+    if (rsc->exec_queued) {
+        for (lpc = 0; lpc < lrmd_exec_max; lpc++) {
+            executor.ready[lpc] = g_list_remove(executor.ready[lpc], rsc);
+        }
+        rsc->exec_queued = FALSE;
+    }
+}
+
+static gboolean
+lrmd_rsc_execute(lrmd_rsc_t * rsc)
+{
+    lrmd_cmd_t *cmd = NULL;
+    enum lrmd_exec_class class = lrmd_exec_max;
+
+    CRM_CHECK(rsc != NULL, return FALSE);
+
+    if (rsc->active) {
+        crm_trace("%s is still active", rsc->rsc_id);
+        return TRUE;
+
+    } else if (rsc->exec_queued) {
+        crm_trace("%s is waiting to execute", rsc->rsc_id);
+        return TRUE;
+
+    } else if (rsc->pending_ops == NULL) {
+        crm_trace("Nothing further to do for %s", rsc->rsc_id);
+        return TRUE;
+    }
+
+    cmd = rsc->pending_ops->data;
+    if (cmd->delay_id) {
+        crm_trace
+            ("Command %s %s was asked to run too early, waiting for start_delay timeout of %dms",
+             cmd->rsc_id, cmd->action, cmd->start_delay);
+        return TRUE;
+    }
+
+    if (executor.trigger == NULL) {
+        exec_init();
+    }
 
+    class = exec_class(cmd);
+    crm_trace("Queueing %s for %s (%s class)", cmd->action, rsc->rsc_id, exec_class_text(class));
+    rsc->exec_queued = TRUE;
+    executor.ready[class] = g_list_append(executor.ready[class], rsc);
+    mainloop_set_trigger(executor.trigger);
     return TRUE;
 }
 
@@ -1358,6 +1900,7 @@ free_rsc(gpointer data)
     free(rsc->class);
     free(rsc->provider);
     free(rsc->type);
+    exec_dequeue(rsc);
     mainloop_destroy_trigger(rsc->work);
 
     free(rsc);
@@ -1370,6 +1913,16 @@ process_lrmd_signon(crm_client_t * client, uint32_t id, xmlNode * request)
     const char *is_ipc_provider = crm_element_value(request, F_LRMD_IS_IPC_PROVIDER);
     const char *protocol_version = crm_element_value(request, F_LRMD_PROTOCOL_VERSION);
 
+    if (crm_is_true(crm_element_value(request, F_LRMD_BATCH_NOTIFY))) {
+        set_bit(client->flags, crm_client_flag_batch_notify);
+    }
+
+    /* Only local clients share our byte order and can skip the XML */
+    if (client->kind == CRM_CLIENT_IPC
+        && crm_is_true(crm_element_value(request, F_LRMD_BINARY_NOTIFY))) {
+        set_bit(client->flags, crm_client_flag_binary_notify);
+    }
+
     if (safe_str_neq(protocol_version, LRMD_PROTOCOL_VERSION)) {
         crm_xml_add_int(reply, F_LRMD_RC, -EPROTO);
         crm_xml_add(reply, F_LRMD_PROTOCOL_VERSION, LRMD_PROTOCOL_VERSION);
@@ -1463,6 +2016,27 @@ process_lrmd_get_rsc_info(crm_client_t * client, uint32_t id, xmlNode * request)
     free_xml(reply);
 }
 
+static void
+process_lrmd_get_stats(crm_client_t * client, uint32_t id, xmlNode * request)
+{
+    int call_id = 0;
+    int send_rc = 0;
+    xmlNode *reply = create_xml_node(NULL, T_LRMD_REPLY);
+
+    crm_element_value_int(request, F_LRMD_CALLID, &call_id);
+
+    crm_xml_add(reply, F_LRMD_ORIGIN, __FUNCTION__);
+    crm_xml_add_int(reply, F_LRMD_RC, pcmk_ok);
+    crm_xml_add_int(reply, F_LRMD_CALLID, call_id);
+    add_node_nocopy(reply, NULL, exec_stats_xml());
+
+    send_rc = lrmd_server_send_reply(client, id, reply);
+    if (send_rc < 0) {
+        crm_warn("LRMD reply to %s failed: %d", client->name, send_rc);
+    }
+    free_xml(reply);
+}
+
 static int
 process_lrmd_rsc_unregister(crm_client_t * client, uint32_t id, xmlNode * request)
 {
@@ -1673,6 +2247,8 @@ process_lrmd_message(crm_client_t * client, uint32_t id, xmlNode * request)
     } else if (crm_str_eq(op, LRMD_OP_POKE, TRUE)) {
         do_notify = 1;
         do_reply = 1;
+    } else if (crm_str_eq(op, LRMD_OP_STATS, TRUE)) {
+        process_lrmd_get_stats(client, id, request);
     } else {
         rc = -EOPNOTSUPP;
         do_reply = 1;
@@ -56,6 +56,9 @@ typedef struct lrmd_rsc_s {
 
     int stonith_started;
 
+    /* Waiting for the executor to run its next operation */
+    gboolean exec_queued;
+
     crm_trigger_t *work;
 } lrmd_rsc_t;
 
@@ -74,6 +77,8 @@ int lrmd_server_send_reply(crm_client_t * client, uint32_t id, xmlNode * reply);
 
 int lrmd_server_send_notify(crm_client_t * client, xmlNode * msg);
 
+int lrmd_server_send_binary(crm_client_t * client, char *buffer, unsigned int size);
+
 void notify_of_new_client(crm_client_t *new_client);
 
 void process_lrmd_message(crm_client_t * client, uint32_t id, xmlNode * request);
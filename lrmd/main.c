@@ -227,10 +227,35 @@ lrmd_server_send_notify(crm_client_t * client, xmlNode * msg)
     return -1;
 }
 
+/*!
+ * \internal
+ * \brief Send packed operation results to a local client
+ *
+ * \param[in] client  Client that accepts binary notifications
+ * \param[in] buffer  Message to send (will be freed)
+ * \param[in] size    Size of \p buffer
+ */
+int
+lrmd_server_send_binary(crm_client_t * client, char *buffer, unsigned int size)
+{
+    if (client->kind != CRM_CLIENT_IPC || client->ipcs == NULL) {
+        crm_trace("Asked to send binary event to disconnected or remote client");
+        free(buffer);
+        return -1;
+    }
+    return crm_ipcs_send_buffer(client, 0, buffer, size, crm_ipc_server_event);
+}
+
 void
 lrmd_shutdown(int nsig)
 {
+    mainloop_wheel_stats_t stats;
+
+    mainloop_wheel_stats(&stats);
     crm_info("Terminating with  %d clients", crm_hash_table_size(client_connections));
+    crm_info("Timer wheel: %u timers scheduled, %llu fired on %llu ticks (at most %u at once)",
+             stats.timers, (unsigned long long)stats.fired,
+             (unsigned long long)stats.busy_ticks, stats.max_due);
     if (ipcs) {
         mainloop_del_ipc_server(ipcs);
     }
@@ -0,0 +1,578 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/*
+ * Simulate many Pacemaker Remote nodes on the loopback interface
+ *
+ * Each simulated node listens on its own port and speaks just enough of the
+ * remote lrmd protocol for a cluster node to connect, monitor the connection
+ * and run resources "on" it: resources are only recorded, starts and stops
+ * always succeed and monitors report whatever the last start or stop left.
+ *
+ * In --connect mode the same tool opens a connection to each simulated node
+ * through the lrmd client library instead, with bounded parallelism, and
+ * reports how long connection setup took.
+ */
+
+#include <crm_internal.h>
+
+#include <glib.h>
+#include <unistd.h>
+
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include <crm/crm.h>
+#include <crm/msg_xml.h>
+#include <crm/services.h>
+#include <crm/common/mainloop.h>
+#include <crm/lrmd.h>
+
+#include <lrmd_private.h>
+
+/* *INDENT-OFF* */
+static struct crm_option long_options[] = {
+    {"help",     0, 0, '?'},
+    {"verbose",  0, 0, 'V', "\tPrint out logs and events to screen"},
+    {"nodes",    1, 0, 'n', "\tNumber of remote nodes to simulate (default 10)"},
+    {"port",     1, 0, 'p', "\tPort of the first node, the rest use the following ones (default 3200)"},
+    {"prefix",   1, 0, 'N', "\tNode names are this prefix followed by a number (default sim-remote-)"},
+    {"connect",  0, 0, 'c', "\tConnect to simulated nodes instead of running them"},
+    {"parallel", 1, 0, 'P', "Connections to establish at once with --connect, 0 for all (default 10)"},
+    {"xml",      0, 0, 'x', "\tPrint ocf:pacemaker:remote resources for the nodes and exit"},
+    {"-spacer-", 1, 0, '-', "\nExamples:"},
+    {"-spacer-", 1, 0, '-', "Run 200 nodes and add them to the cluster:", pcmk_option_paragraph},
+    {"-spacer-", 1, 0, '-', " lrmd_remote_sim --nodes 200 &", pcmk_option_example},
+    {"-spacer-", 1, 0, '-', " lrmd_remote_sim --nodes 200 --xml | cibadmin --create -o resources --xml-pipe", pcmk_option_example},
+    {"-spacer-", 1, 0, '-', "Measure connection setup to them from this host, 20 at a time:", pcmk_option_paragraph},
+    {"-spacer-", 1, 0, '-', " lrmd_remote_sim --nodes 200 --connect --parallel 20", pcmk_option_example},
+    {0, 0, 0, 0}
+};
+/* *INDENT-ON* */
+
+static struct {
+    int nodes;
+    int port;
+    int parallel;
+    const char *prefix;
+} options;
+
+GMainLoop *mainloop = NULL;
+
+#ifdef HAVE_GNUTLS_GNUTLS_H
+
+typedef struct sim_node_s {
+    char *name;
+    int port;
+    int sock;
+    GHashTable *resources;      /* rsc id -> "running" or "stopped" */
+} sim_node_t;
+
+typedef struct sim_client_s {
+    sim_node_t *node;
+    crm_remote_t remote;
+    char *id;
+    int sock;
+    gboolean handshake_done;
+    mainloop_io_t *source;
+} sim_client_t;
+
+static gnutls_psk_server_credentials_t psk_cred_s;
+static gnutls_dh_params_t dh_params;
+
+static int
+sim_send(sim_client_t * client, xmlNode * msg, uint32_t id, const char *msg_type)
+{
+    int rc = lrmd_tls_send_msg(&(client->remote), msg, id, msg_type);
+
+    if (rc < 0) {
+        crm_warn("Could not send %s to client of %s", msg_type, client->node->name);
+    }
+    return rc;
+}
+
+static void
+sim_reply(sim_client_t * client, uint32_t id, int call_id, int rc)
+{
+    xmlNode *reply = create_xml_node(NULL, T_LRMD_REPLY);
+
+    crm_xml_add(reply, F_LRMD_ORIGIN, __FUNCTION__);
+    crm_xml_add_int(reply, F_LRMD_RC, rc);
+    crm_xml_add_int(reply, F_LRMD_CALLID, call_id);
+    sim_send(client, reply, id, "reply");
+    free_xml(reply);
+}
+
+static void
+sim_exec(sim_client_t * client, xmlNode * request, int call_id)
+{
+    xmlNode *rsc_xml = get_xpath_object("//" F_LRMD_RSC, request, LOG_ERR);
+    const char *rsc_id = crm_element_value(rsc_xml, F_LRMD_RSC_ID);
+    const char *action = crm_element_value(rsc_xml, F_LRMD_RSC_ACTION);
+    const char *state = g_hash_table_lookup(client->node->resources, rsc_id);
+    int exec_rc = PCMK_OCF_OK;
+    xmlNode *notify = NULL;
+
+    if (state == NULL) {
+        exec_rc = PCMK_OCF_NOT_INSTALLED;
+
+    } else if (safe_str_eq(action, "start") || safe_str_eq(action, "migrate_from")) {
+        g_hash_table_replace(client->node->resources, strdup(rsc_id), (gpointer) "running");
+
+    } else if (safe_str_eq(action, "stop") || safe_str_eq(action, "migrate_to")) {
+        g_hash_table_replace(client->node->resources, strdup(rsc_id), (gpointer) "stopped");
+
+    } else if (safe_str_eq(action, "monitor") && safe_str_eq(state, "stopped")) {
+        exec_rc = PCMK_OCF_NOT_RUNNING;
+    }
+
+    notify = create_xml_node(NULL, T_LRMD_NOTIFY);
+    crm_xml_add(notify, F_LRMD_ORIGIN, __FUNCTION__);
+    crm_xml_add(notify, F_LRMD_OPERATION, LRMD_OP_RSC_EXEC);
+    crm_xml_add(notify, F_LRMD_RSC_ID, rsc_id);
+    crm_xml_add(notify, F_LRMD_RSC_ACTION, action);
+    crm_xml_add(notify, F_LRMD_RSC_USERDATA_STR,
+                crm_element_value(rsc_xml, F_LRMD_RSC_USERDATA_STR));
+    crm_xml_add(notify, F_LRMD_RSC_INTERVAL, crm_element_value(rsc_xml, F_LRMD_RSC_INTERVAL));
+    crm_xml_add(notify, F_LRMD_TIMEOUT, crm_element_value(rsc_xml, F_LRMD_TIMEOUT));
+    crm_xml_add_int(notify, F_LRMD_CALLID, call_id);
+    crm_xml_add_int(notify, F_LRMD_EXEC_RC, exec_rc);
+    crm_xml_add_int(notify, F_LRMD_OP_STATUS, PCMK_LRM_OP_DONE);
+    crm_xml_add_int(notify, F_LRMD_RSC_RUN_TIME, time(NULL));
+    crm_xml_add_int(notify, F_LRMD_RSC_RCCHANGE_TIME, time(NULL));
+    sim_send(client, notify, 0, "notify");
+    free_xml(notify);
+}
+
+static void
+sim_process_request(sim_client_t * client, uint32_t id, xmlNode * request)
+{
+    static int call_id = 0;
+    const char *op = crm_element_value(request, F_LRMD_OPERATION);
+    xmlNode *rsc_xml = get_xpath_object("//" F_LRMD_RSC, request, LOG_TRACE);
+    const char *rsc_id = crm_element_value(rsc_xml, F_LRMD_RSC_ID);
+
+    if (++call_id < 1) {
+        call_id = 1;
+    }
+    crm_trace("Processing %s for %s", op, client->node->name);
+
+    if (crm_str_eq(op, CRM_OP_REGISTER, TRUE)) {
+        xmlNode *reply = create_xml_node(NULL, T_LRMD_REPLY);
+
+        crm_xml_add(reply, F_LRMD_OPERATION, CRM_OP_REGISTER);
+        crm_xml_add(reply, F_LRMD_CLIENTID, client->id);
+        crm_xml_add_int(reply, F_LRMD_RC, pcmk_ok);
+        sim_send(client, reply, id, "reply");
+        free_xml(reply);
+
+    } else if (crm_str_eq(op, LRMD_OP_POKE, TRUE)) {
+        xmlNode *notify = create_xml_node(NULL, T_LRMD_NOTIFY);
+
+        sim_reply(client, id, call_id, pcmk_ok);
+        crm_xml_add(notify, F_LRMD_OPERATION, op);
+        crm_xml_add_int(notify, F_LRMD_CALLID, call_id);
+        sim_send(client, notify, 0, "notify");
+        free_xml(notify);
+
+    } else if (crm_str_eq(op, LRMD_OP_RSC_REG, TRUE)) {
+        if (g_hash_table_lookup(client->node->resources, rsc_id) == NULL) {
+            g_hash_table_insert(client->node->resources, strdup(rsc_id), (gpointer) "stopped");
+        }
+        sim_reply(client, id, call_id, pcmk_ok);
+
+    } else if (crm_str_eq(op, LRMD_OP_RSC_UNREG, TRUE)) {
+        g_hash_table_remove(client->node->resources, rsc_id);
+        sim_reply(client, id, call_id, pcmk_ok);
+
+    } else if (crm_str_eq(op, LRMD_OP_RSC_INFO, TRUE)) {
+        /* Make the crmd register everything it wants to use */
+        sim_reply(client, id, call_id, pcmk_ok);
+
+    } else if (crm_str_eq(op, LRMD_OP_RSC_EXEC, TRUE)) {
+        sim_reply(client, id, call_id, call_id);
+        sim_exec(client, request, call_id);
+
+    } else if (crm_str_eq(op, LRMD_OP_RSC_CANCEL, TRUE)) {
+        sim_reply(client, id, call_id, pcmk_ok);
+
+    } else {
+        /* Including proxied IPC, which we don't offer */
+        sim_reply(client, id, call_id, -EOPNOTSUPP);
+    }
+}
+
+static int
+sim_client_dispatch(gpointer data)
+{
+    int disconnected = 0;
+    sim_client_t *client = data;
+    xmlNode *request = NULL;
+
+    if (client->handshake_done == FALSE) {
+        int rc = gnutls_handshake(*client->remote.tls_session);
+
+        if (rc == 0) {
+            crm_debug("TLS handshake with client of %s complete", client->node->name);
+            client->handshake_done = TRUE;
+
+        } else if (rc != GNUTLS_E_AGAIN && rc != GNUTLS_E_INTERRUPTED) {
+            crm_info("TLS handshake with client of %s failed: %s",
+                     client->node->name, gnutls_strerror(rc));
+            return -1;
+        }
+        return 0;
+    }
+
+    crm_remote_recv(&(client->remote), -1, &disconnected);
+    for (request = crm_remote_parse_buffer(&(client->remote)); request != NULL;
+         request = crm_remote_parse_buffer(&(client->remote))) {
+        int id = 0;
+
+        crm_element_value_int(request, F_LRMD_REMOTE_MSG_ID, &id);
+        sim_process_request(client, id, request);
+        free_xml(request);
+    }
+
+    return disconnected ? -1 : 0;
+}
+
+static void
+sim_client_destroy(gpointer data)
+{
+    sim_client_t *client = data;
+
+    crm_info("Client of %s disconnected", client->node->name);
+    if (client->remote.tls_session) {
+        gnutls_deinit(*client->remote.tls_session);
+        gnutls_free(client->remote.tls_session);
+    }
+    close(client->sock);
+    free(client->remote.buffer);
+    free(client->id);
+    free(client);
+}
+
+static int
+sim_node_accept(gpointer data)
+{
+    sim_node_t *node = data;
+    sim_client_t *client = NULL;
+    int flag = 0;
+    int csock = accept(node->sock, NULL, NULL);
+
+    static struct mainloop_fd_callbacks client_fd_cb = {
+        .dispatch = sim_client_dispatch,
+        .destroy = sim_client_destroy,
+    };
+
+    if (csock < 0) {
+        crm_perror(LOG_ERR, "Could not accept connection for %s", node->name);
+        return TRUE;
+    }
+
+    flag = fcntl(csock, F_GETFL);
+    if (flag < 0 || fcntl(csock, F_SETFL, flag | O_NONBLOCK) < 0) {
+        crm_perror(LOG_ERR, "Could not make connection for %s non-blocking", node->name);
+        close(csock);
+        return TRUE;
+    }
+
+    client = calloc(1, sizeof(sim_client_t));
+    client->node = node;
+    client->sock = csock;
+    client->id = crm_generate_uuid();
+    client->remote.tls_session = create_psk_tls_session(csock, GNUTLS_SERVER, psk_cred_s);
+
+    crm_info("New client connection for %s", node->name);
+    client->source = mainloop_add_fd(node->name, G_PRIORITY_DEFAULT, csock, client, &client_fd_cb);
+    return TRUE;
+}
+
+static int
+sim_server_key_cb(gnutls_session_t session, const char *username, gnutls_datum_t * key)
+{
+    return lrmd_tls_set_key(key);
+}
+
+static int
+sim_nodes_start(void)
+{
+    int lpc = 0;
+
+    static struct mainloop_fd_callbacks listen_fd_cb = {
+        .dispatch = sim_node_accept,
+    };
+
+    crm_gnutls_global_init();
+    gnutls_dh_params_init(&dh_params);
+    gnutls_dh_params_generate2(dh_params, 1024);
+    gnutls_psk_allocate_server_credentials(&psk_cred_s);
+    gnutls_psk_set_server_credentials_function(psk_cred_s, sim_server_key_cb);
+    gnutls_psk_set_server_dh_params(psk_cred_s, dh_params);
+
+    for (lpc = 0; lpc < options.nodes; lpc++) {
+        int optval = 1;
+        struct sockaddr_in addr;
+        sim_node_t *node = calloc(1, sizeof(sim_node_t));
+
+        node->name = crm_strdup_printf("%s%d", options.prefix, lpc + 1);
+        node->port = options.port + lpc;
+        node->resources = g_hash_table_new_full(crm_str_hash, g_str_equal, free, NULL);
+
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(node->port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        node->sock = socket(AF_INET, SOCK_STREAM, 0);
+        if (node->sock < 0
+            || setsockopt(node->sock, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval)) < 0
+            || bind(node->sock, (struct sockaddr *)&addr, sizeof(addr)) < 0
+            || listen(node->sock, 10) < 0) {
+            crm_perror(LOG_ERR, "Could not listen on port %d for %s", node->port, node->name);
+            return -1;
+        }
+
+        mainloop_add_fd(node->name, G_PRIORITY_DEFAULT, node->sock, node, &listen_fd_cb);
+    }
+
+    printf("Simulating %d remote nodes on 127.0.0.1 ports %d-%d\n",
+           options.nodes, options.port, options.port + options.nodes - 1);
+    return 0;
+}
+#endif
+
+/* --connect mode */
+static int connect_next = 0;
+static int connect_active = 0;
+static int connect_done = 0;
+static int connect_failed = 0;
+static long long connect_begin = 0;
+static long long *connect_started = NULL;
+static long long connect_total_ms = 0;
+static long long connect_max_ms = 0;
+static lrmd_t **connections = NULL;
+
+static void connect_more(void);
+
+static void
+connect_event(lrmd_event_data_t * event)
+{
+    int lpc = 0;
+    long long elapsed = 0;
+
+    if (event->type != lrmd_event_connect) {
+        return;
+    }
+
+    lpc = crm_parse_int(event->remote_nodename + strlen(options.prefix), "0") - 1;
+    CRM_CHECK(lpc >= 0 && lpc < options.nodes, return);
+
+    elapsed = (crm_monotonic_usec() - connect_started[lpc]) / 1000;
+    connect_total_ms += elapsed;
+    connect_max_ms = QB_MAX(connect_max_ms, elapsed);
+    connect_active--;
+    connect_done++;
+
+    if (event->connection_rc < 0) {
+        connect_failed++;
+        printf("%s: failed after %lldms (%d)\n", event->remote_nodename, elapsed,
+               event->connection_rc);
+    } else {
+        crm_info("%s: connected in %lldms", event->remote_nodename, elapsed);
+    }
+    connect_more();
+}
+
+static void
+connect_more(void)
+{
+    while (connect_next < options.nodes
+           && (options.parallel <= 0 || connect_active < options.parallel)) {
+        int lpc = connect_next++;
+        char *name = crm_strdup_printf("%s%d", options.prefix, lpc + 1);
+
+        connections[lpc] = lrmd_remote_api_new(name, "127.0.0.1", options.port + lpc);
+        connections[lpc]->cmds->set_callback(connections[lpc], connect_event);
+
+        connect_started[lpc] = crm_monotonic_usec();
+        connect_active++;
+        if (connections[lpc]->cmds->connect_async(connections[lpc], name, 30000) < 0) {
+            lrmd_event_data_t event = { 0, };
+
+            event.type = lrmd_event_connect;
+            event.remote_nodename = name;
+            event.connection_rc = -ENOTCONN;
+            connect_event(&event);
+        }
+        free(name);
+    }
+
+    if (connect_done == options.nodes) {
+        long long elapsed = (crm_monotonic_usec() - connect_begin) / 1000;
+
+        printf("%d connections (%d failed) in %lldms with at most %d at once:"
+               " avg=%lldms max=%lldms\n", options.nodes, connect_failed, elapsed,
+               options.parallel, connect_total_ms / options.nodes, connect_max_ms);
+        g_main_quit(mainloop);
+    }
+}
+
+static void
+print_resources(void)
+{
+    int lpc = 0;
+    char *buffer = NULL;
+    xmlNode *resources = create_xml_node(NULL, XML_CIB_TAG_RESOURCES);
+
+    for (lpc = 0; lpc < options.nodes; lpc++) {
+        char *id = crm_strdup_printf("%s%d", options.prefix, lpc + 1);
+        char *nvpair_id = crm_strdup_printf("%s-attrs", id);
+        xmlNode *rsc = create_xml_node(resources, XML_CIB_TAG_RESOURCE);
+        xmlNode *attrs = create_xml_node(rsc, XML_TAG_ATTR_SETS);
+        xmlNode *nvpair = NULL;
+
+        crm_xml_add(rsc, XML_ATTR_ID, id);
+        crm_xml_add(rsc, XML_AGENT_ATTR_CLASS, "ocf");
+        crm_xml_add(rsc, XML_AGENT_ATTR_PROVIDER, "pacemaker");
+        crm_xml_add(rsc, XML_ATTR_TYPE, "remote");
+        crm_xml_add(attrs, XML_ATTR_ID, nvpair_id);
+
+        nvpair = create_xml_node(attrs, XML_CIB_TAG_NVPAIR);
+        free(nvpair_id);
+        nvpair_id = crm_strdup_printf("%s-server", id);
+        crm_xml_add(nvpair, XML_ATTR_ID, nvpair_id);
+        crm_xml_add(nvpair, XML_NVPAIR_ATTR_NAME, "server");
+        crm_xml_add(nvpair, XML_NVPAIR_ATTR_VALUE, "127.0.0.1");
+
+        nvpair = create_xml_node(attrs, XML_CIB_TAG_NVPAIR);
+        free(nvpair_id);
+        nvpair_id = crm_strdup_printf("%s-port", id);
+        crm_xml_add(nvpair, XML_ATTR_ID, nvpair_id);
+        crm_xml_add(nvpair, XML_NVPAIR_ATTR_NAME, "port");
+        crm_xml_add_int(nvpair, XML_NVPAIR_ATTR_VALUE, options.port + lpc);
+
+        free(nvpair_id);
+        free(id);
+    }
+
+    buffer = dump_xml_formatted(resources);
+    printf("%s", buffer);
+    free(buffer);
+    free_xml(resources);
+}
+
+int
+main(int argc, char **argv)
+{
+    int flag = 0;
+    int argerr = 0;
+    int option_index = 0;
+    gboolean do_connect = FALSE;
+    gboolean do_xml = FALSE;
+
+    options.nodes = 10;
+    options.port = 3200;
+    options.parallel = 10;
+    options.prefix = "sim-remote-";
+
+    crm_set_options(NULL, "[options]", long_options,
+                    "Simulate Pacemaker Remote nodes on the loopback interface\n");
+
+    while (1) {
+        flag = crm_get_option(argc, argv, &option_index);
+        if (flag == -1)
+            break;
+
+        switch (flag) {
+            case '?':
+                crm_help(flag, EX_OK);
+                break;
+            case 'V':
+                crm_bump_log_level(argc, argv);
+                break;
+            case 'n':
+                options.nodes = crm_parse_int(optarg, "10");
+                break;
+            case 'p':
+                options.port = crm_parse_int(optarg, "3200");
+                break;
+            case 'N':
+                options.prefix = optarg;
+                break;
+            case 'c':
+                do_connect = TRUE;
+                break;
+            case 'P':
+                options.parallel = crm_parse_int(optarg, "10");
+                break;
+            case 'x':
+                do_xml = TRUE;
+                break;
+            default:
+                ++argerr;
+                break;
+        }
+    }
+
+    if (argerr || options.nodes < 1) {
+        crm_help('?', EX_USAGE);
+    }
+
+    crm_log_init(NULL, LOG_INFO, FALSE, FALSE, argc, argv, FALSE);
+
+    if (do_xml) {
+        print_resources();
+        return 0;
+    }
+
+    mainloop = g_main_new(FALSE);
+
+    if (do_connect) {
+        connections = calloc(options.nodes, sizeof(lrmd_t *));
+        connect_started = calloc(options.nodes, sizeof(long long));
+        connect_begin = crm_monotonic_usec();
+        connect_more();
+
+    } else {
+#ifdef HAVE_GNUTLS_GNUTLS_H
+        if (sim_nodes_start() < 0) {
+            return 1;
+        }
+#else
+        fprintf(stderr, "Remote nodes require TLS support\n");
+        return 1;
+#endif
+    }
+
+    g_main_run(mainloop);
+
+    if (connections) {
+        int lpc = 0;
+
+        for (lpc = 0; lpc < options.nodes; lpc++) {
+            lrmd_api_delete(connections[lpc]);
+        }
+        free(connections);
+        free(connect_started);
+    }
+    return 0;
+}
@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/*
+ * Measure how quickly the services library can launch resource agents
+ *
+ * Agents are run through services_action_async() exactly as the lrmd runs
+ * them.  --memory and --fds make this process look more like a busy lrmd,
+ * since both affect the cost of fork(), and --fork selects the launch method
+ * used before posix_spawn() (equivalent to PCMK_agent_spawn=no) so the two
+ * can be compared.
+ */
+
+#include <crm_internal.h>
+
+#include <glib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include <crm/crm.h>
+#include <crm/services.h>
+#include <crm/common/mainloop.h>
+
+/* *INDENT-OFF* */
+static struct crm_option long_options[] = {
+    {"help",     0, 0, '?'},
+    {"verbose",  0, 0, 'V', "\tPrint out logs and events to screen"},
+    {"count",    1, 0, 'c', "\tNumber of agents to run (default 1000)"},
+    {"parallel", 1, 0, 'P', "Number to run at once (default 10)"},
+    {"agent",    1, 0, 'a', "\tExecutable to run (default /bin/true), or standard:provider:type of an OCF agent"},
+    {"action",   1, 0, 'A', "\tAction to run for OCF agents (default monitor)"},
+    {"params",   1, 0, 'p', "\tNumber of dummy parameters to pass to OCF agents (default 20)"},
+    {"memory",   1, 0, 'm', "\tMegabytes of memory to allocate and touch first (default 0)"},
+    {"fds",      1, 0, 'f', "\tNumber of extra file descriptors to open first (default 0)"},
+    {"fork",     0, 0, 'F', "\tLaunch agents with fork() instead of posix_spawn()"},
+    {"-spacer-", 1, 0, '-', "\nExamples:"},
+    {"-spacer-", 1, 0, '-', "Compare both launch methods from a process the size of a large lrmd:", pcmk_option_paragraph},
+    {"-spacer-", 1, 0, '-', " lrmd_spawn_bench --memory 200 --fds 500", pcmk_option_example},
+    {"-spacer-", 1, 0, '-', " lrmd_spawn_bench --memory 200 --fds 500 --fork", pcmk_option_example},
+    {"-spacer-", 1, 0, '-', "Run the Dummy agent's monitor action:", pcmk_option_paragraph},
+    {"-spacer-", 1, 0, '-', " lrmd_spawn_bench --agent ocf:pacemaker:Dummy", pcmk_option_example},
+    {0, 0, 0, 0}
+};
+/* *INDENT-ON* */
+
+static struct {
+    int count;
+    int parallel;
+    int params;
+    const char *agent;
+    const char *action;
+} options;
+
+static GMainLoop *mainloop = NULL;
+static int launched = 0;
+static int completed = 0;
+static int failed = 0;
+
+static void launch_more(void);
+
+static void
+action_done(svc_action_t * op)
+{
+    completed++;
+    if (op->rc != 0 || op->status != PCMK_LRM_OP_DONE) {
+        failed++;
+        crm_info("%s failed: rc=%d status=%d", op->id, op->rc, op->status);
+    }
+    launch_more();
+}
+
+static svc_action_t *
+create_action(int lpc)
+{
+    int n = 0;
+    char *id = NULL;
+    char *standard = NULL;
+    char *provider = NULL;
+    char *type = NULL;
+    svc_action_t *op = NULL;
+    GHashTable *params = NULL;
+
+    if (strchr(options.agent, ':') == NULL) {
+        const char *args[] = { NULL };
+
+        op = services_action_create_generic(options.agent, args);
+        op->id = crm_strdup_printf("bench_%d", lpc);
+        return op;
+    }
+
+    standard = strdup(options.agent);
+    provider = strchr(standard, ':');
+    *provider++ = 0;
+    type = strchr(provider, ':');
+    if (type == NULL) {
+        type = provider;
+        provider = NULL;
+    } else {
+        *type++ = 0;
+    }
+
+    params = g_hash_table_new_full(crm_str_hash, g_str_equal,
+                                   g_hash_destroy_str, g_hash_destroy_str);
+    for (n = 0; n < options.params; n++) {
+        g_hash_table_insert(params, crm_strdup_printf("param%d", n),
+                            crm_strdup_printf("value-%d-%d", lpc, n));
+    }
+
+    id = crm_strdup_printf("bench_%d", lpc);
+    op = resources_action_create(id, standard, provider, type, options.action, 0, 20000,
+                                 params, 0);
+    free(id);
+    free(standard);
+    return op;
+}
+
+static long long
+cpu_usec(int who)
+{
+    struct rusage usage;
+
+    getrusage(who, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL
+        + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+static void
+launch_more(void)
+{
+    static long long start = 0;
+    static long long start_cpu = 0;
+
+    if (start == 0) {
+        start = crm_monotonic_usec();
+        start_cpu = cpu_usec(RUSAGE_SELF);
+    }
+
+    while (launched < options.count && launched - completed < options.parallel) {
+        svc_action_t *op = create_action(launched++);
+
+        if (op == NULL) {
+            fprintf(stderr, "Could not create action for %s\n", options.agent);
+            exit(1);
+        }
+        services_action_async(op, action_done);
+    }
+
+    if (completed == options.count) {
+        long long elapsed = crm_monotonic_usec() - start;
+        long long cpu = cpu_usec(RUSAGE_SELF) - start_cpu;
+
+        printf("%d agents (%d failed, %d at once) in %.1fms: %.0f/s, %.1fus of our CPU each\n",
+               options.count, failed, options.parallel, elapsed / 1000.0,
+               options.count * 1000000.0 / QB_MAX(elapsed, 1), (double) cpu / options.count);
+        g_main_quit(mainloop);
+    }
+}
+
+static gboolean
+start_bench(gpointer user_data)
+{
+    launch_more();
+    return FALSE;
+}
+
+int
+main(int argc, char **argv)
+{
+    int flag = 0;
+    int argerr = 0;
+    int option_index = 0;
+    int memory_mb = 0;
+    int fds = 0;
+    char *memory = NULL;
+
+    options.count = 1000;
+    options.parallel = 10;
+    options.params = 20;
+    options.agent = "/bin/true";
+    options.action = "monitor";
+
+    crm_set_options(NULL, "[options]", long_options,
+                    "Measure how quickly resource agents can be launched\n");
+
+    while (1) {
+        flag = crm_get_option(argc, argv, &option_index);
+        if (flag == -1)
+            break;
+
+        switch (flag) {
+            case '?':
+                crm_help(flag, EX_OK);
+                break;
+            case 'V':
+                crm_bump_log_level(argc, argv);
+                break;
+            case 'c':
+                options.count = crm_parse_int(optarg, "1000");
+                break;
+            case 'P':
+                options.parallel = crm_parse_int(optarg, "10");
+                break;
+            case 'a':
+                options.agent = optarg;
+                break;
+            case 'A':
+                options.action = optarg;
+                break;
+            case 'p':
+                options.params = crm_parse_int(optarg, "20");
+                break;
+            case 'm':
+                memory_mb = crm_parse_int(optarg, "0");
+                break;
+            case 'f':
+                fds = crm_parse_int(optarg, "0");
+                break;
+            case 'F':
+                set_daemon_option("agent_spawn", "no");
+                break;
+            default:
+                ++argerr;
+                break;
+        }
+    }
+
+    if (argerr || options.count < 1 || options.parallel < 1) {
+        crm_help('?', EX_USAGE);
+    }
+
+    crm_log_init(NULL, LOG_INFO, FALSE, FALSE, argc, argv, FALSE);
+
+    if (memory_mb > 0) {
+        memory = malloc(memory_mb * 1024L * 1024L);
+        CRM_ASSERT(memory != NULL);
+        memset(memory, 1, memory_mb * 1024L * 1024L);
+    }
+
+    for (; fds > 0; fds--) {
+        if (open("/dev/null", O_RDONLY) < 0) {
+            crm_perror(LOG_ERR, "Could not open extra descriptors");
+            break;
+        }
+    }
+
+    mainloop = g_main_new(FALSE);
+    g_idle_add(start_bench, NULL);
+    g_main_run(mainloop);
+
+    free(memory);
+    return 0;
+}
@@ -0,0 +1,757 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/*
+ * Test the services library's systemd support against a stand-in systemd
+ *
+ * A private bus is started with dbus-daemon, and this program re-executes
+ * itself to own org.freedesktop.systemd1 on it.  The stand-in answers
+ * LoadUnit, Subscribe, Properties.Get and Properties.GetAll for any unit whose
+ * name doesn't start with "missing", counts the calls it receives, and on
+ * request emits the Reloading and UnitRemoved signals.  The services library is pointed at
+ * the private bus through DBUS_SYSTEM_BUS_ADDRESS.
+ *
+ * The tests check that unit paths are cached and forgotten when systemd says
+ * so, that operations on known units never complete before
+ * services_action_async() returns, and that a lost bus connection is
+ * re-established.  Finally the rate of recurring monitors is measured.
+ */
+
+#include <crm_internal.h>
+
+#include <glib.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <dbus/dbus.h>
+
+#include <crm/crm.h>
+#include <crm/services.h>
+#include <crm/common/mainloop.h>
+
+#define BUS_NAME "org.freedesktop.systemd1"
+#define BUS_PATH "/org/freedesktop/systemd1"
+#define UNIT_PATH BUS_PATH "/unit/"
+#define SIM_IFACE "org.clusterlabs.pacemaker.SystemdSim"
+
+/* *INDENT-OFF* */
+static struct crm_option long_options[] = {
+    {"help",       0, 0, '?'},
+    {"verbose",    0, 0, 'V', "\tPrint out logs and events to screen"},
+    {"count",      1, 0, 'c', "\tNumber of monitors to time (default 20000)"},
+    {"units",      1, 0, 'u', "\tNumber of units to spread them over (default 100)"},
+    {"parallel",   1, 0, 'P', "Number to run at once (default 100)"},
+    {"dbus-daemon", 1, 0, 'd', "Bus daemon to run (default dbus-daemon)"},
+    {"service",    1, 0, 's', NULL, pcmk_option_hidden},
+    {"-spacer-",   1, 0, '-', "\nExamples:"},
+    {"-spacer-",   1, 0, '-', "Run the tests and time 100000 monitors of 500 units:", pcmk_option_paragraph},
+    {"-spacer-",   1, 0, '-', " lrmd_systemd_sim --count 100000 --units 500", pcmk_option_example},
+    {0, 0, 0, 0}
+};
+/* *INDENT-ON* */
+
+static struct {
+    int count;
+    int units;
+    int parallel;
+    const char *dbus_daemon;
+} options;
+
+static char *sim_dir = NULL;
+static char *sim_address = NULL;
+static pid_t bus_pid = 0;
+static pid_t service_pid = 0;
+static DBusConnection *control = NULL;
+
+static GMainLoop *mainloop = NULL;
+static gboolean launching = FALSE;
+static int launched = 0;
+static int completed = 0;
+static int failed = 0;
+static int early = 0;
+static int last_rc = 0;
+static int last_status = 0;
+static int failures = 0;
+
+/* The stand-in systemd */
+
+typedef struct sim_counts_s {
+    dbus_uint32_t loadunit;
+    dbus_uint32_t get;
+    dbus_uint32_t getall;
+    dbus_uint32_t subscribe;
+} sim_counts_t;
+
+static char *
+sim_unit_path(const char *name)
+{
+    int lpc = 0;
+    char *path = calloc(1, strlen(UNIT_PATH) + 3 * strlen(name) + 1);
+    char *end = NULL;
+
+    strcpy(path, UNIT_PATH);
+    end = path + strlen(path);
+    for (lpc = 0; name[lpc] != 0; lpc++) {
+        if (isalnum((int) name[lpc])) {
+            *end++ = name[lpc];
+        } else {
+            end += sprintf(end, "_%02x", (unsigned char) name[lpc]);
+        }
+    }
+    return path;
+}
+
+static DBusMessage *
+sim_string_variant(DBusMessage * msg, const char *value)
+{
+    DBusMessageIter args;
+    DBusMessageIter variant;
+    DBusMessage *reply = dbus_message_new_method_return(msg);
+
+    dbus_message_iter_init_append(reply, &args);
+    dbus_message_iter_open_container(&args, DBUS_TYPE_VARIANT, "s", &variant);
+    dbus_message_iter_append_basic(&variant, DBUS_TYPE_STRING, &value);
+    dbus_message_iter_close_container(&args, &variant);
+    return reply;
+}
+
+static void
+sim_add_property(DBusMessageIter * dict, const char *name, const char *value)
+{
+    DBusMessageIter entry;
+    DBusMessageIter variant;
+
+    dbus_message_iter_open_container(dict, DBUS_TYPE_DICT_ENTRY, NULL, &entry);
+    dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &name);
+    dbus_message_iter_open_container(&entry, DBUS_TYPE_VARIANT, "s", &variant);
+    dbus_message_iter_append_basic(&variant, DBUS_TYPE_STRING, &value);
+    dbus_message_iter_close_container(&entry, &variant);
+    dbus_message_iter_close_container(dict, &entry);
+}
+
+/* Real units have a couple of hundred properties */
+static DBusMessage *
+sim_all_properties(DBusMessage * msg)
+{
+    int lpc = 0;
+    DBusMessageIter args;
+    DBusMessageIter dict;
+    DBusMessage *reply = dbus_message_new_method_return(msg);
+
+    dbus_message_iter_init_append(reply, &args);
+    dbus_message_iter_open_container(&args, DBUS_TYPE_ARRAY, "{sv}", &dict);
+    sim_add_property(&dict, "Description", "Simulated unit");
+    sim_add_property(&dict, "ActiveState", "active");
+    for (lpc = 0; lpc < 200; lpc++) {
+        char *name = crm_strdup_printf("SimulatedProperty%d", lpc);
+
+        sim_add_property(&dict, name, "value");
+        free(name);
+    }
+    dbus_message_iter_close_container(&args, &dict);
+    return reply;
+}
+
+static void
+sim_signal(DBusConnection * connection, const char *member, const char *name)
+{
+    DBusMessage *signal = dbus_message_new_signal(BUS_PATH, BUS_NAME ".Manager", member);
+
+    if (name) {
+        char *path = sim_unit_path(name);
+
+        dbus_message_append_args(signal, DBUS_TYPE_STRING, &name, DBUS_TYPE_OBJECT_PATH, &path,
+                                 DBUS_TYPE_INVALID);
+        free(path);
+    } else {
+        dbus_bool_t active = TRUE;
+
+        dbus_message_append_args(signal, DBUS_TYPE_BOOLEAN, &active, DBUS_TYPE_INVALID);
+    }
+    dbus_connection_send(connection, signal, NULL);
+    dbus_message_unref(signal);
+}
+
+static DBusMessage *
+sim_handle(DBusConnection * connection, DBusMessage * msg, sim_counts_t * counts)
+{
+    const char *arg = NULL;
+    const char *prop = NULL;
+    const char *path = dbus_message_get_path(msg);
+
+    if (dbus_message_is_method_call(msg, BUS_NAME ".Manager", "LoadUnit")) {
+        DBusMessage *reply = NULL;
+        char *unit = NULL;
+
+        counts->loadunit++;
+        dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &arg, DBUS_TYPE_INVALID);
+        if (arg == NULL || strncmp(arg, "missing", 7) == 0) {
+            return dbus_message_new_error(msg, BUS_NAME ".NoSuchUnit", "Unit not found");
+        }
+        unit = sim_unit_path(arg);
+        reply = dbus_message_new_method_return(msg);
+        dbus_message_append_args(reply, DBUS_TYPE_OBJECT_PATH, &unit, DBUS_TYPE_INVALID);
+        free(unit);
+        return reply;
+
+    } else if (dbus_message_is_method_call(msg, BUS_NAME ".Manager", "Subscribe")) {
+        counts->subscribe++;
+        return dbus_message_new_method_return(msg);
+
+    } else if (dbus_message_is_method_call(msg, BUS_NAME ".Manager", "Reload")) {
+        return dbus_message_new_method_return(msg);
+
+    } else if (dbus_message_is_method_call(msg, DBUS_INTERFACE_PROPERTIES, "Get")) {
+        counts->get++;
+        dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &arg, DBUS_TYPE_STRING, &prop,
+                              DBUS_TYPE_INVALID);
+        if (path == NULL || strncmp(path, UNIT_PATH, strlen(UNIT_PATH)) != 0) {
+            return dbus_message_new_error(msg, DBUS_ERROR_UNKNOWN_OBJECT, "No such object");
+
+        } else if (safe_str_eq(prop, "ActiveState")) {
+            return sim_string_variant(msg, "active");
+
+        } else if (safe_str_eq(prop, "Description")) {
+            return sim_string_variant(msg, "Simulated unit");
+        }
+        return dbus_message_new_error(msg, DBUS_ERROR_UNKNOWN_PROPERTY, "No such property");
+
+    } else if (dbus_message_is_method_call(msg, DBUS_INTERFACE_PROPERTIES, "GetAll")) {
+        counts->getall++;
+        return sim_all_properties(msg);
+
+    } else if (dbus_message_is_method_call(msg, SIM_IFACE, "Counts")) {
+        DBusMessage *reply = dbus_message_new_method_return(msg);
+
+        dbus_message_append_args(reply, DBUS_TYPE_UINT32, &counts->loadunit,
+                                 DBUS_TYPE_UINT32, &counts->get, DBUS_TYPE_UINT32, &counts->getall,
+                                 DBUS_TYPE_UINT32, &counts->subscribe, DBUS_TYPE_INVALID);
+        return reply;
+
+    } else if (dbus_message_is_method_call(msg, SIM_IFACE, "Reload")) {
+        sim_signal(connection, "Reloading", NULL);
+        return dbus_message_new_method_return(msg);
+
+    } else if (dbus_message_is_method_call(msg, SIM_IFACE, "Remove")) {
+        dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &arg, DBUS_TYPE_INVALID);
+        sim_signal(connection, "UnitRemoved", arg);
+        return dbus_message_new_method_return(msg);
+
+    } else if (dbus_message_get_type(msg) == DBUS_MESSAGE_TYPE_METHOD_CALL) {
+        return dbus_message_new_error(msg, DBUS_ERROR_UNKNOWN_METHOD, "Not simulated");
+    }
+    return NULL;
+}
+
+static int
+sim_service(const char *address)
+{
+    DBusError error;
+    DBusMessage *msg = NULL;
+    DBusConnection *connection = NULL;
+    sim_counts_t counts;
+
+    memset(&counts, 0, sizeof(counts));
+    dbus_error_init(&error);
+
+    connection = dbus_connection_open_private(address, &error);
+    if (connection == NULL || dbus_bus_register(connection, &error) == FALSE) {
+        fprintf(stderr, "Could not connect to %s: %s\n", address, error.message);
+        return 1;
+    }
+    if (dbus_bus_request_name(connection, BUS_NAME, DBUS_NAME_FLAG_DO_NOT_QUEUE, &error)
+        != DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER) {
+        fprintf(stderr, "Could not own %s\n", BUS_NAME);
+        return 1;
+    }
+
+    while (dbus_connection_read_write_dispatch(connection, -1)) {
+        while ((msg = dbus_connection_pop_message(connection)) != NULL) {
+            DBusMessage *reply = sim_handle(connection, msg, &counts);
+
+            if (reply) {
+                dbus_connection_send(connection, reply, NULL);
+                dbus_message_unref(reply);
+            }
+            dbus_message_unref(msg);
+        }
+    }
+    return 0;
+}
+
+/* Managing the bus and the stand-in */
+
+static gboolean
+sim_wait(int timeout_ms, gboolean (*check) (void))
+{
+    int waited = 0;
+
+    for (waited = 0; waited < timeout_ms; waited += 10) {
+        if (check()) {
+            return TRUE;
+        }
+        usleep(10000);
+    }
+    return check();
+}
+
+static gboolean
+sim_bus_ready(void)
+{
+    char *socket = crm_strdup_printf("%s/bus", sim_dir);
+    gboolean ready = (access(socket, F_OK) == 0);
+
+    free(socket);
+    return ready;
+}
+
+static gboolean
+sim_service_ready(void)
+{
+    return dbus_bus_name_has_owner(control, BUS_NAME, NULL);
+}
+
+static gboolean
+sim_start(void)
+{
+    DBusError error;
+
+    bus_pid = fork();
+    if (bus_pid == 0) {
+        char *config = crm_strdup_printf("--config-file=%s/bus.conf", sim_dir);
+
+        execlp(options.dbus_daemon, options.dbus_daemon, config, "--nofork", NULL);
+        _exit(127);
+    }
+    if (bus_pid < 0 || sim_wait(5000, sim_bus_ready) == FALSE) {
+        fprintf(stderr, "Could not start %s\n", options.dbus_daemon);
+        return FALSE;
+    }
+
+    dbus_error_init(&error);
+    control = dbus_connection_open_private(sim_address, &error);
+    if (control == NULL || dbus_bus_register(control, &error) == FALSE) {
+        fprintf(stderr, "Could not connect to %s: %s\n", sim_address, error.message);
+        return FALSE;
+    }
+
+    service_pid = fork();
+    if (service_pid == 0) {
+        execl("/proc/self/exe", crm_system_name, "--service", sim_address, NULL);
+        _exit(127);
+    }
+    if (service_pid < 0 || sim_wait(5000, sim_service_ready) == FALSE) {
+        fprintf(stderr, "Could not start the stand-in systemd\n");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static void
+sim_stop(void)
+{
+    char *socket = crm_strdup_printf("%s/bus", sim_dir);
+
+    if (control) {
+        dbus_connection_close(control);
+        dbus_connection_unref(control);
+        control = NULL;
+    }
+    if (service_pid > 0) {
+        kill(service_pid, SIGTERM);
+        waitpid(service_pid, NULL, 0);
+        service_pid = 0;
+    }
+    if (bus_pid > 0) {
+        kill(bus_pid, SIGTERM);
+        waitpid(bus_pid, NULL, 0);
+        bus_pid = 0;
+    }
+    unlink(socket);
+    free(socket);
+}
+
+/* Don't leave the bus behind if we're interrupted */
+static void
+sim_interrupted(int sig)
+{
+    if (service_pid > 0) {
+        kill(service_pid, SIGTERM);
+    }
+    if (bus_pid > 0) {
+        kill(bus_pid, SIGTERM);
+    }
+    _exit(1);
+}
+
+static gboolean
+sim_setup(void)
+{
+    FILE *config = NULL;
+    char *filename = NULL;
+    char template[] = "/tmp/systemd_sim.XXXXXX";
+
+    if (mkdtemp(template) == NULL) {
+        crm_perror(LOG_ERR, "Could not create a directory for the bus");
+        return FALSE;
+    }
+    sim_dir = strdup(template);
+    sim_address = crm_strdup_printf("unix:path=%s/bus", sim_dir);
+
+    filename = crm_strdup_printf("%s/bus.conf", sim_dir);
+    config = fopen(filename, "w");
+    free(filename);
+    if (config == NULL) {
+        crm_perror(LOG_ERR, "Could not write the bus configuration");
+        return FALSE;
+    }
+    fprintf(config, "<!DOCTYPE busconfig PUBLIC \"-//freedesktop//DTD D-Bus Bus Configuration 1.0//EN\"\n"
+            " \"http://www.freedesktop.org/standards/dbus/1.0/busconfig.dtd\">\n"
+            "<busconfig>\n"
+            "  <type>system</type>\n"
+            "  <listen>unix:path=%s/bus</listen>\n"
+            "  <policy context=\"default\">\n"
+            "    <allow user=\"*\"/>\n"
+            "    <allow own=\"*\"/>\n"
+            "    <allow send_destination=\"*\"/>\n"
+            "    <allow receive_sender=\"*\"/>\n"
+            "  </policy>\n"
+            "</busconfig>\n", sim_dir);
+    fclose(config);
+
+    setenv("DBUS_SYSTEM_BUS_ADDRESS", sim_address, 1);
+    crm_signal(SIGTERM, sim_interrupted);
+    crm_signal(SIGINT, sim_interrupted);
+    return sim_start();
+}
+
+static void
+sim_teardown(void)
+{
+    char *filename = crm_strdup_printf("%s/bus.conf", sim_dir);
+
+    sim_stop();
+    unlink(filename);
+    rmdir(sim_dir);
+    free(filename);
+}
+
+static gboolean
+sim_call(const char *method, const char *arg, sim_counts_t * counts)
+{
+    DBusError error;
+    DBusMessage *msg = dbus_message_new_method_call(BUS_NAME, BUS_PATH, SIM_IFACE, method);
+    DBusMessage *reply = NULL;
+
+    dbus_error_init(&error);
+    if (arg) {
+        dbus_message_append_args(msg, DBUS_TYPE_STRING, &arg, DBUS_TYPE_INVALID);
+    }
+    reply = dbus_connection_send_with_reply_and_block(control, msg, 5000, &error);
+    dbus_message_unref(msg);
+    if (reply == NULL) {
+        fprintf(stderr, "Could not call %s: %s\n", method, error.message);
+        dbus_error_free(&error);
+        return FALSE;
+    }
+    if (counts) {
+        dbus_message_get_args(reply, NULL, DBUS_TYPE_UINT32, &counts->loadunit,
+                              DBUS_TYPE_UINT32, &counts->get, DBUS_TYPE_UINT32, &counts->getall,
+                              DBUS_TYPE_UINT32, &counts->subscribe, DBUS_TYPE_INVALID);
+    }
+    dbus_message_unref(reply);
+    return TRUE;
+}
+
+/* Driving the services library */
+
+static void launch_more(void);
+
+static int run_count = 0;
+static int run_parallel = 0;
+static const char *run_unit = NULL;
+static const char *run_action = NULL;
+static guint run_timer = 0;
+
+static gboolean
+settle_done(gpointer user_data)
+{
+    g_main_quit(mainloop);
+    return FALSE;
+}
+
+/* Give the library a chance to see signals and disconnections */
+static void
+settle(void)
+{
+    g_timeout_add(200, settle_done, NULL);
+    g_main_run(mainloop);
+}
+
+static void
+action_done(svc_action_t * op)
+{
+    if (launching) {
+        early++;
+    }
+    completed++;
+    last_rc = op->rc;
+    last_status = op->status;
+    if (op->rc != PCMK_OCF_OK || op->status != PCMK_LRM_OP_DONE) {
+        failed++;
+        crm_info("%s failed: rc=%d status=%d", op->id, op->rc, op->status);
+    }
+    launch_more();
+}
+
+static void
+launch_more(void)
+{
+    while (launched < run_count && launched - completed < run_parallel) {
+        char *unit = run_unit? strdup(run_unit)
+                     : crm_strdup_printf("sim-%d", launched % options.units);
+        char *id = crm_strdup_printf("%s_%s_%d", unit, run_action, launched);
+        svc_action_t *op = resources_action_create(id, "systemd", NULL, unit, run_action,
+                                                   0, 20000, NULL, 0);
+
+        free(id);
+        free(unit);
+        launched++;
+        launching = TRUE;
+        services_action_async(op, action_done);
+        launching = FALSE;
+    }
+
+    if (completed == run_count) {
+        g_main_quit(mainloop);
+    }
+}
+
+static gboolean
+start_actions(gpointer user_data)
+{
+    launch_more();
+    return FALSE;
+}
+
+static gboolean
+actions_timed_out(gpointer user_data)
+{
+    run_timer = 0;
+    failed += run_count - completed;
+    crm_err("%d of %d %s actions did not complete", run_count - completed, run_count, run_action);
+    g_main_quit(mainloop);
+    return FALSE;
+}
+
+static long long
+run_actions(const char *unit, const char *action, int count, int parallel)
+{
+    long long start = crm_monotonic_usec();
+
+    run_unit = unit;
+    run_action = action;
+    run_count = count;
+    run_parallel = parallel;
+    launched = completed = failed = early = 0;
+
+    g_idle_add(start_actions, NULL);
+    run_timer = g_timeout_add(10000 + count, actions_timed_out, NULL);
+    g_main_run(mainloop);
+    if (run_timer) {
+        g_source_remove(run_timer);
+        run_timer = 0;
+    }
+    return crm_monotonic_usec() - start;
+}
+
+static long long
+run_monitors(const char *unit, int count, int parallel)
+{
+    return run_actions(unit, "monitor", count, parallel);
+}
+
+static void
+check(const char *test, gboolean passed, const char *format, ...)
+{
+    va_list ap;
+
+    printf("%-10s %s: ", test, passed ? "PASS" : "FAIL");
+    va_start(ap, format);
+    vprintf(format, ap);
+    va_end(ap);
+    printf("\n");
+    fflush(stdout);
+
+    if (passed == FALSE) {
+        failures++;
+    }
+}
+
+static void
+run_tests(void)
+{
+    long long elapsed = 0;
+    sim_counts_t before;
+    sim_counts_t after;
+
+    /* Only the first operation on a unit should need LoadUnit */
+    run_monitors("sim-0", 1, 1);
+    run_monitors("sim-0", 5, 1);
+    sim_call("Counts", NULL, &after);
+    check("cache", failed == 0 && after.loadunit == 1 && after.get == 6 && after.getall == 0,
+          "loadunit=%u get=%u getall=%u (expected 1, 6, 0)", after.loadunit, after.get, after.getall);
+    check("subscribe", after.subscribe == 1, "subscribe=%u (expected 1)", after.subscribe);
+
+    /* Operations on known units start from the mainloop, even those (such as
+     * unsupported actions) that complete without calling systemd
+     */
+    run_monitors(NULL, options.units, options.units);
+    run_monitors(NULL, options.units, options.units);
+    check("deferred", failed == 0 && early == 0,
+          "%d of %d monitors completed before services_action_async() returned",
+          early, options.units);
+    run_actions(NULL, "promote", options.units, options.units);
+    check("deferred", completed == options.units && early == 0
+          && last_rc == PCMK_OCF_UNIMPLEMENT_FEATURE,
+          "%d of %d promotes completed before services_action_async() returned, rc=%d (expected %d)",
+          early, options.units, last_rc, PCMK_OCF_UNIMPLEMENT_FEATURE);
+
+    sim_call("Counts", NULL, &before);
+    sim_call("Remove", "sim-0.service", NULL);
+    settle();
+    run_monitors("sim-0", 1, 1);
+    run_monitors("sim-1", 1, 1);
+    sim_call("Counts", NULL, &after);
+    check("removed", failed == 0 && after.loadunit == before.loadunit + 1,
+          "%u LoadUnit calls after UnitRemoved for one of two units (expected 1)",
+          after.loadunit - before.loadunit);
+
+    sim_call("Counts", NULL, &before);
+    sim_call("Reload", NULL, NULL);
+    settle();
+    run_monitors("sim-0", 1, 1);
+    run_monitors("sim-1", 1, 1);
+    sim_call("Counts", NULL, &after);
+    check("reloading", failed == 0 && after.loadunit == before.loadunit + 2,
+          "%u LoadUnit calls after Reloading for two units (expected 2)",
+          after.loadunit - before.loadunit);
+
+    run_monitors("missing-0", 1, 1);
+    check("missing", last_rc == PCMK_OCF_NOT_INSTALLED && last_status == PCMK_LRM_OP_NOT_INSTALLED,
+          "rc=%d status=%d (expected %d, %d)", last_rc, last_status,
+          PCMK_OCF_NOT_INSTALLED, PCMK_LRM_OP_NOT_INSTALLED);
+
+    /* Time monitors of units that are already known, as recurring ones are */
+    run_monitors(NULL, options.units, options.units);
+    sim_call("Counts", NULL, &before);
+    elapsed = run_monitors(NULL, options.count, options.parallel);
+    sim_call("Counts", NULL, &after);
+    check("monitors", failed == 0 && after.loadunit == before.loadunit,
+          "%d of %d units (%d failed, %d at once) in %.1fms: %.0f/s, "
+          "%u LoadUnit, %u Get and %u GetAll calls",
+          options.count, options.units, failed, options.parallel, elapsed / 1000.0,
+          options.count * 1000000.0 / QB_MAX(elapsed, 1), after.loadunit - before.loadunit,
+          after.get - before.get, after.getall - before.getall);
+
+    /* A restarted bus means a new connection, subscription and cache */
+    sim_stop();
+    settle();
+    if (sim_start() == FALSE) {
+        check("reconnect", FALSE, "could not restart the bus");
+        return;
+    }
+    run_monitors("sim-0", 1, 1);
+    sim_call("Counts", NULL, &after);
+    check("reconnect", failed == 0 && after.subscribe == 1 && after.loadunit == 1,
+          "rc=%d subscribe=%u loadunit=%u (expected 0, 1, 1)", last_rc, after.subscribe,
+          after.loadunit);
+}
+
+int
+main(int argc, char **argv)
+{
+    int flag = 0;
+    int argerr = 0;
+    int option_index = 0;
+    const char *service = NULL;
+
+    options.count = 20000;
+    options.units = 100;
+    options.parallel = 100;
+    options.dbus_daemon = "dbus-daemon";
+
+    crm_set_options(NULL, "[options]", long_options,
+                    "Test systemd resources against a stand-in systemd on a private bus\n");
+
+    while (1) {
+        flag = crm_get_option(argc, argv, &option_index);
+        if (flag == -1)
+            break;
+
+        switch (flag) {
+            case '?':
+                crm_help(flag, EX_OK);
+                break;
+            case 'V':
+                crm_bump_log_level(argc, argv);
+                break;
+            case 'c':
+                options.count = crm_parse_int(optarg, "20000");
+                break;
+            case 'u':
+                options.units = crm_parse_int(optarg, "100");
+                break;
+            case 'P':
+                options.parallel = crm_parse_int(optarg, "100");
+                break;
+            case 'd':
+                options.dbus_daemon = optarg;
+                break;
+            case 's':
+                service = optarg;
+                break;
+            default:
+                ++argerr;
+                break;
+        }
+    }
+
+    if (argerr || options.count < 1 || options.units < 2 || options.parallel < 1) {
+        crm_help('?', EX_USAGE);
+    }
+
+    if (service) {
+        return sim_service(service);
+    }
+
+    crm_log_init(NULL, LOG_INFO, FALSE, FALSE, argc, argv, FALSE);
+
+    if (sim_setup() == FALSE) {
+        return 1;
+    }
+
+    mainloop = g_main_new(FALSE);
+    run_tests();
+    sim_teardown();
+
+    printf("%d failure%s\n", failures, failures == 1 ? "" : "s");
+    return failures ? 1 : 0;
+}
@@ -320,6 +320,18 @@ start_test(gpointer user_data)
             rc = -1;
         }
 
+    } else if (safe_str_eq(options.api_call, "get_stats")) {
+        xmlNode *stats = NULL;
+
+        rc = lrmd_conn->cmds->get_stats(lrmd_conn, &stats);
+        if (rc == pcmk_ok) {
+            char *buffer = dump_xml_formatted(stats);
+
+            print_result(printf("%s", buffer));
+            free(buffer);
+            free_xml(stats);
+        }
+
     } else if (options.api_call) {
         print_result(printf("API-CALL FAILURE unknown action '%s'\n", options.action));
         test_exit(-1);
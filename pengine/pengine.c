@@ -56,6 +56,81 @@ series_t series[] = {
     {"pe-input", "pe-input-series-max", 400},
 };
 
+/* The input of the last full calculation, kept up to date with the
+ * patchsets the crmd sends when incremental input is enabled
+ */
+static xmlNode *cached_input = NULL;
+
+/*!
+ * \internal
+ * \brief Reconstruct the complete input of a calculation request
+ *
+ * \param[in] msg       Calculation request
+ * \param[in] xml_data  Request data (a CIB or a set of patchsets)
+ *
+ * \return Input to use (newly allocated unless it is \p xml_data),
+ *         or NULL if the crmd needs to resend the CIB
+ */
+static xmlNode *
+pe_sync_input(xmlNode * msg, xmlNode * xml_data)
+{
+    int rc = pcmk_ok;
+    int applied = 0;
+    const char *sync = crm_element_value(msg, F_CRM_PE_SYNC);
+    const char *value = NULL;
+    xmlNode *patchset = NULL;
+
+    if (safe_str_eq(sync, "full")) {
+        free_xml(cached_input);
+        cached_input = copy_xml(xml_data);
+        return xml_data;
+
+    } else if (safe_str_neq(sync, "diff")) {
+        free_xml(cached_input);
+        cached_input = NULL;
+        return xml_data;
+
+    } else if (cached_input == NULL) {
+        crm_info("No CIB to apply updates to");
+        return NULL;
+    }
+
+    for (patchset = __xml_first_child(xml_data); patchset != NULL; patchset = __xml_next(patchset)) {
+        /* The crmd's copy of the CIB has extra attributes, so the digest won't match */
+        xmlNode *copy = copy_xml(patchset);
+
+        xml_remove_prop(copy, XML_ATTR_DIGEST);
+        rc = xml_apply_patchset(cached_input, copy, TRUE);
+        free_xml(copy);
+
+        if (rc == -pcmk_err_old_data) {
+            /* Already included in the last full copy */
+            continue;
+
+        } else if (rc != pcmk_ok) {
+            crm_info("Could not apply CIB update: %s (%d)", pcmk_strerror(rc), rc);
+            free_xml(cached_input);
+            cached_input = NULL;
+            return NULL;
+        }
+        applied++;
+    }
+
+    crm_xml_add(cached_input, XML_ATTR_DC_UUID, crm_element_value(xml_data, XML_ATTR_DC_UUID));
+    crm_xml_add(cached_input, XML_ATTR_HAVE_QUORUM,
+                crm_element_value(xml_data, XML_ATTR_HAVE_QUORUM));
+
+    value = crm_element_value(xml_data, XML_ATTR_QUORUM_PANIC);
+    if (value) {
+        crm_xml_add(cached_input, XML_ATTR_QUORUM_PANIC, value);
+    } else {
+        xml_remove_prop(cached_input, XML_ATTR_QUORUM_PANIC);
+    }
+
+    crm_debug("Applied %d CIB update%s", applied, applied == 1 ? "" : "s");
+    return copy_xml(cached_input);
+}
+
 gboolean process_pe_message(xmlNode * msg, xmlNode * xml_data, crm_client_t * sender);
 
 gboolean
@@ -95,6 +170,19 @@ process_pe_message(xmlNode * msg, xmlNode * xml_data, crm_client_t * sender)
         xmlNode *reply = NULL;
         gboolean is_repoke = FALSE;
         gboolean process = TRUE;
+        xmlNode *input = pe_sync_input(msg, xml_data);
+
+        if (input == NULL) {
+            reply = create_reply(msg, NULL);
+            CRM_ASSERT(reply != NULL);
+
+            crm_xml_add(reply, F_CRM_PE_SYNC, "resync");
+            if (crm_ipcs_send(sender, 0, reply, crm_ipc_server_event) == FALSE) {
+                crm_err("Couldn't request the full CIB from peer");
+            }
+            free_xml(reply);
+            return TRUE;
+        }
 
         crm_config_error = FALSE;
         crm_config_warning = FALSE;
@@ -104,8 +192,8 @@ process_pe_message(xmlNode * msg, xmlNode * xml_data, crm_client_t * sender)
 
         set_working_set_defaults(&data_set);
 
-        digest = calculate_xml_versioned_digest(xml_data, FALSE, FALSE, CRM_FEATURE_SET);
-        converted = copy_xml(xml_data);
+        digest = calculate_xml_versioned_digest(input, FALSE, FALSE, CRM_FEATURE_SET);
+        converted = copy_xml(input);
         if (cli_config_update(&converted, NULL, TRUE) == FALSE) {
             data_set.graph = create_xml_node(NULL, XML_TAG_GRAPH);
             crm_xml_add_int(data_set.graph, "transition_id", 0);
@@ -186,14 +274,17 @@ process_pe_message(xmlNode * msg, xmlNode * xml_data, crm_client_t * sender)
 
         if (is_repoke == FALSE && series_wrap != 0) {
             unlink(filename);
-            crm_xml_add_int(xml_data, "execution-date", execution_date);
-            write_xml_file(xml_data, filename, HAVE_BZLIB_H);
+            crm_xml_add_int(input, "execution-date", execution_date);
+            write_xml_file(input, filename, HAVE_BZLIB_H);
             write_last_sequence(PE_STATE_DIR, series[series_id].name, seq + 1, series_wrap);
         } else {
             crm_trace("Not writing out %s: %d & %d", filename, is_repoke, series_wrap);
         }
 
         free_xml(converted);
+        if (input != xml_data) {
+            free_xml(input);
+        }
     }
 
     return TRUE;
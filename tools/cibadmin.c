@@ -86,6 +86,7 @@ static struct crm_option long_options[] = {
     {"query",       0, 0, 'Q', "\tQuery the contents of the CIB"},
     {"erase",       0, 0, 'E', "\tErase the contents of the whole CIB"},
     {"bump",        0, 0, 'B', "\tIncrease the CIB's epoch value by 1"},
+    {"stats",       0, 0, 'S', "\tShow per-operation latency and throughput statistics for the local CIB"},
     {"create",      0, 0, 'C', "\tCreate an object in the CIB.  Will fail if the object already exists."},
     {"modify",      0, 0, 'M', "\tFind the object somewhere in the CIB's XML tree and update it.  Fails if the object does not exist unless -c is specified"},
     {"patch",	    0, 0, 'P', "\tSupply an update in the form of an xml diff (See also: crm_diff)"},
@@ -287,6 +288,10 @@ main(int argc, char **argv)
             case 'B':
                 cib_action = CIB_OP_BUMP;
                 break;
+            case 'S':
+                cib_action = CIB_OP_STATS;
+                command_options |= cib_scope_local;
+                break;
             case 'V':
                 command_options = command_options | cib_verbose;
                 bump_log_num++;
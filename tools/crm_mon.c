@@ -3879,6 +3879,7 @@ void
 crm_diff_update(const char *event, xmlNode * msg)
 {
     int rc = -1;
+    int call_rc = pcmk_ok;
     long now = time(NULL);
     static bool stale = FALSE;
     static int updates = 0;
@@ -3891,7 +3892,13 @@ crm_diff_update(const char *event, xmlNode * msg)
         refresh_timer = mainloop_timer_add("refresh", 2000, FALSE, mon_trigger_refresh, NULL);
     }
 
-    if (current_cib != NULL) {
+    crm_element_value_int(msg, F_CIB_RC, &call_rc);
+    if (call_rc == -pcmk_err_diff_resync) {
+        /* The cib dropped updates we never saw and sent no diff, start again */
+        crm_notice("[%s] Missed updates, re-reading the CIB", event);
+        free_xml(current_cib); current_cib = NULL;
+
+    } else if (current_cib != NULL) {
         rc = xml_apply_patchset(current_cib, diff, TRUE);
 
         switch (rc) {
@@ -3914,7 +3921,10 @@ crm_diff_update(const char *event, xmlNode * msg)
         cib->cmds->query(cib, NULL, &current_cib, cib_scope_local | cib_sync_call);
     }
 
-    if (crm_mail_to || snmp_target || external_agent) {
+    if (call_rc == -pcmk_err_diff_resync) {
+        /* Nothing to report the individual changes from */
+
+    } else if (crm_mail_to || snmp_target || external_agent) {
         int format = 0;
         crm_element_value_int(diff, "format", &format);
         switch(format) {
@@ -0,0 +1,486 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <crm_internal.h>
+#include <crm/crm.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <glib.h>
+
+#include <crm/common/xml.h>
+#include <crm/common/util.h>
+#include <crm/msg_xml.h>
+
+/* *INDENT-OFF* */
+static struct crm_option long_options[] = {
+    /* Top-level Options */
+    {"help",           0, 0, '?', "\tThis text"},
+    {"version",        0, 0, '$', "\tVersion information"  },
+    {"verbose",        0, 0, 'V', "\tIncrease debug output\n"},
+
+    {"-spacer-",	1, 0, '-', "\nData sources:"},
+    {"xml-file",    1, 0, 'x', "Read the timeline from the named file"},
+
+    {"-spacer-",    1, 0, '-', "\nOutput:"},
+    {"events",      0, 0, 'e', "\tReplay every recorded event in the order it happened"},
+    {"path",        0, 0, 'p', "\tShow the critical path: the chain of actions the transition waited on"},
+    {"nodes",       0, 0, 'n', "\tShow how busy each node was"},
+
+    {"-spacer-",    1, 0, '-', "\nExamples:", pcmk_option_paragraph},
+    {"-spacer-",    1, 0, '-', "The DC saves a timeline next to each PE input it executes.", pcmk_option_paragraph},
+    {"-spacer-",    1, 0, '-', "Show the critical path and node utilization of transition 12:", pcmk_option_paragraph},
+    {"-spacer-",    1, 0, '-', " crm_timeline --xml-file " PE_STATE_DIR "/pe-input-12.timeline.bz2", pcmk_option_example},
+    {"-spacer-",    1, 0, '-', "Replay its events:", pcmk_option_paragraph},
+    {"-spacer-",    1, 0, '-', " crm_timeline --xml-file " PE_STATE_DIR "/pe-input-12.timeline.bz2 --events", pcmk_option_example},
+
+    {0, 0, 0, 0}
+};
+/* *INDENT-ON* */
+
+typedef struct tl_synapse_s {
+    int id;
+    int ready_input;
+    long long ready;
+    long long fired;
+} tl_synapse_t;
+
+typedef struct tl_action_s {
+    int id;
+    const char *key;
+    const char *node;
+    long long sent;
+    long long result;
+    long long confirmed;
+    int queue_ms;
+    int exec_ms;
+    gboolean failed;
+    tl_synapse_t *synapse;
+} tl_action_t;
+
+typedef struct tl_event_s {
+    long long when;
+    const char *what;
+    tl_synapse_t *synapse;
+    tl_action_t *action;
+} tl_event_t;
+
+static GHashTable *actions = NULL;      /* action id -> tl_action_t */
+static GListPtr synapses = NULL;        /* tl_synapse_t */
+static long long duration = 0;
+
+static long long
+timeline_usec(xmlNode * xml, const char *name)
+{
+    const char *value = crm_element_value(xml, name);
+
+    return value ? crm_int_helper(value, NULL) : -1;
+}
+
+static double
+usec2ms(long long usec)
+{
+    return usec / 1000.0;
+}
+
+static void
+unpack_timeline(xmlNode * timeline)
+{
+    xmlNode *s_xml = NULL;
+    xmlNode *a_xml = NULL;
+
+    actions = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, free);
+    duration = timeline_usec(timeline, "duration");
+
+    for (s_xml = __xml_first_child(timeline); s_xml != NULL; s_xml = __xml_next(s_xml)) {
+        tl_synapse_t *synapse = calloc(1, sizeof(tl_synapse_t));
+
+        crm_element_value_int(s_xml, XML_ATTR_ID, &synapse->id);
+        synapse->ready_input = -1;
+        crm_element_value_int(s_xml, "ready-input", &synapse->ready_input);
+        synapse->ready = timeline_usec(s_xml, "ready");
+        synapse->fired = timeline_usec(s_xml, "fired");
+        synapses = g_list_prepend(synapses, synapse);
+
+        for (a_xml = __xml_first_child(s_xml); a_xml != NULL; a_xml = __xml_next(a_xml)) {
+            tl_action_t *action = calloc(1, sizeof(tl_action_t));
+
+            crm_element_value_int(a_xml, XML_ATTR_ID, &action->id);
+            action->key = crm_element_value(a_xml, XML_LRM_ATTR_TASK_KEY);
+            action->node = crm_element_value(a_xml, XML_LRM_ATTR_TARGET);
+            action->sent = timeline_usec(a_xml, "sent");
+            action->result = timeline_usec(a_xml, "result");
+            action->confirmed = timeline_usec(a_xml, "confirmed");
+            crm_element_value_int(a_xml, XML_RSC_OP_T_QUEUE, &action->queue_ms);
+            crm_element_value_int(a_xml, XML_RSC_OP_T_EXEC, &action->exec_ms);
+            action->failed = crm_is_true(crm_element_value(a_xml, "failed"));
+            action->synapse = synapse;
+            g_hash_table_insert(actions, GINT_TO_POINTER(action->id), action);
+
+            duration = QB_MAX(duration, action->confirmed);
+        }
+    }
+    synapses = g_list_reverse(synapses);
+}
+
+static gint
+sort_event(gconstpointer a, gconstpointer b)
+{
+    const tl_event_t *event_a = a;
+    const tl_event_t *event_b = b;
+
+    if (event_a->when < event_b->when) {
+        return -1;
+    } else if (event_a->when > event_b->when) {
+        return 1;
+    }
+    /* Node spans open ('+') before they close ('-') */
+    return strcmp(event_a->what, event_b->what);
+}
+
+static GListPtr
+add_event(GListPtr events, long long when, const char *what,
+          tl_synapse_t * synapse, tl_action_t * action)
+{
+    tl_event_t *event = NULL;
+
+    if (when < 0) {
+        return events;
+    }
+
+    event = calloc(1, sizeof(tl_event_t));
+    event->when = when;
+    event->what = what;
+    event->synapse = synapse;
+    event->action = action;
+    return g_list_prepend(events, event);
+}
+
+static void
+print_events(void)
+{
+    GListPtr events = NULL;
+    GListPtr gIter = NULL;
+    GHashTableIter iter;
+    tl_action_t *action = NULL;
+
+    for (gIter = synapses; gIter != NULL; gIter = gIter->next) {
+        tl_synapse_t *synapse = gIter->data;
+
+        events = add_event(events, synapse->ready, "ready", synapse, NULL);
+        events = add_event(events, synapse->fired, "fired", synapse, NULL);
+    }
+
+    g_hash_table_iter_init(&iter, actions);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) & action)) {
+        events = add_event(events, action->sent, "sent", action->synapse, action);
+        events = add_event(events, action->result, "result", action->synapse, action);
+        events = add_event(events, action->confirmed, "confirmed", action->synapse, action);
+    }
+
+    printf("\nEvents:\n");
+    events = g_list_sort(events, sort_event);
+    for (gIter = events; gIter != NULL; gIter = gIter->next) {
+        tl_event_t *event = gIter->data;
+
+        if (event->action == NULL) {
+            printf(" %10.1fms  synapse %d %s", usec2ms(event->when), event->synapse->id,
+                   event->what);
+            if (event->what[0] == 'r' && event->synapse->ready_input >= 0) {
+                printf(" (after action %d)", event->synapse->ready_input);
+            }
+            printf("\n");
+
+        } else {
+            printf(" %10.1fms  action %d %s", usec2ms(event->when), event->action->id,
+                   event->what);
+            if (event->what[0] == 'r') {
+                printf(" (queue=%dms exec=%dms%s)", event->action->queue_ms,
+                       event->action->exec_ms, event->action->failed ? " failed" : "");
+            }
+            printf(": %s%s%s\n", event->action->key, event->action->node ? " on " : "",
+                   event->action->node ? event->action->node : "");
+        }
+    }
+    g_list_free_full(events, free);
+}
+
+/* Where time went on the critical path */
+static long long path_wait = 0;
+static long long path_dispatch = 0;
+static long long path_queue = 0;
+static long long path_exec = 0;
+static long long path_report = 0;
+static long long path_confirm = 0;
+
+static void
+print_path_step(tl_action_t * action)
+{
+    tl_synapse_t *synapse = action->synapse;
+    long long wait = 0;
+    long long dispatch = 0;
+    long long report = 0;
+    long long confirm = 0;
+    long long queue = action->queue_ms * 1000LL;
+    long long exec = action->exec_ms * 1000LL;
+
+    if (synapse->fired >= 0 && synapse->ready >= 0) {
+        wait = synapse->fired - synapse->ready;
+    }
+    if (action->sent >= 0 && synapse->fired >= 0) {
+        dispatch = action->sent - synapse->fired;
+    }
+    if (action->result >= 0 && action->sent >= 0) {
+        report = QB_MAX(0, action->result - action->sent - queue - exec);
+        confirm = action->confirmed - action->result;
+    } else if (action->confirmed >= 0 && synapse->fired >= 0) {
+        confirm = action->confirmed - synapse->fired;
+    }
+
+    path_wait += wait;
+    path_dispatch += dispatch;
+    path_queue += queue;
+    path_exec += exec;
+    path_report += report;
+    path_confirm += confirm;
+
+    printf(" %10.1f %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f  %d %s%s%s%s\n",
+           usec2ms(synapse->ready), usec2ms(wait), usec2ms(dispatch), usec2ms(queue),
+           usec2ms(exec), usec2ms(report), usec2ms(confirm), action->id, action->key,
+           action->node ? " on " : "", action->node ? action->node : "",
+           action->failed ? " (failed)" : "");
+}
+
+static void
+print_path_share(const char *name, long long usec, long long total)
+{
+    printf(" %-10s %10.1fms %5.1f%%\n", name, usec2ms(usec), total ? (100.0 * usec) / total : 0.0);
+}
+
+static void
+print_critical_path(void)
+{
+    int steps = 0;
+    long long total = 0;
+    GHashTableIter iter;
+    GListPtr path = NULL;
+    GListPtr gIter = NULL;
+    tl_action_t *action = NULL;
+    tl_action_t *last = NULL;
+
+    g_hash_table_iter_init(&iter, actions);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) & action)) {
+        if (last == NULL || action->confirmed > last->confirmed) {
+            last = action;
+        }
+    }
+
+    /* Follow the inputs that made each synapse ready back to the start */
+    for (action = last; action != NULL && steps <= g_hash_table_size(actions); steps++) {
+        path = g_list_prepend(path, action);
+        if (action->synapse->ready_input < 0) {
+            break;
+        }
+        action = g_hash_table_lookup(actions, GINT_TO_POINTER(action->synapse->ready_input));
+    }
+
+    printf("\nCritical path (ms):\n");
+    printf(" %10s %8s %8s %8s %8s %8s %8s  %s\n",
+           "ready", "wait", "dispatch", "queue", "exec", "report", "confirm", "action");
+    for (gIter = path; gIter != NULL; gIter = gIter->next) {
+        print_path_step(gIter->data);
+    }
+    g_list_free(path);
+
+    total = path_wait + path_dispatch + path_queue + path_exec + path_report + path_confirm;
+    printf("\nTime on the critical path:\n");
+    print_path_share("wait", path_wait, total);
+    print_path_share("dispatch", path_dispatch, total);
+    print_path_share("queue", path_queue, total);
+    print_path_share("exec", path_exec, total);
+    print_path_share("report", path_report, total);
+    print_path_share("confirm", path_confirm, total);
+}
+
+typedef struct tl_node_s {
+    const char *name;
+    int actions;
+    long long exec;
+    GListPtr spans;     /* tl_event_t: +1 when an action is sent, -1 on its result */
+} tl_node_t;
+
+static void
+print_node(gpointer key, gpointer value, gpointer user_data)
+{
+    tl_node_t *node = value;
+    GListPtr gIter = NULL;
+    int active = 0;
+    int max_active = 0;
+    long long busy = 0;
+    long long busy_since = 0;
+
+    node->spans = g_list_sort(node->spans, sort_event);
+    for (gIter = node->spans; gIter != NULL; gIter = gIter->next) {
+        tl_event_t *span = gIter->data;
+
+        if (span->what[0] == '+') {
+            if (active++ == 0) {
+                busy_since = span->when;
+            }
+            max_active = QB_MAX(max_active, active);
+
+        } else if (--active == 0) {
+            busy += span->when - busy_since;
+        }
+    }
+
+    printf(" %-24s %7d %6d %10.1f %5.1f%% %10.1f %5.1f%%\n", node->name, node->actions,
+           max_active, usec2ms(busy), duration > 0 ? (100.0 * busy) / duration : 0.0,
+           usec2ms(node->exec), duration > 0 ? (100.0 * node->exec) / duration : 0.0);
+    g_list_free_full(node->spans, free);
+}
+
+static void
+print_nodes(void)
+{
+    GHashTableIter iter;
+    tl_action_t *action = NULL;
+    GHashTable *nodes = g_hash_table_new_full(crm_str_hash, g_str_equal, NULL, free);
+
+    g_hash_table_iter_init(&iter, actions);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) & action)) {
+        tl_node_t *node = NULL;
+
+        if (action->node == NULL || action->sent < 0) {
+            continue;
+        }
+
+        node = g_hash_table_lookup(nodes, action->node);
+        if (node == NULL) {
+            node = calloc(1, sizeof(tl_node_t));
+            node->name = action->node;
+            g_hash_table_insert(nodes, (gpointer) node->name, node);
+        }
+
+        node->actions++;
+        node->exec += action->exec_ms * 1000LL;
+        node->spans = add_event(node->spans, action->sent, "+", NULL, action);
+        node->spans = add_event(node->spans,
+                                action->result >= 0 ? action->result : action->confirmed,
+                                "-", NULL, action);
+    }
+
+    printf("\nNode utilization (busy: an action was outstanding, exec: sum of execution times):\n");
+    printf(" %-24s %7s %6s %10s %6s %10s %6s\n",
+           "node", "actions", "max", "busy(ms)", "", "exec(ms)", "");
+    g_hash_table_foreach(nodes, print_node, NULL);
+    g_hash_table_destroy(nodes);
+}
+
+int
+main(int argc, char **argv)
+{
+    int argerr = 0;
+    int flag;
+    int option_index = 0;
+    const char *xml_file = NULL;
+    gboolean show_events = FALSE;
+    gboolean show_path = FALSE;
+    gboolean show_nodes = FALSE;
+    xmlNode *timeline = NULL;
+
+    crm_log_cli_init("crm_timeline");
+    crm_set_options(NULL, "[options] --xml-file file", long_options,
+                    "Show where the time went while the cluster executed a transition."
+                    "\n\nBy default both the critical path and node utilization are shown.");
+
+    while (1) {
+        flag = crm_get_option(argc, argv, &option_index);
+        if (flag == -1)
+            break;
+
+        switch (flag) {
+            case 'x':
+                xml_file = optarg;
+                break;
+            case 'e':
+                show_events = TRUE;
+                break;
+            case 'p':
+                show_path = TRUE;
+                break;
+            case 'n':
+                show_nodes = TRUE;
+                break;
+            case 'V':
+                crm_bump_log_level(argc, argv);
+                break;
+            case '$':
+            case '?':
+                crm_help(flag, EX_OK);
+                break;
+            default:
+                fprintf(stderr, "Option -%c is not yet supported\n", flag);
+                ++argerr;
+                break;
+        }
+    }
+
+    if (optind < argc || xml_file == NULL) {
+        ++argerr;
+    }
+
+    if (argerr) {
+        crm_help('?', EX_USAGE);
+    }
+
+    if (show_events == FALSE && show_path == FALSE && show_nodes == FALSE) {
+        show_path = TRUE;
+        show_nodes = TRUE;
+    }
+
+    timeline = filename2xml(xml_file);
+    if (timeline == NULL || safe_str_neq(crm_element_name(timeline), XML_TAG_GRAPH_TIMELINE)) {
+        fprintf(stderr, "%s does not contain a transition timeline\n", xml_file);
+        return EX_DATAERR;
+    }
+
+    unpack_timeline(timeline);
+
+    printf("Transition %s (%s): %d actions in %d synapses, %.1fms%s%s\n",
+           crm_element_value(timeline, XML_ATTR_ID), crm_element_value(timeline, "source"),
+           g_hash_table_size(actions), g_list_length(synapses), usec2ms(duration),
+           crm_element_value(timeline, "abort-reason") ? ", aborted: " : "",
+           crm_element_value(timeline, "abort-reason") ?
+           crm_element_value(timeline, "abort-reason") : "");
+
+    if (show_events) {
+        print_events();
+    }
+    if (show_path && g_hash_table_size(actions) > 0) {
+        print_critical_path();
+    }
+    if (show_nodes) {
+        print_nodes();
+    }
+
+    g_hash_table_destroy(actions);
+    g_list_free_full(synapses, free);
+    free_xml(timeline);
+    return EX_OK;
+}
@@ -72,6 +72,8 @@ gboolean DO_RESET = FALSE;
 gboolean DO_RESOURCE = FALSE;
 gboolean DO_ELECT_DC = FALSE;
 gboolean DO_WHOIS_DC = FALSE;
+gboolean DO_THROTTLE = FALSE;
+gboolean DO_HISTORY = FALSE;
 gboolean DO_NODE_LIST = FALSE;
 gboolean BE_SILENT = FALSE;
 gboolean DO_RESOURCE_LIST = FALSE;
@@ -108,6 +110,10 @@ static struct crm_option long_options[] = {
     {"dc_lookup", 0, 0, 'D', "Display the uname of the node co-ordinating the cluster."},
     {"-spacer-",  1, 0, '-', "\n\tThis is an internal detail and is rarely useful to administrators except when deciding on which node to examine the logs.\n"},
     {"nodes",     0, 0, 'N', "\tDisplay the uname of all member nodes"},
+    {"history",   1, 0, 'M', "Display the memory used by the specified node's resource operation history"},
+    {"-spacer-",  1, 0, '-', "\n\tSizes are estimates and include the history of any remote nodes the node manages.\n"},
+    {"throttle",  0, 0, 'T', "Display the job limits the DC is applying to each node"},
+    {"-spacer-",  1, 0, '-', "\n\tLimits are derived from each node's reported load and how quickly it has been completing actions.\n"},
     {"election",  0, 0, 'E', "(Advanced) Start an election for the cluster co-ordinator"},
     {"kill",      1, 0, 'K', "(Advanced) Shut down the crmd (not the rest of the clusterstack ) on the specified node"},
     {"health",    0, 0, 'H', NULL, 1},
@@ -163,6 +169,9 @@ main(int argc, char **argv)
             case 'D':
                 DO_WHOIS_DC = TRUE;
                 break;
+            case 'T':
+                DO_THROTTLE = TRUE;
+                break;
             case 'B':
                 BASH_EXPORT = TRUE;
                 break;
@@ -190,6 +199,11 @@ main(int argc, char **argv)
                 crm_trace("Option %c => %s", flag, optarg);
                 dest_node = strdup(optarg);
                 break;
+            case 'M':
+                DO_HISTORY = TRUE;
+                crm_trace("Option %c => %s", flag, optarg);
+                dest_node = strdup(optarg);
+                break;
             case 'E':
                 DO_ELECT_DC = TRUE;
                 break;
@@ -292,7 +306,12 @@ do_work(void)
         crm_xml_add(msg_options, XML_ATTR_TIMEOUT, "0");
         ret = 0;                /* no return message */
 
-    } else if (DO_WHOIS_DC) {
+    } else if (DO_HISTORY) {
+        sys_to = CRM_SYSTEM_CRMD;
+        crmd_operation = CRM_OP_PING;
+        crm_xml_add(msg_options, XML_ATTR_TIMEOUT, "0");
+
+    } else if (DO_WHOIS_DC || DO_THROTTLE) {
         dest_node = NULL;
         sys_to = CRM_SYSTEM_DC;
         crmd_operation = CRM_OP_PING;
@@ -488,6 +507,47 @@ admin_msg_callback(const char *buffer, ssize_t length, gpointer userdata)
             fprintf(stderr, "%s\n", state);
         }
 
+    } else if (DO_THROTTLE) {
+        xmlNode *data = get_message_xml(xml, F_CRM_DATA);
+        xmlNode *node = NULL;
+
+        printf("Job limits applied by %s:\n", crm_element_value(xml, F_CRM_HOST_FROM));
+        for (node = __xml_first_child(data); node != NULL; node = __xml_next(node)) {
+            if (crm_str_eq((const char *)node->name, "throttle", TRUE) == FALSE) {
+                continue;
+            }
+            printf("  %s: limit=%s max=%s mode=0x%.4x window=%s latency=%s completed=%s timeouts=%s\n",
+                   crm_element_value(node, XML_ATTR_UNAME),
+                   crm_element_value(node, "limit"), crm_element_value(node, "max"),
+                   crm_parse_int(crm_element_value(node, "mode"), "0"),
+                   crm_element_value(node, "window"), crm_element_value(node, "latency"),
+                   crm_element_value(node, "completed"), crm_element_value(node, "timeouts"));
+        }
+
+    } else if (DO_HISTORY) {
+        xmlNode *data = get_message_xml(xml, F_CRM_DATA);
+        xmlNode *node = NULL;
+
+        printf("Resource history held by %s:\n", crm_element_value(xml, F_CRM_HOST_FROM));
+        for (node = __xml_first_child(data); node != NULL; node = __xml_next(node)) {
+            if (crm_str_eq((const char *)node->name, "lrm_history", TRUE)) {
+                printf("  %s: resources=%s operations=%s bytes=%s\n",
+                       crm_element_value(node, XML_ATTR_UNAME),
+                       crm_element_value(node, "resources"),
+                       crm_element_value(node, "operations"),
+                       crm_element_value(node, "bytes"));
+
+            } else if (crm_str_eq((const char *)node->name, "lrm_history_shared", TRUE)) {
+                printf("  shared: param_sets=%s (referenced %s times) param_bytes=%s"
+                       " strings=%s string_bytes=%s\n",
+                       crm_element_value(node, "param_sets"),
+                       crm_element_value(node, "param_refs"),
+                       crm_element_value(node, "param_bytes"),
+                       crm_element_value(node, "strings"),
+                       crm_element_value(node, "string_bytes"));
+            }
+        }
+
     } else if (DO_WHOIS_DC) {
         const char *dc = crm_element_value(xml, F_CRM_HOST_FROM);
 